@@ -0,0 +1,233 @@
+#include "botclient.h"
+#include "fleetstats.h"
+
+#include <QJsonArray>
+#include <QRandomGenerator>
+
+BotClient::BotClient(int index, const BotConfig &config, FleetStats &stats, QObject *parent)
+    : QObject(parent)
+    , index(index)
+    , config(config)
+    , stats(stats)
+{
+    if (config.buyPolicy == "always") {
+        buyPolicy.mode = Engine::BuyPolicy::Always;
+    } else if (config.buyPolicy == "reserve") {
+        buyPolicy.mode = Engine::BuyPolicy::KeepReserve;
+        buyPolicy.minMoneyAfter = config.minMoneyAfter;
+    }
+
+    client = new NetworkClient(this);
+    thinkTimer = new QTimer(this);
+    thinkTimer->setSingleShot(true);
+    lobbyTimer = new QTimer(this);
+    lobbyTimer->setSingleShot(true);
+
+    connect(thinkTimer, &QTimer::timeout, this, &BotClient::act);
+    connect(lobbyTimer, &QTimer::timeout, this, &BotClient::scheduleAction);
+    connect(client, &NetworkClient::jsonReceived, this, &BotClient::onMessage);
+    connect(client, &NetworkClient::requestFinished, this, &BotClient::onRequestFinished);
+    connect(client, &NetworkClient::connected, this, [this]() {
+        this->stats.recordConnected();
+    });
+    connect(client, &NetworkClient::errorOccurred, this, [this](const QString &) {
+        this->stats.recordError("socket");
+    });
+    connect(client, &NetworkClient::disconnected, this, [this]() {
+        if (done) return;
+        this->stats.recordError("disconnect");
+        finish();
+    });
+}
+
+void BotClient::start()
+{
+    client->connectToServer(config.host, config.port);
+}
+
+bool BotClient::isDone() const
+{
+    return done;
+}
+
+void BotClient::onMessage(const QJsonObject &obj)
+{
+    stats.recordReceived();
+    const QString type = obj.value("type").toString();
+
+    if (type == "assignPlayerId") {
+        playerId = obj.value("playerId").toInt(-1);
+        lobbySince.start();
+        client->sendSetName(QString("Bot%1").arg(index));
+        return;
+    }
+
+    if (type == "buyRequest" && obj.value("playerId").toInt() == playerId) {
+        buyPending = true;
+        buyFieldIndex = obj.value("fieldIndex").toInt(-1);
+        buyPrice = obj.value("price").toInt();
+        return;
+    }
+
+    if (type == "state") {
+        state = obj;
+        scheduleAction();
+    }
+}
+
+void BotClient::onRequestFinished(int, const QString &type, bool ok, qint64 latencyUs, const QString &)
+{
+    stats.recordRequest(type, latencyUs, ok);
+
+    if (type == "rollDice" && step == Step::Rolling) {
+        if (ok && buyPending) {
+            // Kaufentscheidung nach Bedenkzeit
+            step = Step::Deciding;
+            scheduleAction();
+        } else {
+            // auch bei nack (z.B. Zug wartet noch auf endTurn)
+            step = Step::Ending;
+            client->sendEndTurn();
+        }
+        return;
+    }
+
+    if (type == "buyDecision" && step == Step::Deciding) {
+        step = Step::Ending;
+        client->sendEndTurn();
+        return;
+    }
+
+    if (type == "endTurn" || type == "autoTurn") {
+        if (ok) {
+            turnsPlayed++;
+        }
+        step = Step::Idle;
+        scheduleAction();
+        return;
+    }
+
+    if (type == "surrender" || type == "setReady" || type == "restartGame") {
+        step = Step::Idle;
+        scheduleAction();
+    }
+}
+
+void BotClient::scheduleAction()
+{
+    if (done || thinkTimer->isActive()) return;
+
+    const int think = config.thinkMaxMs > config.thinkMinMs
+            ? int(QRandomGenerator::global()->bounded(config.thinkMinMs, config.thinkMaxMs + 1))
+            : config.thinkMinMs;
+    thinkTimer->start(qMax(0, think));
+}
+
+void BotClient::act()
+{
+    if (done || playerId < 0 || state.isEmpty()) return;
+
+    if (step == Step::Deciding && buyPending) {
+        decideBuy();
+        return;
+    }
+    if (step != Step::Idle) return; // Antwort steht noch aus
+
+    const QJsonArray players = state.value("players").toArray();
+
+    if (state.value("gameFinished").toBool()) {
+        if (!finishCounted) {
+            finishCounted = true;
+            gamesPlayed++;
+            turnsPlayed = 0;
+            if (isTableHost()) {
+                stats.recordGameFinished();
+            }
+        }
+        if (config.games > 0 && gamesPlayed >= config.games) {
+            finish();
+            return;
+        }
+        // naechstes Spiel am selben Tisch startet der erste Spieler
+        if (isTableHost()) {
+            step = Step::Restart;
+            client->sendRestartGame();
+        }
+        return;
+    }
+    finishCounted = false;
+
+    if (!state.value("gameStarted").toBool()) {
+        if (me().value("ready").toBool()) return;
+
+        const bool full = players.size() >= config.tableSize;
+        const qint64 waited = lobbySince.isValid() ? lobbySince.elapsed() : 0;
+        if (full || (players.size() >= 2 && waited >= config.lobbyWaitMs)) {
+            step = Step::Ready;
+            client->sendSetReady(true);
+        } else if (!lobbyTimer->isActive()) {
+            // Tisch wird nicht voll: spaeter mit den Anwesenden starten
+            lobbyTimer->start(int(qMax<qint64>(0, config.lobbyWaitMs - waited)));
+        }
+        return;
+    }
+
+    if (state.value("currentPlayerId").toInt() != playerId || me().value("bankrupt").toBool()) {
+        return;
+    }
+
+    if (config.maxTurns > 0 && turnsPlayed >= config.maxTurns) {
+        // Spiele ohne Ende vermeiden
+        step = Step::Ending;
+        client->sendSurrender();
+        return;
+    }
+
+    if (config.autoTurn) {
+        step = Step::AutoTurn;
+        client->sendAutoTurn(config.buyPolicy, config.minMoneyAfter, true);
+    } else {
+        step = Step::Rolling;
+        buyPending = false;
+        client->sendRollDice();
+    }
+}
+
+void BotClient::decideBuy()
+{
+    const bool buy = buyPolicy.wantsToBuy(me().value("money").toInt(), buyPrice);
+    buyPending = false;
+    client->sendBuyDecision(buy, playerId, buyFieldIndex);
+}
+
+void BotClient::finish()
+{
+    if (done) return;
+    done = true;
+    thinkTimer->stop();
+    lobbyTimer->stop();
+    emit finished();
+}
+
+QJsonObject BotClient::me() const
+{
+    for (const QJsonValue &v : state.value("players").toArray()) {
+        const QJsonObject p = v.toObject();
+        if (p.value("id").toInt() == playerId) {
+            return p;
+        }
+    }
+    return QJsonObject();
+}
+
+bool BotClient::isTableHost() const
+{
+    int lowest = -1;
+    for (const QJsonValue &v : state.value("players").toArray()) {
+        const int id = v.toObject().value("id").toInt();
+        if (lowest < 0 || id < lowest) {
+            lowest = id;
+        }
+    }
+    return lowest == playerId;
+}
@@ -0,0 +1,84 @@
+#ifndef BOTCLIENT_H
+#define BOTCLIENT_H
+
+#include <QElapsedTimer>
+#include <QJsonObject>
+#include <QObject>
+#include <QTimer>
+
+#include "engine.h"
+#include "networkclient.h"
+
+class FleetStats;
+
+struct BotConfig {
+    QString host = "127.0.0.1";
+    quint16 port = 4242;
+
+    int tableSize = 4;          // erst bereit, wenn der Tisch so voll ist ...
+    int lobbyWaitMs = 10000;    // ... oder nach dieser Zeit mit mind. 2 Spielern
+    int thinkMinMs = 200;       // Bedenkzeit vor jeder Aktion
+    int thinkMaxMs = 800;
+    QString buyPolicy = "reserve"; // "never", "always", "reserve"
+    int minMoneyAfter = 200;    // "reserve": so viel bleibt nach einem Kauf mindestens
+    bool autoTurn = false;      // ganzer Zug als eine Anfrage statt rollDice/buyDecision/endTurn
+    int maxTurns = 200;         // danach gibt der Bot auf, damit Spiele enden
+    int games = 1;              // Spiele pro Bot, 0 = bis zum Ende des Laufs
+};
+
+// Ein Spieler ohne UI: setzt ueber NetworkClient auf denselben Protokollpfad
+// wie die GUI-Clients, wartet auf einen vollen Tisch, meldet sich bereit und
+// spielt ganze Spiele. Jede Anfrage traegt eine rid, Latenzen kommen aus
+// requestFinished.
+class BotClient : public QObject
+{
+    Q_OBJECT
+
+public:
+    BotClient(int index, const BotConfig &config, FleetStats &stats, QObject *parent = nullptr);
+
+    void start();
+    bool isDone() const;
+
+signals:
+    void finished();
+
+private:
+    enum class Step { Idle, Ready, Rolling, Deciding, Ending, AutoTurn, Restart };
+
+    int index;
+    BotConfig config;
+    // config.buyPolicy/minMoneyAfter als Engine-Regel, wie autoTurn im Server
+    Engine::BuyPolicy buyPolicy;
+    FleetStats &stats;
+    NetworkClient *client;
+    QTimer *thinkTimer;
+    QTimer *lobbyTimer;
+
+    int playerId = -1;
+    QJsonObject state;
+    Step step = Step::Idle;
+    QElapsedTimer lobbySince;
+
+    // buyRequest fuer uns, bis zur Entscheidung
+    bool buyPending = false;
+    int buyFieldIndex = -1;
+    int buyPrice = 0;
+
+    int turnsPlayed = 0;
+    int gamesPlayed = 0;
+    bool finishCounted = false;
+    bool done = false;
+
+    void onMessage(const QJsonObject &obj);
+    void onRequestFinished(int rid, const QString &type, bool ok, qint64 latencyUs, const QString &message);
+    void scheduleAction();
+    void act();
+    void decideBuy();
+    void finish();
+
+    QJsonObject me() const;
+    bool isTableHost() const;
+};
+
+#endif // BOTCLIENT_H
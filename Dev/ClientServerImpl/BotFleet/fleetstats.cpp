@@ -0,0 +1,188 @@
+#include "fleetstats.h"
+
+#include <QMutexLocker>
+#include <QStringList>
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+QString ms(qint64 us)
+{
+    return QString::number(double(us) / 1000.0, 'f', 2);
+}
+
+} // namespace
+
+void FleetStats::Histogram::add(qint64 us)
+{
+    const qint64 value = qBound<qint64>(0, us, (qint64(1) << (maxExponent + 1)) - 1);
+    int index = int(value);
+    if (value >= subBuckets) {
+        // Zweierpotenz als Gruppe, die naechsten subBits Bits als Stufe darin
+        int exponent = subBits;
+        while ((value >> (exponent + 1)) != 0) {
+            exponent++;
+        }
+        index = (exponent - subBits + 1) * subBuckets
+                + int((value >> (exponent - subBits)) & (subBuckets - 1));
+    }
+    counts[size_t(index)]++;
+    count++;
+    max = qMax(max, value);
+}
+
+void FleetStats::Histogram::merge(const Histogram &other)
+{
+    for (int i = 0; i < bucketCount; ++i) {
+        counts[size_t(i)] += other.counts[size_t(i)];
+    }
+    count += other.count;
+    max = qMax(max, other.max);
+}
+
+qint64 FleetStats::Histogram::percentile(double p) const
+{
+    if (count == 0) return 0;
+    // nearest rank: kleinster Wert, bis zu dem mindestens p aller Werte reichen
+    const qint64 rank = qMax<qint64>(1, qint64(std::ceil(p * double(count))));
+    qint64 seen = 0;
+    for (int i = 0; i < bucketCount; ++i) {
+        seen += counts[size_t(i)];
+        if (seen < rank) continue;
+        if (i < subBuckets) return i;
+        // obere Grenze des Buckets, hoechstens der echte Maximalwert
+        const int exponent = i / subBuckets + subBits - 1;
+        const qint64 step = qint64(1) << (exponent - subBits);
+        const qint64 upper = (qint64(subBuckets + i % subBuckets) + 1) * step - 1;
+        return qMin(upper, max);
+    }
+    return max;
+}
+
+FleetStats::Local &FleetStats::local()
+{
+    thread_local const FleetStats *owner = nullptr;
+    thread_local Local *cached = nullptr;
+    if (owner != this) {
+        QMutexLocker locker(&localsMutex);
+        locals.push_back(std::make_unique<Local>());
+        cached = locals.back().get();
+        owner = this;
+    }
+    return *cached;
+}
+
+void FleetStats::recordRequest(const QString &type, qint64 latencyUs, bool ok)
+{
+    requests++;
+    if (!ok) {
+        failed++;
+    }
+
+    Local &mine = local();
+    QMutexLocker locker(&mine.mutex);
+    if (latencyUs >= 0) {
+        mine.latencies[type].add(latencyUs);
+    }
+    if (!ok) {
+        mine.failures[type]++;
+    }
+}
+
+void FleetStats::recordReceived()
+{
+    received++;
+}
+
+void FleetStats::recordError(const QString &kind)
+{
+    errors++;
+    Local &mine = local();
+    QMutexLocker locker(&mine.mutex);
+    mine.errors[kind]++;
+}
+
+void FleetStats::recordConnected()
+{
+    connected++;
+}
+
+void FleetStats::recordGameFinished()
+{
+    games++;
+}
+
+FleetStats::Totals FleetStats::totals() const
+{
+    Totals t;
+    t.connected = connected.load();
+    t.requests = requests.load();
+    t.received = received.load();
+    t.failed = failed.load();
+    t.errors = errors.load();
+    t.games = games.load();
+    return t;
+}
+
+QString FleetStats::latencyTable() const
+{
+    QHash<QString, Histogram> merged;
+    QHash<QString, qint64> failures;
+    {
+        QMutexLocker locker(&localsMutex);
+        for (const auto &entry : locals) {
+            QMutexLocker localLocker(&entry->mutex);
+            for (auto it = entry->latencies.constBegin(); it != entry->latencies.constEnd(); ++it) {
+                merged[it.key()].merge(it.value());
+            }
+            for (auto it = entry->failures.constBegin(); it != entry->failures.constEnd(); ++it) {
+                failures[it.key()] += it.value();
+            }
+        }
+    }
+
+    QStringList types = merged.keys();
+    for (auto it = failures.constBegin(); it != failures.constEnd(); ++it) {
+        if (!types.contains(it.key())) types.append(it.key());
+    }
+    std::sort(types.begin(), types.end());
+
+    QStringList lines;
+    lines.append(QString("%1 %2 %3 %4 %5 %6 %7")
+                     .arg("type", -14).arg("count", 9).arg("failed", 7)
+                     .arg("p50ms", 9).arg("p99ms", 9).arg("p999ms", 9).arg("maxms", 9));
+    for (const QString &type : types) {
+        const Histogram samples = merged.value(type);
+        lines.append(QString("%1 %2 %3 %4 %5 %6 %7")
+                         .arg(type, -14)
+                         .arg(samples.count, 9)
+                         .arg(failures.value(type), 7)
+                         .arg(ms(samples.percentile(0.50)), 9)
+                         .arg(ms(samples.percentile(0.99)), 9)
+                         .arg(ms(samples.percentile(0.999)), 9)
+                         .arg(ms(samples.max), 9));
+    }
+    return lines.join("\n");
+}
+
+QString FleetStats::errorSummary() const
+{
+    QHash<QString, qint64> merged;
+    {
+        QMutexLocker locker(&localsMutex);
+        for (const auto &entry : locals) {
+            QMutexLocker localLocker(&entry->mutex);
+            for (auto it = entry->errors.constBegin(); it != entry->errors.constEnd(); ++it) {
+                merged[it.key()] += it.value();
+            }
+        }
+    }
+
+    QStringList parts;
+    for (auto it = merged.constBegin(); it != merged.constEnd(); ++it) {
+        parts.append(QString("%1=%2").arg(it.key()).arg(it.value()));
+    }
+    parts.sort();
+    return parts.isEmpty() ? QString("keine") : parts.join(" ");
+}
@@ -0,0 +1,79 @@
+#ifndef FLEETSTATS_H
+#define FLEETSTATS_H
+
+#include <QHash>
+#include <QMutex>
+#include <QString>
+#include <array>
+#include <atomic>
+#include <memory>
+#include <vector>
+
+// Messwerte aller Bots. Bots laufen in mehreren Threads: Zaehler sind
+// atomar, Latenzen und Fehler sammelt jeder Thread fuer sich (eigene, so gut
+// wie nie umkaempfte Sperre) und erst die Auswertung fuehrt sie zusammen.
+class FleetStats
+{
+public:
+    // ack/nack einer Anfrage mit rid
+    void recordRequest(const QString &type, qint64 latencyUs, bool ok);
+    void recordReceived();
+    // "socket", "disconnect", ...
+    void recordError(const QString &kind);
+    void recordConnected();
+    void recordGameFinished();
+
+    struct Totals {
+        qint64 connected = 0;
+        qint64 requests = 0;
+        qint64 received = 0;
+        qint64 failed = 0;
+        qint64 errors = 0;
+        qint64 games = 0;
+    };
+    Totals totals() const;
+
+    // Tabelle je Anfragetyp: count, failed, p50/p99/p999/max in ms
+    QString latencyTable() const;
+    QString errorSummary() const;
+
+private:
+    // feste Buckets statt aller Einzelwerte: 32 Stufen je Zweierpotenz,
+    // Perzentile also auf gut 3% genau, max exakt
+    struct Histogram {
+        static constexpr int subBits = 5;
+        static constexpr int subBuckets = 1 << subBits;
+        static constexpr int maxExponent = 40; // 2^40 us, ueber 12 Tage
+        static constexpr int bucketCount = (maxExponent - subBits + 2) * subBuckets;
+
+        std::array<qint64, bucketCount> counts{};
+        qint64 count = 0;
+        qint64 max = 0;
+
+        void add(qint64 us);
+        void merge(const Histogram &other);
+        qint64 percentile(double p) const;
+    };
+
+    struct Local {
+        QMutex mutex;
+        QHash<QString, Histogram> latencies;
+        QHash<QString, qint64> failures;
+        QHash<QString, qint64> errors;
+    };
+
+    std::atomic<qint64> connected{0};
+    std::atomic<qint64> requests{0};
+    std::atomic<qint64> received{0};
+    std::atomic<qint64> failed{0};
+    std::atomic<qint64> errors{0};
+    std::atomic<qint64> games{0};
+
+    mutable QMutex localsMutex;
+    std::vector<std::unique_ptr<Local>> locals;
+
+    // Werte des aufrufenden Threads, beim ersten Aufruf angelegt
+    Local &local();
+};
+
+#endif // FLEETSTATS_H
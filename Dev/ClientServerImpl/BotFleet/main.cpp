@@ -0,0 +1,190 @@
+// Lastgenerator: viele Bot-Spieler gegen einen laufenden MonopolyServer.
+// Bots verbinden sich gestaffelt (--ramp pro Sekunde), fuellen Tische,
+// melden sich bereit und spielen ganze Spiele. Am Ende: Latenz je
+// Anfragetyp (p50/p99/p999), Nachrichten pro Sekunde und Fehler.
+//
+// Beispiel: MonopolyBotFleet --host 10.0.0.5 --bots 4000 --threads 4 --duration 300
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QLoggingCategory>
+#include <QThread>
+#include <QTimer>
+#include <QVector>
+#include <cstdio>
+
+#include "botclient.h"
+#include "fleetstats.h"
+
+namespace {
+
+void printProgress(const FleetStats &stats, qint64 elapsedMs, FleetStats::Totals &last, qint64 &lastMs)
+{
+    const FleetStats::Totals now = stats.totals();
+    const double seconds = qMax<qint64>(1, elapsedMs - lastMs) / 1000.0;
+    std::printf("[%6.1fs] connected=%lld games=%lld req/s=%.0f recv/s=%.0f failed=%lld errors=%lld\n",
+                elapsedMs / 1000.0,
+                static_cast<long long>(now.connected),
+                static_cast<long long>(now.games),
+                double(now.requests - last.requests) / seconds,
+                double(now.received - last.received) / seconds,
+                static_cast<long long>(now.failed),
+                static_cast<long long>(now.errors));
+    std::fflush(stdout);
+    last = now;
+    lastMs = elapsedMs;
+}
+
+void printSummary(const FleetStats &stats, qint64 elapsedMs, int bots)
+{
+    const FleetStats::Totals t = stats.totals();
+    const double seconds = qMax<qint64>(1, elapsedMs) / 1000.0;
+    std::printf("\n== BotFleet: %d Bots, %.1fs ==\n", bots, seconds);
+    std::printf("verbunden=%lld spiele=%lld anfragen=%lld empfangen=%lld\n",
+                static_cast<long long>(t.connected), static_cast<long long>(t.games),
+                static_cast<long long>(t.requests), static_cast<long long>(t.received));
+    std::printf("nachrichten/s=%.0f (gesendet %.0f, empfangen %.0f)\n",
+                double(t.requests + t.received) / seconds,
+                double(t.requests) / seconds, double(t.received) / seconds);
+    std::printf("nack=%lld fehler: %s\n\n", static_cast<long long>(t.failed),
+                qPrintable(stats.errorSummary()));
+    std::printf("%s\n", qPrintable(stats.latencyTable()));
+    std::fflush(stdout);
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("MonopolyBotFleet");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Lastgenerator fuer den Monopoly-Server");
+    parser.addHelpOption();
+    const QCommandLineOption hostOpt("host", "Server-Adresse", "host", "127.0.0.1");
+    const QCommandLineOption portOpt("port", "Server-Port", "port", "4242");
+    const QCommandLineOption botsOpt("bots", "Anzahl Bots", "n", "100");
+    const QCommandLineOption rampOpt("ramp", "neue Verbindungen pro Sekunde", "n", "200");
+    const QCommandLineOption threadsOpt("threads", "Client-Threads", "n", "1");
+    const QCommandLineOption tableOpt("table-size", "Spieler pro Tisch vor dem Bereitmelden", "n", "4");
+    const QCommandLineOption lobbyOpt("lobby-wait", "ms bis ein nicht voller Tisch trotzdem startet", "ms", "10000");
+    const QCommandLineOption thinkMinOpt("think-min", "minimale Bedenkzeit", "ms", "200");
+    const QCommandLineOption thinkMaxOpt("think-max", "maximale Bedenkzeit", "ms", "800");
+    const QCommandLineOption buyOpt("buy-policy", "never, always oder reserve", "policy", "reserve");
+    const QCommandLineOption reserveOpt("min-money", "reserve: Geld, das nach einem Kauf bleibt", "n", "200");
+    const QCommandLineOption autoTurnOpt("auto-turn", "ganzer Zug als eine autoTurn-Anfrage");
+    const QCommandLineOption maxTurnsOpt("max-turns", "Zuege bis zur Aufgabe (0 = nie)", "n", "200");
+    const QCommandLineOption gamesOpt("games", "Spiele pro Bot (0 = bis --duration)", "n", "1");
+    const QCommandLineOption durationOpt("duration", "Laufzeit in s (0 = bis alle Bots fertig)", "s", "0");
+    const QCommandLineOption reportOpt("report", "Zwischenstand alle n s", "s", "10");
+    parser.addOptions({hostOpt, portOpt, botsOpt, rampOpt, threadsOpt, tableOpt, lobbyOpt,
+                       thinkMinOpt, thinkMaxOpt, buyOpt, reserveOpt, autoTurnOpt, maxTurnsOpt,
+                       gamesOpt, durationOpt, reportOpt});
+    parser.process(app);
+
+    BotConfig config;
+    config.host = parser.value(hostOpt);
+    config.port = quint16(parser.value(portOpt).toUInt());
+    config.tableSize = qBound(2, parser.value(tableOpt).toInt(), 4);
+    config.lobbyWaitMs = qMax(0, parser.value(lobbyOpt).toInt());
+    config.thinkMinMs = qMax(0, parser.value(thinkMinOpt).toInt());
+    config.thinkMaxMs = qMax(config.thinkMinMs, parser.value(thinkMaxOpt).toInt());
+    config.buyPolicy = parser.value(buyOpt);
+    config.minMoneyAfter = parser.value(reserveOpt).toInt();
+    config.autoTurn = parser.isSet(autoTurnOpt);
+    config.maxTurns = qMax(0, parser.value(maxTurnsOpt).toInt());
+    config.games = qMax(0, parser.value(gamesOpt).toInt());
+
+    const int botCount = qMax(1, parser.value(botsOpt).toInt());
+    const int ramp = qMax(1, parser.value(rampOpt).toInt());
+    const int threadCount = qMax(1, parser.value(threadsOpt).toInt());
+    const int durationS = qMax(0, parser.value(durationOpt).toInt());
+    const int reportS = qMax(1, parser.value(reportOpt).toInt());
+
+    // Debug-Ausgaben des NetworkClient pro Nachricht abschalten
+    QLoggingCategory::setFilterRules("default.debug=false");
+
+    FleetStats stats;
+
+    // Thread 0 ist der Hauptthread, weitere als Worker
+    QVector<QThread*> threads;
+    for (int i = 1; i < threadCount; ++i) {
+        auto *thread = new QThread(&app);
+        thread->setObjectName(QString("bots-%1").arg(i));
+        thread->start();
+        threads.append(thread);
+    }
+
+    QVector<BotClient*> bots;
+    int finishedBots = 0;
+    QElapsedTimer clock;
+    clock.start();
+
+    FleetStats::Totals lastTotals;
+    qint64 lastReportMs = 0;
+    bool summaryPrinted = false;
+
+    auto shutdown = [&]() {
+        if (summaryPrinted) return;
+        summaryPrinted = true;
+        printSummary(stats, clock.elapsed(), bots.size());
+        app.quit();
+    };
+
+    // gestaffelt verbinden: alle 10 ms so viele, wie ramp bis jetzt erlaubt;
+    // aus der Laufzeit gerechnet, damit auch ramp < 100 und krumme Werte stimmen
+    QTimer spawnTimer;
+    QObject::connect(&spawnTimer, &QTimer::timeout, &app, [&]() {
+        const qint64 due = qMin<qint64>(botCount, 1 + qint64(ramp) * clock.elapsed() / 1000);
+        while (bots.size() < due) {
+            const int index = bots.size();
+            auto *bot = new BotClient(index + 1, config, stats);
+            bots.append(bot);
+
+            QObject::connect(bot, &BotClient::finished, &app, [&]() {
+                if (++finishedBots == botCount && durationS == 0) {
+                    shutdown();
+                }
+            });
+
+            const int slot = index % threadCount;
+            if (slot == 0) {
+                bot->start();
+            } else {
+                QThread *thread = threads[slot - 1];
+                bot->moveToThread(thread);
+                QObject::connect(thread, &QThread::finished, bot, &QObject::deleteLater);
+                QMetaObject::invokeMethod(bot, &BotClient::start, Qt::QueuedConnection);
+            }
+        }
+        if (bots.size() >= botCount) {
+            spawnTimer.stop();
+        }
+    });
+    spawnTimer.start(10);
+
+    QTimer reportTimer;
+    QObject::connect(&reportTimer, &QTimer::timeout, &app, [&]() {
+        printProgress(stats, clock.elapsed(), lastTotals, lastReportMs);
+    });
+    reportTimer.start(reportS * 1000);
+
+    if (durationS > 0) {
+        QTimer::singleShot(durationS * 1000, &app, shutdown);
+    }
+
+    const int rc = app.exec();
+
+    for (QThread *thread : threads) {
+        thread->quit();
+    }
+    for (QThread *thread : threads) {
+        thread->wait();
+    }
+    for (int i = 0; i < bots.size(); i += threadCount) {
+        delete bots[i]; // Bots im Hauptthread, die anderen raeumen ihre Threads ab
+    }
+    return rc;
+}
@@ -0,0 +1,155 @@
+#ifndef PROTOCOL_H
+#define PROTOCOL_H
+
+#include <QByteArray>
+#include <QIODevice>
+#include <QJsonObject>
+#include <QString>
+#include <QStringList>
+
+// Wire-Protokoll zwischen Server und Clients (gleiche Datei in den Clients).
+//
+// Json: eine kompakte JSON-Zeile pro Nachricht, mit '\n' abgeschlossen.
+// Cbor: Binaer-Frame = Magic-Byte 0xCB, Laenge als uint32 big-endian,
+//       danach die Nachricht als CBOR-Map; "type" ist dort ein Integer-Code.
+// Eingehend werden beide Formate pro Nachricht am ersten Byte erkannt.
+namespace Protocol {
+
+enum class WireFormat {
+    Json = 0,
+    Cbor = 1
+};
+constexpr int WireFormatCount = 2;
+
+// Handshake: Client schickt hello {protocolVersion, caps}, Server antwortet
+// mit welcome {protocolVersion, caps} = gemeinsame Version/Faehigkeiten.
+// Clients ohne hello bekommen weiter das alte JSON-Verhalten.
+constexpr int Version = 1;
+constexpr int MinVersion = 1;
+
+// Faehigkeiten (caps) im Handshake
+inline const QString CapCbor = QStringLiteral("cbor");       // Binaer-Frames
+inline const QString CapDelta = QStringLiteral("delta");     // stateDelta statt voller States
+inline const QString CapCatalog = QStringLiteral("catalog"); // boardCatalog + dynamischer State
+inline const QString CapTurnResult = QStringLiteral("turnResult"); // ein Envelope pro Zug
+inline const QString CapRequestIds = QStringLiteral("rid");  // "rid" in Anfragen, Antwort per ack/nack
+inline const QString CapHeartbeat = QStringLiteral("heartbeat"); // ping/pong, RTT, Dead-Peer-Erkennung
+inline const QString CapResume = QStringLiteral("resume");   // "seq" in Nachrichten, Sitzung per resume fortsetzen
+
+constexpr char BinaryMagic = char(0xCB);
+constexpr int BinaryHeaderSize = 5;
+
+// Obergrenze fuer eine einzelne Nachricht; ein Client, der nie '\n'
+// schickt, kann den Empfangspuffer damit nicht beliebig wachsen lassen
+constexpr int DefaultMaxFrameSize = 1024 * 1024;
+
+// Integer-Codes fuer "type" im Binaerformat und fuer die Handler-Tabellen
+// im Server. Nur anhaengen, nie umnummerieren; alle Codes < TypeCodeLimit.
+constexpr int TypeCodeLimit = 128;
+
+enum MessageType : int {
+    UnknownType = 0,
+
+    // Client -> Server
+    StartGame = 1,
+    RollDice,
+    EndTurn,
+    Surrender,
+    SetReady,
+    SetName,
+    RestartGame,
+    BuyHouse,
+    BuyDecision,
+    GetState,
+    ListRooms,
+    CreateRoom,
+    JoinRoom,
+    ServerStats,
+    SetWireFormat,
+    Hello,
+    AutoTurn,
+    Pong,
+    Resume,
+
+    // Server -> Client
+    AssignPlayerId = 64,
+    RoomJoined,
+    RoomList,
+    Info,
+    Error,
+    Log,
+    DiceRolled,
+    BuyRequest,
+    State,
+    StateDelta,
+    BoardCatalog,
+    WireFormatChanged,
+    Welcome,
+    TurnResult,
+    Ack,
+    Nack,
+    Ping,
+    Resumed
+};
+
+int typeCode(const QString &name);
+QString typeName(int code);
+
+// was dieser Build kann (Server und Clients nutzen dieselbe Datei)
+QStringList supportedCapabilities();
+QStringList sharedCapabilities(const QStringList &offered);
+
+QString formatName(WireFormat format);
+bool parseFormat(const QString &name, WireFormat *format);
+
+// Komplette Nachricht inkl. Framing
+QByteArray encode(const QJsonObject &obj, WireFormat format);
+
+// Fertig kodierten Frame um "seq" ergaenzen, ohne die Nachricht neu zu
+// kodieren (Broadcasts bleiben einmal kodiert, nur die Bytes werden kopiert)
+QByteArray withSequence(const QByteArray &frame, WireFormat format, quint64 seq);
+
+// Empfangspuffer mit Lese-Cursor. Nachrichten werden direkt im Puffer
+// geparst (ohne Kopie der Zeile/des Frames); verbrauchte Bytes werden
+// hoechstens einmal pro Lesevorgang vorne abgeschnitten.
+class FrameReader
+{
+public:
+    enum class Result {
+        Incomplete, // keine vollstaendige Nachricht mehr im Puffer
+        Message,    // msg (und msgType) gesetzt
+        Malformed,  // Nachricht kaputt und verworfen, error gesetzt
+        TooLarge    // Frame ueber maxFrameSize: Verbindung nicht mehr lesbar
+    };
+
+    explicit FrameReader(int maxFrameSize = DefaultMaxFrameSize);
+
+    // liest alles Verfuegbare direkt in den Puffer, liefert die Byteanzahl
+    qint64 readFrom(QIODevice *device);
+    void append(const QByteArray &data);
+
+    // direktes Lesen ohne QIODevice (z.B. per recv): reserve() liefert Platz
+    // fuer bis zu size Bytes, commit() uebernimmt die tatsaechlich gelesenen
+    char *reserve(qsizetype size);
+    void commit(qsizetype size);
+
+    // msgType (optional): Code von "type", UnknownType falls unbekannt
+    Result next(QJsonObject *msg, QString *error, int *msgType = nullptr);
+
+    // noch nicht verarbeitete Bytes (z.B. fuer die Uebergabe an einen anderen Shard)
+    QByteArray pending() const;
+    bool hasPending() const;
+    void clear();
+
+private:
+    QByteArray buffer;
+    qsizetype cursor = 0;
+    qsizetype reservedAt = 0;
+    int maxFrameSize;
+
+    void compact();
+};
+
+} // namespace Protocol
+
+#endif // PROTOCOL_H
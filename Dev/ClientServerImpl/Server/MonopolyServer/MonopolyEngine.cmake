@@ -0,0 +1,15 @@
+# Spielregeln ohne Netzwerk: fuer Server, Simulatoren und Bots.
+# Per include() auch aus anderen Projekten (BotFleet) nutzbar.
+set(MONOPOLY_ENGINE_DIR ${CMAKE_CURRENT_LIST_DIR})
+
+qt_add_library(MonopolyEngine STATIC
+    ${MONOPOLY_ENGINE_DIR}/engine.h ${MONOPOLY_ENGINE_DIR}/engine.cpp
+    ${MONOPOLY_ENGINE_DIR}/roomrandom.h ${MONOPOLY_ENGINE_DIR}/roomrandom.cpp
+)
+
+target_include_directories(MonopolyEngine PUBLIC ${MONOPOLY_ENGINE_DIR})
+
+target_link_libraries(MonopolyEngine
+    PUBLIC
+        Qt::Core
+)
@@ -0,0 +1,442 @@
+#include "checkpoint.h"
+
+#include <QDateTime>
+#include <QFile>
+#include <QSet>
+#include <QtEndian>
+#include <array>
+#include <cstring>
+
+#ifdef Q_OS_WIN
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace {
+
+constexpr char magic[8] = {'M', 'N', 'P', 'L', 'C', 'K', 'P', 'T'};
+
+// Bits in RoomRecord::flags
+constexpr quint32 RoomStarted = 1;
+constexpr quint32 RoomFinished = 2;
+constexpr quint32 RoomAwaitingBuy = 4;
+constexpr quint32 RoomAwaitingEnd = 8;
+
+// Bits in PlayerRecord::flags
+constexpr quint32 PlayerInJail = 1;
+constexpr quint32 PlayerBankrupt = 2;
+constexpr quint32 PlayerReady = 4;
+
+// Layout der Datei, alle Werte Little Endian
+struct FileHeader {
+    char magic[8];
+    quint32_le version;
+    quint32_le headerSize;
+    quint32_le roomRecordSize;
+    quint32_le playerRecordSize;
+    quint32_le boardSize;
+    quint32_le roomCount;
+    quint32_le playerCount;
+    quint32_le stringBytes;
+    qint64_le createdMs;
+    quint32_le checksum; // CRC-32 ueber alles nach dem Header
+    quint32_le reserved[3];
+};
+
+struct RoomRecord {
+    qint32_le roomId;
+    quint32_le nameOffset;
+    quint32_le nameLength;
+    quint32_le flags;
+    quint64_le journalSeq;
+    qint32_le nextPlayerId;
+    qint32_le winnerId;
+    qint32_le currentPlayerId;
+    qint32_le pendingBuyPlayerId;
+    qint32_le pendingBuyFieldIndex;
+    qint32_le pendingEndTurnPlayerId;
+    quint32_le firstPlayer; // Index in die PlayerRecords
+    quint32_le playerCount;
+    quint64_le hotels;      // Bit i = Haus auf Feld i
+    qint32_le owners[Checkpoint::boardSize]; // Spieler-ID je Feld, -1 = frei
+    quint64_le randomSeed;  // Raum-Zufall
+    quint64_le randomDraws;
+};
+
+struct PlayerRecord {
+    qint32_le id;
+    quint32_le nameOffset;
+    quint32_le nameLength;
+    quint32_le sessionOffset;
+    quint32_le sessionLength;
+    qint32_le position;
+    qint32_le money;
+    qint32_le jailTurns;
+    quint32_le flags;
+};
+
+static_assert(sizeof(FileHeader) == 64, "Checkpoint-Header muss 64 Byte haben");
+static_assert(sizeof(RoomRecord) == 240, "RoomRecord-Layout geaendert: formatVersion erhoehen");
+static_assert(sizeof(PlayerRecord) == 36, "PlayerRecord-Layout geaendert: formatVersion erhoehen");
+
+quint32 crc32(const uchar *data, qint64 size)
+{
+    static const std::array<quint32, 256> table = [] {
+        std::array<quint32, 256> t{};
+        for (quint32 i = 0; i < 256; ++i) {
+            quint32 c = i;
+            for (int k = 0; k < 8; ++k) {
+                c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            }
+            t[i] = c;
+        }
+        return t;
+    }();
+
+    quint32 crc = 0xFFFFFFFFu;
+    for (qint64 i = 0; i < size; ++i) {
+        crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    }
+    return crc ^ 0xFFFFFFFFu;
+}
+
+bool syncFile(QFile &file)
+{
+    if (!file.flush()) return false;
+#ifdef Q_OS_WIN
+    return _commit(file.handle()) == 0;
+#else
+    return ::fsync(file.handle()) == 0;
+#endif
+}
+
+struct StringRef {
+    quint32 offset = 0;
+    quint32 length = 0;
+};
+
+StringRef addString(QByteArray &strings, const QString &value)
+{
+    const QByteArray utf8 = value.toUtf8();
+    StringRef ref;
+    ref.offset = quint32(strings.size());
+    ref.length = quint32(utf8.size());
+    strings += utf8;
+    return ref;
+}
+
+bool readString(const uchar *table, quint32 tableSize, quint32 offset, quint32 length, QString *out)
+{
+    if (quint64(offset) + length > tableSize) return false;
+    *out = QString::fromUtf8(reinterpret_cast<const char *>(table + offset), qsizetype(length));
+    return true;
+}
+
+bool parse(const uchar *map, qint64 size, QVector<RoomState> *rooms, QString *error)
+{
+    FileHeader header;
+    std::memcpy(&header, map, sizeof(header));
+
+    if (std::memcmp(header.magic, magic, sizeof(magic)) != 0) {
+        *error = "keine Checkpoint-Datei";
+        return false;
+    }
+    if (header.version != Checkpoint::formatVersion) {
+        *error = QString("Version %1 nicht unterstuetzt (erwartet %2)")
+                .arg(quint32(header.version)).arg(Checkpoint::formatVersion);
+        return false;
+    }
+    if (header.headerSize != sizeof(FileHeader)
+        || header.roomRecordSize != sizeof(RoomRecord)
+        || header.playerRecordSize != sizeof(PlayerRecord)
+        || header.boardSize != quint32(Checkpoint::boardSize)) {
+        *error = "Layout passt nicht zu dieser Version";
+        return false;
+    }
+
+    const quint64 expected = sizeof(FileHeader)
+            + quint64(header.roomCount) * sizeof(RoomRecord)
+            + quint64(header.playerCount) * sizeof(PlayerRecord)
+            + header.stringBytes;
+    if (expected != quint64(size)) {
+        *error = QString("Groesse %1 statt %2 Byte").arg(size).arg(expected);
+        return false;
+    }
+    if (crc32(map + sizeof(FileHeader), size - qint64(sizeof(FileHeader))) != header.checksum) {
+        *error = "Pruefsumme falsch";
+        return false;
+    }
+
+    const uchar *roomData = map + sizeof(FileHeader);
+    const uchar *playerData = roomData + quint64(header.roomCount) * sizeof(RoomRecord);
+    const uchar *strings = playerData + quint64(header.playerCount) * sizeof(PlayerRecord);
+    const quint32 stringBytes = header.stringBytes;
+
+    QVector<RoomState> result;
+    result.reserve(int(header.roomCount));
+    QSet<int> roomIds;
+    quint32 nextPlayer = 0;
+
+    for (quint32 r = 0; r < header.roomCount; ++r) {
+        RoomRecord rec;
+        std::memcpy(&rec, roomData + quint64(r) * sizeof(RoomRecord), sizeof(rec));
+
+        RoomState room;
+        room.roomId = rec.roomId;
+        const QString where = QString("Raum %1: ").arg(room.roomId);
+        if (room.roomId <= 0 || roomIds.contains(room.roomId)) {
+            *error = where + "ungueltige oder doppelte ID";
+            return false;
+        }
+        roomIds.insert(room.roomId);
+
+        // Spieler je Raum zusammenhaengend und in Reihenfolge
+        if (rec.firstPlayer != nextPlayer
+            || quint64(rec.firstPlayer) + rec.playerCount > header.playerCount) {
+            *error = where + "Spielerbereich ausserhalb der Datei";
+            return false;
+        }
+        nextPlayer += rec.playerCount;
+
+        if (!readString(strings, stringBytes, rec.nameOffset, rec.nameLength, &room.name)) {
+            *error = where + "Name ausserhalb der String-Tabelle";
+            return false;
+        }
+
+        const quint32 flags = rec.flags;
+        room.journalSeq = rec.journalSeq;
+        room.nextPlayerId = rec.nextPlayerId;
+        room.gameStarted = flags & RoomStarted;
+        room.gameFinished = flags & RoomFinished;
+        room.winnerId = rec.winnerId;
+        room.currentPlayerId = rec.currentPlayerId;
+        room.awaitingBuyDecision = flags & RoomAwaitingBuy;
+        room.pendingBuyPlayerId = rec.pendingBuyPlayerId;
+        room.pendingBuyFieldIndex = rec.pendingBuyFieldIndex;
+        room.awaitingEndTurn = flags & RoomAwaitingEnd;
+        room.pendingEndTurnPlayerId = rec.pendingEndTurnPlayerId;
+        room.randomSeed = rec.randomSeed;
+        room.randomDraws = rec.randomDraws;
+
+        QSet<int> playerIds;
+        for (quint32 i = 0; i < rec.playerCount; ++i) {
+            PlayerRecord prec;
+            std::memcpy(&prec, playerData + quint64(rec.firstPlayer + i) * sizeof(PlayerRecord), sizeof(prec));
+
+            PlayerState player;
+            player.id = prec.id;
+            player.position = prec.position;
+            player.money = prec.money;
+            player.jailTurns = prec.jailTurns;
+            player.inJail = prec.flags & PlayerInJail;
+            player.bankrupt = prec.flags & PlayerBankrupt;
+            player.ready = prec.flags & PlayerReady;
+            if (player.id <= 0 || player.id >= room.nextPlayerId || playerIds.contains(player.id)
+                || player.position < 0 || player.position >= Checkpoint::boardSize
+                || player.jailTurns < 0) {
+                *error = where + QString("Spieler %1 ungueltig").arg(player.id);
+                return false;
+            }
+            if (!readString(strings, stringBytes, prec.nameOffset, prec.nameLength, &player.name)
+                || !readString(strings, stringBytes, prec.sessionOffset, prec.sessionLength, &player.session)) {
+                *error = where + "Spielername ausserhalb der String-Tabelle";
+                return false;
+            }
+            playerIds.insert(player.id);
+            room.players.append(player);
+        }
+
+        // Verweise auf Spieler muessen in diesem Raum liegen
+        auto validPlayer = [&](int id) { return id == -1 || playerIds.contains(id); };
+        if (!validPlayer(room.currentPlayerId) || !validPlayer(room.winnerId)
+            || !validPlayer(room.pendingBuyPlayerId) || !validPlayer(room.pendingEndTurnPlayerId)
+            || room.pendingBuyFieldIndex < -1 || room.pendingBuyFieldIndex >= Checkpoint::boardSize) {
+            *error = where + "offene Entscheidung verweist ins Leere";
+            return false;
+        }
+
+        const quint64 hotels = rec.hotels;
+        for (int f = 0; f < Checkpoint::boardSize; ++f) {
+            const int owner = rec.owners[f];
+            if (owner == -1) continue;
+            if (!playerIds.contains(owner)) {
+                *error = where + QString("Feld %1 gehoert unbekanntem Spieler %2").arg(f).arg(owner);
+                return false;
+            }
+            FieldState field;
+            field.index = f;
+            field.ownerId = owner;
+            field.hasHotel = hotels & (quint64(1) << f);
+            room.fields.append(field);
+        }
+
+        result.append(room);
+    }
+
+    if (nextPlayer != header.playerCount) {
+        *error = "Spieler ohne Raum";
+        return false;
+    }
+
+    *rooms = result;
+    return true;
+}
+
+} // namespace
+
+bool Checkpoint::write(const QString &path, const QVector<RoomState> &rooms, QString *error)
+{
+    // Strings und Spieler vorab sammeln: die Dateigroesse steht vor dem Mappen fest
+    QByteArray strings;
+    QVector<StringRef> refs;
+    quint32 playerCount = 0;
+    for (const RoomState &room : rooms) {
+        refs.append(addString(strings, room.name));
+        for (const PlayerState &player : room.players) {
+            refs.append(addString(strings, player.name));
+            refs.append(addString(strings, player.session));
+        }
+        playerCount += quint32(room.players.size());
+    }
+
+    const qint64 roomBytes = qint64(rooms.size()) * qint64(sizeof(RoomRecord));
+    const qint64 total = qint64(sizeof(FileHeader)) + roomBytes
+            + qint64(playerCount) * qint64(sizeof(PlayerRecord)) + strings.size();
+
+    const QString tmpPath = path + ".tmp";
+    QFile file(tmpPath);
+    if (!file.open(QIODevice::ReadWrite | QIODevice::Truncate) || !file.resize(total)) {
+        *error = QString("%1: %2").arg(tmpPath, file.errorString());
+        return false;
+    }
+    uchar *map = file.map(0, total);
+    if (!map) {
+        *error = QString("mmap %1: %2").arg(tmpPath, file.errorString());
+        return false;
+    }
+
+    uchar *roomOut = map + sizeof(FileHeader);
+    uchar *playerOut = roomOut + roomBytes;
+    quint32 firstPlayer = 0;
+    int ref = 0;
+
+    for (const RoomState &room : rooms) {
+        RoomRecord rec{};
+        rec.roomId = room.roomId;
+        rec.nameOffset = refs[ref].offset;
+        rec.nameLength = refs[ref].length;
+        ref++;
+        rec.flags = (room.gameStarted ? RoomStarted : 0u)
+                | (room.gameFinished ? RoomFinished : 0u)
+                | (room.awaitingBuyDecision ? RoomAwaitingBuy : 0u)
+                | (room.awaitingEndTurn ? RoomAwaitingEnd : 0u);
+        rec.journalSeq = room.journalSeq;
+        rec.nextPlayerId = room.nextPlayerId;
+        rec.winnerId = room.winnerId;
+        rec.currentPlayerId = room.currentPlayerId;
+        rec.pendingBuyPlayerId = room.pendingBuyPlayerId;
+        rec.pendingBuyFieldIndex = room.pendingBuyFieldIndex;
+        rec.pendingEndTurnPlayerId = room.pendingEndTurnPlayerId;
+        rec.randomSeed = room.randomSeed;
+        rec.randomDraws = room.randomDraws;
+        rec.firstPlayer = firstPlayer;
+        rec.playerCount = quint32(room.players.size());
+
+        quint64 hotels = 0;
+        for (int f = 0; f < boardSize; ++f) {
+            rec.owners[f] = -1;
+        }
+        for (const FieldState &field : room.fields) {
+            if (field.index < 0 || field.index >= boardSize) continue;
+            rec.owners[field.index] = field.ownerId;
+            if (field.hasHotel) {
+                hotels |= quint64(1) << field.index;
+            }
+        }
+        rec.hotels = hotels;
+        std::memcpy(roomOut, &rec, sizeof(rec));
+        roomOut += sizeof(rec);
+
+        for (const PlayerState &player : room.players) {
+            PlayerRecord prec{};
+            prec.id = player.id;
+            prec.nameOffset = refs[ref].offset;
+            prec.nameLength = refs[ref].length;
+            prec.sessionOffset = refs[ref + 1].offset;
+            prec.sessionLength = refs[ref + 1].length;
+            ref += 2;
+            prec.position = player.position;
+            prec.money = player.money;
+            prec.jailTurns = player.jailTurns;
+            prec.flags = (player.inJail ? PlayerInJail : 0u)
+                    | (player.bankrupt ? PlayerBankrupt : 0u)
+                    | (player.ready ? PlayerReady : 0u);
+            std::memcpy(playerOut, &prec, sizeof(prec));
+            playerOut += sizeof(prec);
+        }
+        firstPlayer += rec.playerCount;
+    }
+    if (!strings.isEmpty()) {
+        std::memcpy(playerOut, strings.constData(), size_t(strings.size()));
+    }
+
+    // Header zuletzt, mit Pruefsumme ueber den Rest
+    FileHeader header{};
+    std::memcpy(header.magic, magic, sizeof(magic));
+    header.version = formatVersion;
+    header.headerSize = sizeof(FileHeader);
+    header.roomRecordSize = sizeof(RoomRecord);
+    header.playerRecordSize = sizeof(PlayerRecord);
+    header.boardSize = quint32(boardSize);
+    header.roomCount = quint32(rooms.size());
+    header.playerCount = playerCount;
+    header.stringBytes = quint32(strings.size());
+    header.createdMs = QDateTime::currentMSecsSinceEpoch();
+    header.checksum = crc32(map + sizeof(FileHeader), total - qint64(sizeof(FileHeader)));
+    std::memcpy(map, &header, sizeof(header));
+
+    file.unmap(map);
+    if (!syncFile(file)) {
+        *error = QString("fsync %1: %2").arg(tmpPath, file.errorString());
+        return false;
+    }
+    file.close();
+
+    // ersetzen; ein Absturz dazwischen laesst eine gueltige path.tmp zurueck
+    QFile::remove(path);
+    if (!QFile::rename(tmpPath, path)) {
+        *error = QString("%1 nicht ersetzbar").arg(path);
+        return false;
+    }
+    return true;
+}
+
+bool Checkpoint::load(const QString &path, QVector<RoomState> *rooms, QString *error)
+{
+    const QString source = !QFile::exists(path) && QFile::exists(path + ".tmp")
+            ? path + ".tmp" : path;
+
+    QFile file(source);
+    if (!file.open(QIODevice::ReadOnly)) {
+        *error = QString("%1: %2").arg(source, file.errorString());
+        return false;
+    }
+    const qint64 size = file.size();
+    if (size < qint64(sizeof(FileHeader))) {
+        *error = QString("%1: zu kurz fuer einen Header").arg(source);
+        return false;
+    }
+    uchar *map = file.map(0, size);
+    if (!map) {
+        *error = QString("mmap %1: %2").arg(source, file.errorString());
+        return false;
+    }
+
+    const bool ok = parse(map, size, rooms, error);
+    file.unmap(map);
+    if (!ok) {
+        *error = QString("%1: %2").arg(source, *error);
+    }
+    return ok;
+}
@@ -0,0 +1,34 @@
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include <QString>
+#include <QVector>
+
+#include "roomstate.h"
+
+// Binaer-Checkpoint des ganzen Servers: alle Raeume mit Spielern, Board,
+// offenen Entscheidungen und Zugreihenfolge in einer Datei mit festem
+// Layout (Little Endian), geschrieben und gelesen per mmap.
+//
+//   Header (64 Byte)  magic "MNPLCKPT", Version, Recordgroessen, Anzahlen,
+//                     CRC-32 ueber alles nach dem Header
+//   RoomRecord  x n   je Raum, Besitzer aller 40 Felder direkt im Record
+//   PlayerRecord x m  Spieler aller Raeume, je Raum zusammenhaengend
+//   Strings           Namen und Sitzungs-Token (UTF-8), per Offset referenziert
+//
+// load() prueft Magic, Version, Groessen, Pruefsumme und alle Verweise,
+// bevor etwas zurueckkommt - eine kaputte Datei liefert nichts.
+namespace Checkpoint
+{
+    // bei Layout-Aenderungen erhoehen; aeltere Dateien werden abgelehnt
+    constexpr quint32 formatVersion = 2;
+    constexpr int boardSize = 40;
+
+    // schreibt erst path.tmp und ersetzt dann path
+    bool write(const QString &path, const QVector<RoomState> &rooms, QString *error);
+
+    // faellt auf path.tmp zurueck, wenn path fehlt (Absturz beim Ersetzen)
+    bool load(const QString &path, QVector<RoomState> *rooms, QString *error);
+}
+
+#endif // CHECKPOINT_H
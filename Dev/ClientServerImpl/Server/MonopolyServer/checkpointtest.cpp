@@ -0,0 +1,224 @@
+// Checkpoint::load: ein gueltiger Checkpoint kommt unveraendert zurueck,
+// jede kaputte Datei (Magic, Version, Groesse, Pruefsumme, Verweise) wird
+// abgelehnt und liefert keine Raeume.
+
+#include <QFile>
+#include <QTemporaryDir>
+#include <QtTest>
+
+#include "checkpoint.h"
+
+namespace {
+
+constexpr int headerSize = 64;
+constexpr int versionOffset = 8;
+
+RoomState sampleRoom()
+{
+    RoomState room;
+    room.roomId = 1;
+    room.name = "Tisch 1";
+    room.journalSeq = 17;
+    room.nextPlayerId = 3;
+    room.gameStarted = true;
+    room.currentPlayerId = 2;
+    room.awaitingBuyDecision = true;
+    room.pendingBuyPlayerId = 2;
+    room.pendingBuyFieldIndex = 6;
+    room.randomSeed = 0x0123456789abcdefull;
+    room.randomDraws = 42;
+
+    PlayerState anna;
+    anna.id = 1;
+    anna.name = "Anna";
+    anna.session = "s-anna";
+    anna.position = 10;
+    anna.money = 1240;
+    anna.inJail = true;
+    anna.jailTurns = 2;
+    anna.ready = true;
+    PlayerState ben;
+    ben.id = 2;
+    ben.name = "Ben";
+    ben.position = 6;
+    ben.money = 870;
+    ben.ready = true;
+    room.players = {anna, ben};
+
+    // nach Index sortiert, so wie load() sie liefert
+    FieldState street;
+    street.index = 1;
+    street.ownerId = 1;
+    street.hasHotel = true;
+    FieldState railroad;
+    railroad.index = 5;
+    railroad.ownerId = 2;
+    room.fields = {street, railroad};
+    return room;
+}
+
+QByteArray readAll(const QString &path)
+{
+    QFile file(path);
+    return file.open(QIODevice::ReadOnly) ? file.readAll() : QByteArray();
+}
+
+void writeAll(const QString &path, const QByteArray &data)
+{
+    QFile file(path);
+    QVERIFY(file.open(QIODevice::WriteOnly | QIODevice::Truncate));
+    QCOMPARE(file.write(data), qint64(data.size()));
+}
+
+} // namespace
+
+class CheckpointTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void init();
+
+    void roundTrip();
+    void fallsBackToTmp();
+    void rejectsBadMagic();
+    void rejectsOtherVersion();
+    void rejectsTruncated();
+    void rejectsBadChecksum();
+    void rejectsDanglingReferences_data();
+    void rejectsDanglingReferences();
+
+private:
+    QTemporaryDir dir;
+    QString path;
+
+    bool loadFails(const QString &expectedError);
+};
+
+void CheckpointTest::init()
+{
+    QVERIFY(dir.isValid());
+    path = dir.filePath("server.ckpt");
+    QFile::remove(path);
+    QFile::remove(path + ".tmp");
+
+    QString error;
+    QVERIFY2(Checkpoint::write(path, {sampleRoom()}, &error), qPrintable(error));
+}
+
+bool CheckpointTest::loadFails(const QString &expectedError)
+{
+    QVector<RoomState> rooms;
+    QString error;
+    if (Checkpoint::load(path, &rooms, &error)) {
+        qWarning() << "kaputter Checkpoint wurde geladen";
+        return false;
+    }
+    if (!rooms.isEmpty() || !error.contains(expectedError)) {
+        qWarning() << "unerwarteter Fehler:" << error;
+        return false;
+    }
+    return true;
+}
+
+void CheckpointTest::roundTrip()
+{
+    QVector<RoomState> rooms;
+    QString error;
+    QVERIFY2(Checkpoint::load(path, &rooms, &error), qPrintable(error));
+    QCOMPARE(rooms.size(), 1);
+    QCOMPARE(rooms.at(0).toJson(), sampleRoom().toJson());
+}
+
+void CheckpointTest::fallsBackToTmp()
+{
+    // Absturz zwischen remove(path) und rename(tmp, path)
+    QVERIFY(QFile::rename(path, path + ".tmp"));
+
+    QVector<RoomState> rooms;
+    QString error;
+    QVERIFY2(Checkpoint::load(path, &rooms, &error), qPrintable(error));
+    QCOMPARE(rooms.size(), 1);
+}
+
+void CheckpointTest::rejectsBadMagic()
+{
+    QByteArray data = readAll(path);
+    data[0] = 'X';
+    writeAll(path, data);
+    QVERIFY(loadFails("keine Checkpoint-Datei"));
+}
+
+void CheckpointTest::rejectsOtherVersion()
+{
+    QByteArray data = readAll(path);
+    data[versionOffset] = char(Checkpoint::formatVersion + 1);
+    writeAll(path, data);
+    QVERIFY(loadFails("nicht unterstuetzt"));
+}
+
+void CheckpointTest::rejectsTruncated()
+{
+    QByteArray data = readAll(path);
+    data.chop(1);
+    writeAll(path, data);
+    QVERIFY(loadFails("Groesse"));
+
+    writeAll(path, data.left(headerSize - 1));
+    QVERIFY(loadFails("zu kurz"));
+}
+
+void CheckpointTest::rejectsBadChecksum()
+{
+    // ein Bit hinter dem Header, Groesse bleibt gleich
+    QByteArray data = readAll(path);
+    QVERIFY(data.size() > headerSize);
+    data[data.size() - 1] = char(data.at(data.size() - 1) ^ 0x01);
+    writeAll(path, data);
+    QVERIFY(loadFails("Pruefsumme"));
+}
+
+void CheckpointTest::rejectsDanglingReferences_data()
+{
+    QTest::addColumn<int>("kind");
+    QTest::addColumn<QString>("expectedError");
+
+    QTest::newRow("owner") << 0 << "unbekanntem Spieler";
+    QTest::newRow("currentPlayer") << 1 << "verweist ins Leere";
+    QTest::newRow("buyField") << 2 << "verweist ins Leere";
+    QTest::newRow("position") << 3 << "ungueltig";
+    QTest::newRow("duplicatePlayer") << 4 << "ungueltig";
+}
+
+void CheckpointTest::rejectsDanglingReferences()
+{
+    QFETCH(int, kind);
+    QFETCH(QString, expectedError);
+
+    // write() prueft nicht: Datei mit gueltiger Pruefsumme, aber falschen Verweisen
+    RoomState room = sampleRoom();
+    switch (kind) {
+    case 0:
+        room.fields[1].ownerId = 99;
+        break;
+    case 1:
+        room.currentPlayerId = 99;
+        break;
+    case 2:
+        room.pendingBuyFieldIndex = Checkpoint::boardSize;
+        break;
+    case 3:
+        room.players[0].position = Checkpoint::boardSize;
+        break;
+    case 4:
+        room.players[1].id = room.players[0].id;
+        break;
+    }
+
+    QString error;
+    QVERIFY2(Checkpoint::write(path, {room}, &error), qPrintable(error));
+    QVERIFY(loadFails(expectedError));
+}
+
+QTEST_GUILESS_MAIN(CheckpointTest)
+#include "checkpointtest.moc"
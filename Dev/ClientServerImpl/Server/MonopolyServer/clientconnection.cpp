@@ -0,0 +1,106 @@
+#include "clientconnection.h"
+
+ClientConnection::ClientConnection(std::unique_ptr<Transport> transport, int maxFrameSize)
+    : transport(std::move(transport))
+    , reader(maxFrameSize)
+{
+}
+
+Transport &ClientConnection::getTransport()
+{
+    return *transport;
+}
+
+Protocol::FrameReader &ClientConnection::getReader()
+{
+    return reader;
+}
+
+void ClientConnection::enqueue(const QByteArray &frame, bool stateFrame)
+{
+    // implizit geteilt: Broadcast-Frames werden hier nicht kopiert
+    queue.append({frame, stateFrame});
+    queued += frame.size();
+}
+
+int ClientConnection::dropQueuedState()
+{
+    int dropped = 0;
+    for (int i = queue.size() - 1; i >= 0; --i) {
+        if (queue[i].stateFrame) {
+            queued -= queue[i].data.size();
+            queue.removeAt(i);
+            ++dropped;
+        }
+    }
+    return dropped;
+}
+
+bool ClientConnection::isCongested() const
+{
+    return congested;
+}
+
+void ClientConnection::setCongested(bool value)
+{
+    if (value && !congested) {
+        congestedSince.start();
+    }
+    congested = value;
+}
+
+qint64 ClientConnection::congestedForMs() const
+{
+    return congested ? congestedSince.elapsed() : 0;
+}
+
+bool ClientConnection::hasQueued() const
+{
+    return !queue.isEmpty();
+}
+
+qint64 ClientConnection::queuedBytes() const
+{
+    return queued;
+}
+
+qint64 ClientConnection::writeQueued(int *frames)
+{
+    if (frames) {
+        *frames = queue.size();
+    }
+    if (queue.isEmpty()) {
+        return 0;
+    }
+
+    const qint64 bytes = queued;
+    if (queue.size() == 1) {
+        transport->write(queue.front().data);
+    } else {
+        QByteArray batch;
+        batch.reserve(queued);
+        for (const QueuedFrame &frame : queue) {
+            batch.append(frame.data);
+        }
+        transport->write(batch);
+    }
+    transport->flush();
+
+    queue.clear();
+    queued = 0;
+    return bytes;
+}
+
+void ClientConnection::addRttSample(qint64 sampleMs)
+{
+    if (srtt < 0) {
+        srtt = double(sampleMs);
+    } else {
+        srtt = 0.875 * srtt + 0.125 * double(sampleMs);
+    }
+}
+
+double ClientConnection::smoothedRttMs() const
+{
+    return srtt;
+}
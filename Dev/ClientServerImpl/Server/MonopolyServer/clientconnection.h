@@ -0,0 +1,89 @@
+#ifndef CLIENTCONNECTION_H
+#define CLIENTCONNECTION_H
+
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QVector>
+#include <memory>
+
+#include "protocol.h"
+#include "transport.h"
+
+// Eine Client-Verbindung im Shard: Transport, Empfangspuffer und
+// Ausgangs-Queue. Frames eines Event-Loop-Durchlaufs werden gesammelt
+// und zusammen mit einem write()/flush() rausgeschrieben. Die Verbindung
+// zieht bei einem Raumwechsel samt Puffern mit an den neuen Shard.
+//
+// Backpressure: liegt im Socket mehr als highWatermark ungesendet, gilt
+// die Verbindung als ueberlastet. Bis sie unter lowWatermark faellt,
+// bleibt alles in der eigenen Queue, wo ein neuer Vollzustand aeltere
+// State-Frames ersetzt. Wer zu lange oder zu weit hinterherhaengt, fliegt.
+class ClientConnection
+{
+public:
+    static constexpr qint64 highWatermark = 256 * 1024;
+    static constexpr qint64 lowWatermark = 64 * 1024;
+    static constexpr qint64 maxQueuedBytes = 1024 * 1024;
+    static constexpr qint64 slowConsumerTimeoutMs = 30000;
+
+    ClientConnection(std::unique_ptr<Transport> transport, int maxFrameSize);
+
+    Transport &getTransport();
+    Protocol::FrameReader &getReader();
+
+    // Ausgang
+    void enqueue(const QByteArray &frame, bool stateFrame = false);
+    bool hasQueued() const;
+    qint64 queuedBytes() const;
+
+    // entfernt gesammelte State-Frames (state, stateDelta, turnResult mit
+    // Zustand), liefert deren Anzahl
+    int dropQueuedState();
+
+    bool isCongested() const;
+    void setCongested(bool congested);
+    qint64 congestedForMs() const;
+
+    // Verbindung wird wegen Ueberlast geschlossen, nichts mehr senden
+    bool closing = false;
+
+    // laufende Nummer im Shard (erkennt verspaetete Aufrufe fuer schon
+    // geschlossene Verbindungen)
+    quint64 serial = 0;
+
+    // Heartbeat (nur Clients mit "heartbeat"-Faehigkeit, sonst TCP-Keepalive)
+    bool heartbeat = false;
+    int wheelSlot = 0;
+    int missedPings = 0;
+    bool awaitingPong = false;
+    quint32 pingSeq = 0;
+    void addRttSample(qint64 sampleMs);
+    double smoothedRttMs() const;
+
+    // schreibt alles Gesammelte mit einem write(); liefert die Byteanzahl,
+    // frames (optional) die Anzahl Frames
+    qint64 writeQueued(int *frames = nullptr);
+
+    // true: fuer diesen Event-Loop-Durchlauf ist schon ein Flush geplant,
+    // weitere Frames werden nur gesammelt
+    bool flushScheduled = false;
+
+private:
+    std::unique_ptr<Transport> transport;
+    Protocol::FrameReader reader;
+
+    struct QueuedFrame {
+        QByteArray data;
+        bool stateFrame = false;
+    };
+    QVector<QueuedFrame> queue;
+    qint64 queued = 0;
+
+    bool congested = false;
+    QElapsedTimer congestedSince;
+
+    // RFC 6298: SRTT = 7/8 SRTT + 1/8 Messung
+    double srtt = -1.0;
+};
+
+#endif // CLIENTCONNECTION_H
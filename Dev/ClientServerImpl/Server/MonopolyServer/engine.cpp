@@ -0,0 +1,671 @@
+#include "engine.h"
+
+#include <algorithm>
+#include <iterator>
+
+namespace Engine {
+
+namespace {
+
+void push(QVector<Event> *events, Event::Type type, const PlayerState &player, Event event = Event())
+{
+    if (!events) return;
+    event.type = type;
+    event.playerId = player.id;
+    event.money = player.money;
+    event.position = player.position;
+    event.inJail = player.inJail;
+    event.jailTurns = player.jailTurns;
+    event.ready = player.ready;
+    events->append(event);
+}
+
+PlayerState *findPlayer(State &state, int playerId)
+{
+    for (PlayerState &p : state.players) {
+        if (p.id == playerId) return &p;
+    }
+    return nullptr;
+}
+
+int currentIndex(const State &state)
+{
+    const int count = state.players.size();
+    if (count == 0) return -1;
+
+    int index = state.current >= 0 && state.current < count ? state.current : 0;
+    const int start = index;
+    while (state.players[index].bankrupt) {
+        index = (index + 1) % count;
+        if (index == start) break;
+    }
+    return index;
+}
+
+void pay(PlayerState &player, int amount)
+{
+    player.money -= amount;
+    if (player.money < 0) {
+        player.bankrupt = true;
+    }
+}
+
+void awaitEnd(State &state, const PlayerState &player, QVector<Event> *events)
+{
+    state.endTurnPlayerId = player.id;
+    push(events, Event::AwaitEnd, player);
+}
+
+void nextTurn(State &state, QVector<Event> *events)
+{
+    state.endTurnPlayerId = -1;
+    if (!state.players.isEmpty()) {
+        state.current = (state.current + 1) % state.players.size();
+    }
+    state.current = std::max(0, currentIndex(state));
+    if (!events) return;
+
+    Event turn;
+    turn.type = Event::Turn;
+    turn.playerId = state.players.isEmpty() ? -1 : state.players[state.current].id;
+    events->append(turn);
+}
+
+// der letzte nicht bankrotte Spieler gewinnt
+bool settleWinner(State &state, QVector<Event> *events)
+{
+    if (state.finished) return false;
+
+    int active = 0;
+    const PlayerState *last = nullptr;
+    for (const PlayerState &p : state.players) {
+        if (!p.bankrupt) {
+            active++;
+            last = &p;
+        }
+    }
+    if (active != 1) return false;
+
+    state.finished = true;
+    state.winnerId = last->id;
+    push(events, Event::Finished, *last);
+    return true;
+}
+
+// Feld unter dem Spieler auswerten: Miete, Steuer, Karte, Gefaengnis, Kaufangebot
+void land(State &state, PlayerState &player, int diceSum, QVector<Event> *events)
+{
+    const int field = player.position;
+    const FieldSpec &spec = board().at(field);
+    Event result;
+    result.field = field;
+
+    switch (spec.kind) {
+    case FieldKind::Street:
+    case FieldKind::Railroad:
+    case FieldKind::Utility: {
+        const int ownerId = state.owner[field];
+        PlayerState *owner = ownerId != player.id ? findPlayer(state, ownerId) : nullptr;
+        if (owner) {
+            result.amount = rent(state, field, diceSum);
+            pay(player, result.amount);
+            owner->money += result.amount;
+            result.otherId = owner->id;
+            result.otherMoney = owner->money;
+            push(events, Event::Rent, player, result);
+        }
+        break;
+    }
+    case FieldKind::Tax:
+        result.amount = spec.amount;
+        pay(player, spec.amount);
+        push(events, Event::Tax, player, result);
+        break;
+    case FieldKind::Start:
+        if (spec.amount != 0) {
+            result.amount = spec.amount;
+            player.money += spec.amount;
+            push(events, Event::Land, player, result);
+        }
+        break;
+    case FieldKind::Card: {
+        const QVector<Card> &deck = cards();
+        result.card = int(state.random.bounded(quint32(deck.size())));
+        result.amount = deck.at(result.card).amount;
+        result.randomDraws = state.random.draws();
+        if (result.amount > 0) {
+            player.money += result.amount;
+        } else if (result.amount < 0) {
+            pay(player, -result.amount);
+        }
+        push(events, Event::Card, player, result);
+        break;
+    }
+    case FieldKind::GoToJail:
+        player.position = jailIndex;
+        player.inJail = true;
+        player.jailTurns = jailTurns;
+        push(events, Event::GoToJail, player, result);
+        awaitEnd(state, player, events);
+        return;
+    case FieldKind::Jail:
+        break; // nur zu Besuch
+    }
+
+    if (player.bankrupt) {
+        releaseAssets(state, player.id);
+        push(events, Event::Bankrupt, player, result);
+        if (settleWinner(state, events)) return;
+    }
+
+    if (spec.isProperty() && state.owner[field] < 0 && player.money >= spec.price) {
+        state.buyPlayerId = player.id;
+        state.buyField = field;
+        result.amount = spec.price;
+        push(events, Event::Offer, player, result);
+        return; // Zug endet erst nach der Kaufentscheidung
+    }
+
+    awaitEnd(state, player, events);
+}
+
+Error roll(State &state, const Action &action, QVector<Event> *events)
+{
+    if (state.finished) return Error::GameOver;
+    if (!state.started) return Error::NotStarted;
+    if (state.endTurnPlayerId >= 0) return Error::AwaitingEndTurn;
+    if (state.buyPlayerId >= 0) return Error::AwaitingBuy;
+
+    const int index = currentIndex(state);
+    if (index < 0) return Error::UnknownPlayer;
+    if (state.players[index].id != action.playerId) return Error::NotYourTurn;
+
+    state.current = index;
+    PlayerState &player = state.players[index];
+
+    // Wartezug in der Berufsschule
+    if (player.inJail) {
+        player.jailTurns--;
+        if (player.jailTurns <= 0) {
+            player.inJail = false;
+            player.jailTurns = 0;
+        }
+        push(events, Event::JailWait, player);
+        awaitEnd(state, player, events);
+        return Error::None;
+    }
+
+    Event dice;
+    dice.d1 = state.random.bounded(1, 7);
+    dice.d2 = state.random.bounded(1, 7);
+    dice.randomDraws = state.random.draws();
+    dice.from = player.position;
+    dice.field = (player.position + dice.d1 + dice.d2) % boardSize;
+
+    player.position += dice.d1 + dice.d2;
+    if (player.position >= boardSize) {
+        player.position -= boardSize;
+        player.money += passStartBonus;
+    }
+    push(events, Event::Dice, player, dice);
+
+    land(state, player, dice.d1 + dice.d2, events);
+    return Error::None;
+}
+
+Error buyDecision(State &state, const Action &action, QVector<Event> *events)
+{
+    if (state.buyPlayerId < 0 || action.playerId != state.buyPlayerId || action.field != state.buyField) {
+        return Error::NoBuyPending;
+    }
+    PlayerState *player = findPlayer(state, action.playerId);
+    if (!player) return Error::UnknownPlayer;
+
+    const FieldSpec &spec = board().at(state.buyField);
+    Event result;
+    result.field = state.buyField;
+    result.amount = spec.price;
+
+    if (action.buy && state.owner[result.field] < 0 && player->money >= spec.price) {
+        state.owner[result.field] = player->id;
+        pay(*player, spec.price);
+        push(events, Event::Bought, *player, result);
+    } else {
+        push(events, Event::Declined, *player, result);
+    }
+
+    state.buyPlayerId = -1;
+    state.buyField = -1;
+    awaitEnd(state, *player, events);
+    return Error::None;
+}
+
+Error buyHouse(State &state, const Action &action, QVector<Event> *events)
+{
+    if (!state.started || state.finished) return Error::NotRunning;
+    if (state.buyPlayerId >= 0) return Error::AwaitingBuy;
+
+    const int index = currentIndex(state);
+    if (index < 0 || state.players[index].id != action.playerId) return Error::NotYourTurn;
+
+    // gebaut wird auf der Strasse, auf der der Spieler steht
+    PlayerState &player = state.players[index];
+    const int field = player.position;
+    const FieldSpec &spec = board().at(field);
+    if (spec.kind != FieldKind::Street || state.owner[field] != player.id) return Error::NotOwnStreet;
+    if (state.hotel[field]) return Error::HasHotel;
+    if (player.money < spec.hotelPrice) return Error::NotEnoughMoney;
+
+    state.current = index;
+    pay(player, spec.hotelPrice);
+    state.hotel[field] = true;
+
+    Event result;
+    result.field = field;
+    result.amount = spec.hotelPrice;
+    push(events, Event::House, player, result);
+    return Error::None;
+}
+
+Error endTurn(State &state, const Action &action, QVector<Event> *events)
+{
+    if (state.finished) return Error::GameOver;
+    if (!state.started) return Error::NotStarted;
+
+    // endTurn mit offenem Kaufangebot = ablehnen
+    const bool declines = state.buyPlayerId >= 0 && state.buyPlayerId == action.playerId;
+    if (state.buyPlayerId >= 0 && !declines) return Error::AwaitingBuy;
+
+    const int index = currentIndex(state);
+    const int waiting = declines ? action.playerId : state.endTurnPlayerId;
+    if (index < 0 || waiting != action.playerId || state.players[index].id != action.playerId) {
+        return Error::CannotEndTurn;
+    }
+
+    state.current = index;
+    const PlayerState &player = state.players[index];
+    if (declines) {
+        Event result;
+        result.field = state.buyField;
+        push(events, Event::Declined, player, result);
+        state.buyPlayerId = -1;
+        state.buyField = -1;
+        awaitEnd(state, player, events);
+    }
+    push(events, Event::EndTurn, player);
+    nextTurn(state, events);
+    return Error::None;
+}
+
+Error surrender(State &state, const Action &action, QVector<Event> *events)
+{
+    if (!state.started || state.finished) return Error::NotRunning;
+
+    PlayerState *player = findPlayer(state, action.playerId);
+    if (!player) return Error::UnknownPlayer;
+
+    const int index = currentIndex(state);
+    const bool wasCurrent = index >= 0 && state.players[index].id == player->id;
+
+    player->bankrupt = true;
+    releaseAssets(state, player->id);
+    clearPending(state, player->id);
+    push(events, Event::Surrendered, *player);
+
+    if (settleWinner(state, events)) return Error::None;
+    if (wasCurrent) {
+        state.current = index;
+        nextTurn(state, events);
+    }
+    return Error::None;
+}
+
+Error leave(State &state, const Action &action, QVector<Event> *events)
+{
+    const int removed = [&state, &action]() {
+        for (int i = 0; i < state.players.size(); ++i) {
+            if (state.players[i].id == action.playerId) return i;
+        }
+        return -1;
+    }();
+    if (removed < 0) return Error::UnknownPlayer;
+
+    push(events, Event::Left, state.players[removed]);
+    clearPending(state, action.playerId);
+    releaseAssets(state, action.playerId);
+    state.players.remove(removed);
+
+    // Zugreihenfolge wie bisher: wer nach dem Gehenden dran war, bleibt dran
+    if (removed < state.current) {
+        state.current--;
+    }
+    if (state.current >= state.players.size()) {
+        state.current = 0;
+    }
+    state.current = std::max(0, currentIndex(state));
+
+    settleWinner(state, events);
+    return Error::None;
+}
+
+Error setReady(State &state, const Action &action, QVector<Event> *events)
+{
+    PlayerState *player = findPlayer(state, action.playerId);
+    if (!player) return Error::UnknownPlayer;
+
+    // auch im laufenden Spiel erlaubt, zaehlt erst wieder fuer den naechsten Start
+    player->ready = action.ready;
+    push(events, Event::Ready, *player);
+    return Error::None;
+}
+
+Error start(State &state, const Action &action, QVector<Event> *events)
+{
+    if (state.started) return Error::AlreadyStarted;
+    if (state.players.size() < minPlayers) return Error::TooFewPlayers;
+    for (const PlayerState &p : state.players) {
+        if (!p.ready) return Error::NotReady;
+    }
+
+    state.started = true;
+    state.finished = false;
+    state.winnerId = -1;
+    if (events) {
+        Event started;
+        started.type = Event::Started;
+        started.playerId = action.playerId;
+        events->append(started);
+    }
+    return Error::None;
+}
+
+Error restart(State &state, const Action &action, QVector<Event> *events)
+{
+    state.started = false;
+    state.finished = false;
+    state.winnerId = -1;
+    state.buyPlayerId = -1;
+    state.buyField = -1;
+    state.endTurnPlayerId = -1;
+    state.current = 0;
+    std::fill(std::begin(state.owner), std::end(state.owner), -1);
+    std::fill(std::begin(state.hotel), std::end(state.hotel), false);
+
+    for (PlayerState &p : state.players) {
+        p.position = 0;
+        p.money = startMoney;
+        p.bankrupt = false;
+        p.inJail = false;
+        p.jailTurns = 0;
+        p.ready = false;
+    }
+
+    if (events) {
+        Event restarted;
+        restarted.type = Event::Restarted;
+        restarted.playerId = action.playerId;
+        events->append(restarted);
+    }
+    return Error::None;
+}
+
+} // namespace
+
+void releaseAssets(State &state, int playerId)
+{
+    for (int i = 0; i < boardSize; ++i) {
+        if (state.owner[i] == playerId) {
+            state.owner[i] = -1;
+            state.hotel[i] = false;
+        }
+    }
+}
+
+void clearPending(State &state, int playerId)
+{
+    if (state.buyPlayerId == playerId) {
+        state.buyPlayerId = -1;
+        state.buyField = -1;
+    }
+    if (state.endTurnPlayerId == playerId) {
+        state.endTurnPlayerId = -1;
+    }
+}
+
+bool FieldSpec::isProperty() const
+{
+    return kind == FieldKind::Street || kind == FieldKind::Railroad || kind == FieldKind::Utility;
+}
+
+const QVector<FieldSpec> &board()
+{
+    static const QVector<FieldSpec> fields = [] {
+        // schnelles Spiel: Preise und Mieten halbiert
+        auto fast = [](int value) {
+            return std::max(1, value / 2);
+        };
+
+        QVector<FieldSpec> b;
+        b.reserve(boardSize);
+        auto add = [&b](FieldKind kind, const QString &name) -> FieldSpec & {
+            FieldSpec f;
+            f.kind = kind;
+            f.name = name;
+            b.append(f);
+            return b.last();
+        };
+        auto start = [&](const QString &name, int bonus) {
+            add(FieldKind::Start, name).amount = fast(bonus);
+        };
+        auto street = [&](const QString &name, const QString &color,
+                          int price, int baseRent, int hotelPrice, int hotelRent) {
+            FieldSpec &f = add(FieldKind::Street, name);
+            f.color = color;
+            f.price = fast(price);
+            f.rent = fast(baseRent * 2);
+            f.hotelPrice = fast(hotelPrice);
+            f.hotelRent = fast(hotelRent);
+        };
+        auto rail = [&](const QString &name, int price, int rent) {
+            FieldSpec &f = add(FieldKind::Railroad, name);
+            f.price = fast(price);
+            f.rent = fast(rent * 2);
+        };
+        auto utility = [&](const QString &name, int price) {
+            add(FieldKind::Utility, name).price = fast(price);
+        };
+        auto tax = [&](const QString &name, int amount) {
+            add(FieldKind::Tax, name).amount = fast(amount);
+        };
+        auto card = [&](const QString &name) {
+            add(FieldKind::Card, name);
+        };
+
+        start("Start", 300);
+        street("Altbau", "Braun", 60, 2, 50, 10);
+        card("Unterricht");
+        street("Sporthalle", "Braun", 60, 4, 50, 20);
+        tax("Papiergeld", 100);
+        rail("Erlanger Bahnhof", 200, 25);
+        street("Kaufland", "Hellblau", 100, 6, 50, 30);
+        card("Unterricht");
+        street("Back21", "Hellblau", 100, 6, 50, 30);
+        street("Brezenkolb", "Hellblau", 120, 8, 50, 40);
+        add(FieldKind::Jail, "Berufsschule / Schulfrei");
+        street("Franken Doener", "Pink", 140, 10, 100, 50);
+        utility("Wasserspender", 150);
+        street("Berliner Doener", "Pink", 140, 10, 100, 50);
+        street("Subway", "Pink", 160, 12, 100, 60);
+        rail("Nuernberger Bahnhof", 200, 25);
+        street("Sekretariat", "Orange", 180, 14, 100, 70);
+        card("Unterricht");
+        street("Lehrerzimmer", "Orange", 180, 14, 100, 70);
+        street("Buero-Direktor", "Orange", 200, 16, 100, 80);
+        tax("Ferien", 0);
+        street("Neubau", "Rot", 220, 18, 150, 90);
+        card("Unterricht");
+        street("FOS", "Rot", 220, 18, 150, 90);
+        street("Pausenhof", "Rot", 240, 20, 150, 100);
+        rail("Busbahnhof Erlangen", 200, 25);
+        street("Serverraum", "Gelb", 260, 22, 150, 110);
+        street("Lager", "Gelb", 260, 22, 150, 110);
+        utility("Toilette", 150);
+        street("Klassenraum", "Gelb", 280, 24, 150, 120);
+        add(FieldKind::GoToJail, "Gehe zu Berufsschule");
+        street("IHK Pruefungshalle", "Gruen", 300, 26, 200, 130);
+        street("Fraenky", "Gruen", 300, 26, 200, 130);
+        card("Unterricht");
+        street("DerBeck", "Gruen", 320, 28, 200, 150);
+        rail("Baiersdorfer Bahnhof", 200, 25);
+        card("Unterricht");
+        street("Berufsagentur", "Dunkelblau", 350, 35, 200, 175);
+        tax("Papiergeld", 100);
+        street("ProLeiT", "Dunkelblau", 400, 50, 200, 200);
+
+        Q_ASSERT(b.size() == boardSize);
+        return b;
+    }();
+    return fields;
+}
+
+const QVector<Card> &cards()
+{
+    // Reihenfolge nicht aendern: Journal und Replays ziehen per Index
+    static const QVector<Card> deck = {
+        {"Zu spaet zum Unterricht!  Zahle 50$",  -50},
+        {"Hausaufgaben gemacht!  Erhalte 40$",    40},
+        {"Test bestanden!  Erhalte 80$",           80},
+        {"Im Unterricht geschlafen!  Zahle 60$",  -60},
+        {"Handy im Unterricht erwischt!  Zahle 40$", -40},
+        {"Frueher Schulschluss!  Erhalte 50$",     50},
+        {"Fehler im Code gefunden!  Erhalte 70$",  70},
+        {"Hausaufgaben vergessen!  Zahle 35$",     -35},
+        {"Vorzeigeschueler des Monats!  Erhalte 100$", 100},
+        {"Schule geschwanzt!  Zahle 80$",          -80},
+        {"Klassensprecher gewaehlt!  Erhalte 60$",   60},
+        {"Nachsitzen!  Zahle 30$",                 -30},
+    };
+    return deck;
+}
+
+State::State()
+{
+    std::fill(std::begin(owner), std::end(owner), -1);
+    std::fill(std::begin(hotel), std::end(hotel), false);
+}
+
+Error step(State &state, const Action &action, QVector<Event> *events)
+{
+    switch (action.type) {
+    case Action::Start:
+        return start(state, action, events);
+    case Action::Roll:
+        return roll(state, action, events);
+    case Action::BuyDecision:
+        return buyDecision(state, action, events);
+    case Action::BuyHouse:
+        return buyHouse(state, action, events);
+    case Action::EndTurn:
+        return endTurn(state, action, events);
+    case Action::Surrender:
+        return surrender(state, action, events);
+    case Action::Restart:
+        return restart(state, action, events);
+    case Action::Leave:
+        return leave(state, action, events);
+    case Action::SetReady:
+        return setReady(state, action, events);
+    }
+    return Error::UnknownPlayer;
+}
+
+Result reduce(State state, const Action &action)
+{
+    Result result;
+    result.error = step(state, action, &result.events);
+    result.state = std::move(state);
+    return result;
+}
+
+QString errorText(Action::Type type, Error error)
+{
+    switch (error) {
+    case Error::None:
+    case Error::NoBuyPending:
+    case Error::UnknownPlayer:
+        break;
+    case Error::AlreadyStarted:
+        return QStringLiteral("Game already started.");
+    case Error::TooFewPlayers:
+        return QStringLiteral("Mindestens 2 Spieler noetig um zu starten.");
+    case Error::NotReady:
+        return QStringLiteral("Alle Spieler muessen bereit sein, bevor das Spiel startet.");
+    case Error::NotStarted:
+        return type == Action::Roll
+                ? QStringLiteral("Spiel ist noch nicht gestartet. Sende {\"type\":\"startGame\"}.")
+                : QStringLiteral("Spiel ist noch nicht gestartet.");
+    case Error::GameOver:
+        return QStringLiteral("Spiel ist bereits beendet.");
+    case Error::NotRunning:
+        return type == Action::Surrender
+                ? QStringLiteral("Aufgeben ist nur waehrend eines laufenden Spiels moeglich.")
+                : QStringLiteral("Hauskauf ist nur waehrend eines laufenden Spiels moeglich.");
+    case Error::NotYourTurn:
+        return QStringLiteral("Du bist nicht dran.");
+    case Error::AwaitingEndTurn:
+        return QStringLiteral("Bitte zuerst den Zug beenden.");
+    case Error::AwaitingBuy:
+        if (type == Action::BuyHouse) {
+            return QStringLiteral("Warte auf Kaufentscheidung. Hauskauf derzeit gesperrt.");
+        }
+        if (type == Action::EndTurn) {
+            return QStringLiteral("Erst Kaufentscheidung treffen.");
+        }
+        return QStringLiteral("Warte auf Kaufentscheidung. Erst buyDecision senden.");
+    case Error::NotOwnStreet:
+        return QStringLiteral("Hauskauf nur auf eigener Strasse moeglich.");
+    case Error::HasHotel:
+        return QStringLiteral("Es steht bereits ein Haus.");
+    case Error::NotEnoughMoney:
+        return QStringLiteral("Nicht genug Geld fuer ein Haus.");
+    case Error::CannotEndTurn:
+        return QStringLiteral("Du kannst den Zug gerade nicht beenden.");
+    }
+    return QString();
+}
+
+const PlayerState *currentPlayer(const State &state)
+{
+    const int index = currentIndex(state);
+    return index >= 0 ? &state.players[index] : nullptr;
+}
+
+int rent(const State &state, int field, int diceSum)
+{
+    const FieldSpec &spec = board().at(field);
+    switch (spec.kind) {
+    case FieldKind::Street:
+        return state.hotel[field] ? spec.hotelRent : spec.rent;
+    case FieldKind::Railroad:
+        return spec.rent; // spaeter: abhaengig von Anzahl Bahnhoefe
+    case FieldKind::Utility:
+        return diceSum * 6;
+    default:
+        return 0;
+    }
+}
+
+bool BuyPolicy::wantsToBuy(int money, int price) const
+{
+    switch (mode) {
+    case Always:
+        return money >= price;
+    case KeepReserve:
+        return money - price >= minMoneyAfter;
+    case Never:
+        break;
+    }
+    return false;
+}
+
+} // namespace Engine
@@ -0,0 +1,159 @@
+#ifndef ENGINE_H
+#define ENGINE_H
+
+#include <QString>
+#include <QVector>
+
+#include "roomrandom.h"
+
+// Spielregeln ohne Netzwerk, JSON und Sockets (nur Qt Core): ein Reducer
+//   step(state, action) -> neuer state + Ereignisse
+// Server, Simulatoren und Bots rechnen damit dieselben Zuege. Zufall kommt
+// nur aus state.random - gleicher Zustand und gleiche Aktion ergeben immer
+// dasselbe Ergebnis. Ereignisse tragen die neuen Werte (Position, Kontostand),
+// der Server macht daraus Journal, Logs und Nachrichten.
+namespace Engine
+{
+    constexpr int boardSize = 40;
+    constexpr int jailIndex = 10;      // Berufsschule
+    constexpr int jailTurns = 3;
+    constexpr int startMoney = 1500;
+    constexpr int passStartBonus = 300;
+    constexpr int minPlayers = 2;
+
+    enum class FieldKind : quint8 { Start, Street, Railroad, Utility, Tax, Jail, GoToJail, Card };
+
+    // statische Felddaten; amount = Startbonus bzw. Steuer
+    struct FieldSpec {
+        FieldKind kind = FieldKind::Jail;
+        QString name;
+        QString color;
+        int price = 0;
+        int rent = 0;
+        int hotelPrice = 0;
+        int hotelRent = 0;
+        int amount = 0;
+
+        bool isProperty() const;
+    };
+    const QVector<FieldSpec> &board();
+
+    struct Card {
+        QString text;
+        int amount; // positiv = erhalten, negativ = zahlen
+    };
+    const QVector<Card> &cards();
+
+    struct PlayerState {
+        int id = 0;
+        int position = 0;
+        int money = startMoney;
+        bool bankrupt = false;
+        bool inJail = false;
+        int jailTurns = 0;
+        bool ready = false;
+    };
+
+    struct State {
+        QVector<PlayerState> players; // Zugreihenfolge
+        int current = 0;              // Index in players
+        int owner[boardSize];         // Spieler-ID je Feld, -1 = frei
+        bool hotel[boardSize];
+        bool started = false;
+        bool finished = false;
+        int winnerId = -1;
+        int buyPlayerId = -1;         // offene Kaufentscheidung, -1 = keine
+        int buyField = -1;
+        int endTurnPlayerId = -1;     // wartet auf endTurn, -1 = niemand
+        RoomRandom random;
+
+        State();
+    };
+
+    struct Action {
+        enum Type : quint8 { Start, Roll, BuyDecision, BuyHouse, EndTurn, Surrender, Restart, Leave, SetReady };
+        Type type = Roll;
+        int playerId = -1;
+        int field = -1;    // BuyDecision
+        bool buy = false;  // BuyDecision
+        bool ready = false; // SetReady
+    };
+
+    struct Event {
+        enum Type : quint8 {
+            Started, Restarted,
+            JailWait,   // Wartezug im Gefaengnis
+            Dice,       // d1, d2, from -> position, money inkl. Startbonus
+            Rent,       // amount an otherId
+            Tax, Card, Land,
+            GoToJail, Bankrupt, Finished,
+            Offer,      // amount = Preis, Antwort per BuyDecision
+            Bought, Declined, House,
+            AwaitEnd, EndTurn,
+            Turn,       // playerId = naechster Spieler
+            Surrendered, Left,
+            Ready       // ready = neuer Wert
+        };
+        Type type = Started;
+        int playerId = -1;     // Finished: Gewinner
+        int field = -1;
+        int amount = 0;        // Miete, Steuer, Karte (+/-), Preis, Bonus
+        int money = 0;         // Kontostand von playerId danach
+        int position = 0;
+        bool inJail = false;
+        int jailTurns = 0;
+        bool ready = false;
+        int otherId = -1;      // Rent: Empfaenger
+        int otherMoney = 0;
+        int d1 = 0;
+        int d2 = 0;
+        int from = 0;          // Dice: Feld vor dem Zug
+        int card = -1;         // Index in cards()
+        quint64 randomDraws = 0; // Dice, Card: Stand von state.random danach
+    };
+
+    enum class Error : quint8 {
+        None,
+        AlreadyStarted, TooFewPlayers, NotReady,
+        NotStarted, GameOver, NotRunning,
+        NotYourTurn, AwaitingEndTurn, AwaitingBuy, NoBuyPending,
+        NotOwnStreet, HasHotel, NotEnoughMoney,
+        CannotEndTurn, UnknownPlayer
+    };
+
+    // wendet action auf state an; bei Fehler bleibt state unveraendert.
+    // events darf nullptr sein (Simulation ohne Auswertung)
+    Error step(State &state, const Action &action, QVector<Event> *events);
+
+    struct Result {
+        State state;
+        QVector<Event> events;
+        Error error = Error::None;
+    };
+    Result reduce(State state, const Action &action);
+
+    // Text fuer den Spieler, leer = stillschweigend ignorieren
+    QString errorText(Action::Type type, Error error);
+
+    // wer gerade dran ist (bankrotte Spieler werden uebersprungen), nullptr ohne Spieler
+    const PlayerState *currentPlayer(const State &state);
+
+    // Teilschritte fuer das Nachspielen des Journals: Besitz eines Spielers
+    // freigeben, seine offene Kauf-/Zugende-Entscheidung verwerfen
+    void releaseAssets(State &state, int playerId);
+    void clearPending(State &state, int playerId);
+
+    int rent(const State &state, int field, int diceSum);
+
+    // Kaufregel fuer autoTurn und Bots ("never", "always",
+    // "reserve" = kaufen, solange danach noch minMoneyAfter uebrig ist)
+    struct BuyPolicy {
+        enum Mode { Never, Always, KeepReserve };
+        Mode mode = Never;
+        int minMoneyAfter = 0;
+
+        bool wantsToBuy(int money, int price) const;
+    };
+}
+
+#endif // ENGINE_H
@@ -0,0 +1,92 @@
+// Regel-Durchsatz ohne Server: spielt G Partien mit P Spielern direkt auf
+// Engine::step, ohne Sockets, JSON und Journal.
+//
+// Jeder Spieler wuerfelt, kauft nach der "reserve"-Regel (danach bleiben
+// mindestens 200$) und beendet den Zug, bis einer gewinnt oder T Zuege
+// gespielt sind. Gleicher --seed ergibt dieselben Partien.
+//
+// Aufruf: MonopolyEngineBench [--games G] [--players P] [--turns T] [--seed S]
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QStringList>
+
+#include "engine.h"
+
+#include <algorithm>
+#include <cstdio>
+
+namespace {
+
+int argValue(const QStringList &args, const QString &name, int fallback)
+{
+    const int at = args.indexOf(name);
+    return at >= 0 && at + 1 < args.size() ? args.at(at + 1).toInt() : fallback;
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    const QStringList args = app.arguments();
+    const int games = std::max(1, argValue(args, "--games", 10000));
+    const int playerCount = std::clamp(argValue(args, "--players", 4), Engine::minPlayers, 8);
+    const int maxTurns = std::max(1, argValue(args, "--turns", 1000));
+    const int seedAt = args.indexOf("--seed");
+    const quint64 seed = seedAt >= 0 ? args.value(seedAt + 1).toULongLong() : 1;
+
+    Engine::BuyPolicy policy;
+    policy.mode = Engine::BuyPolicy::KeepReserve;
+    policy.minMoneyAfter = 200;
+
+    quint64 turns = 0;
+    quint64 events = 0;
+    int finished = 0;
+    QVector<Engine::Event> buffer;
+    buffer.reserve(32);
+
+    QElapsedTimer timer;
+    timer.start();
+    for (int g = 0; g < games; ++g) {
+        Engine::State state;
+        state.random = RoomRandom(RoomRandom::mix(seed + quint64(g)));
+        for (int i = 0; i < playerCount; ++i) {
+            Engine::PlayerState player;
+            player.id = i + 1;
+            player.ready = true;
+            state.players.append(player);
+        }
+        Engine::step(state, {Engine::Action::Start, 1}, nullptr);
+
+        for (int t = 0; t < maxTurns && !state.finished; ++t) {
+            const int id = Engine::currentPlayer(state)->id;
+            buffer.clear();
+            Engine::step(state, {Engine::Action::Roll, id}, &buffer);
+
+            if (state.buyPlayerId == id) {
+                const Engine::FieldSpec &field = Engine::board().at(state.buyField);
+                const int money = Engine::currentPlayer(state)->money;
+                Engine::Action decision{Engine::Action::BuyDecision, id, state.buyField,
+                                        policy.wantsToBuy(money, field.price)};
+                Engine::step(state, decision, &buffer);
+            }
+            if (!state.finished && state.endTurnPlayerId == id) {
+                Engine::step(state, {Engine::Action::EndTurn, id}, &buffer);
+            }
+            turns++;
+            events += quint64(buffer.size());
+        }
+        if (state.finished) {
+            finished++;
+        }
+    }
+
+    const double seconds = double(std::max<qint64>(timer.nsecsElapsed(), 1)) / 1e9;
+    std::printf("games=%d players=%d finished=%d turns=%llu events=%llu %.1fms\n",
+                games, playerCount, finished,
+                static_cast<unsigned long long>(turns),
+                static_cast<unsigned long long>(events), seconds * 1000.0);
+    std::printf("%.0f turns/s  %.0f events/s\n", double(turns) / seconds, double(events) / seconds);
+    return 0;
+}
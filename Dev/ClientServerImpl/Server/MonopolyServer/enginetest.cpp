@@ -0,0 +1,219 @@
+// Engine-Determinismus: gleicher Seed und gleiche Aktionen ergeben Byte fuer
+// Byte dieselben Ereignisse und denselben Endzustand - egal ob per step()
+// am Stueck gespielt oder per reduce() aus dem Aktions-Log nachgespielt.
+// Darauf verlassen sich Journal-Wiederherstellung und Checkpoints.
+
+#include <QDataStream>
+#include <QtTest>
+
+#include "engine.h"
+
+namespace {
+
+constexpr int playerCount = 4;
+constexpr int maxTurns = 300;
+
+void writeState(QDataStream &out, const Engine::State &state)
+{
+    out << qint32(state.players.size());
+    for (const Engine::PlayerState &p : state.players) {
+        out << p.id << p.position << p.money << p.bankrupt << p.inJail << p.jailTurns << p.ready;
+    }
+    out << state.current;
+    for (int i = 0; i < Engine::boardSize; ++i) {
+        out << state.owner[i] << state.hotel[i];
+    }
+    out << state.started << state.finished << state.winnerId
+        << state.buyPlayerId << state.buyField << state.endTurnPlayerId
+        << state.random.seed() << state.random.draws();
+}
+
+void writeEvents(QDataStream &out, const QVector<Engine::Event> &events)
+{
+    for (const Engine::Event &e : events) {
+        out << quint8(e.type) << e.playerId << e.field << e.amount << e.money
+            << e.position << e.inJail << e.jailTurns << e.ready << e.otherId << e.otherMoney
+            << e.d1 << e.d2 << e.from << e.card << e.randomDraws;
+    }
+}
+
+Engine::State newGame(quint64 seed)
+{
+    Engine::State state;
+    state.random = RoomRandom(seed);
+    for (int i = 0; i < playerCount; ++i) {
+        Engine::PlayerState player;
+        player.id = i + 1;
+        state.players.append(player);
+    }
+    return state;
+}
+
+// eine Partie wie im enginebench, mit Aktions-Log und Byte-Abbild
+struct Game {
+    Engine::State state;
+    QVector<Engine::Action> actions;
+    QByteArray trace;
+    int errors = 0;
+};
+
+Game play(quint64 seed)
+{
+    Game game;
+    game.state = newGame(seed);
+    QDataStream out(&game.trace, QIODevice::WriteOnly);
+
+    Engine::BuyPolicy policy;
+    policy.mode = Engine::BuyPolicy::KeepReserve;
+    policy.minMoneyAfter = 200;
+
+    auto apply = [&](const Engine::Action &action) {
+        QVector<Engine::Event> events;
+        if (Engine::step(game.state, action, &events) != Engine::Error::None) {
+            game.errors++;
+        }
+        game.actions.append(action);
+        writeEvents(out, events);
+    };
+
+    // auch "bereit" laeuft ueber step(): Start prueft es
+    for (int id = 1; id <= playerCount; ++id) {
+        Engine::Action ready{Engine::Action::SetReady, id};
+        ready.ready = true;
+        apply(ready);
+    }
+    apply({Engine::Action::Start, 1});
+    for (int t = 0; t < maxTurns && !game.state.finished; ++t) {
+        const int id = Engine::currentPlayer(game.state)->id;
+        apply({Engine::Action::Roll, id});
+        if (game.state.buyPlayerId == id) {
+            const int field = game.state.buyField;
+            const int money = Engine::currentPlayer(game.state)->money;
+            apply({Engine::Action::BuyDecision, id, field,
+                   policy.wantsToBuy(money, Engine::board().at(field).price)});
+        }
+        if (!game.state.finished && game.state.endTurnPlayerId == id) {
+            apply({Engine::Action::EndTurn, id});
+        }
+    }
+    writeState(out, game.state);
+    return game;
+}
+
+} // namespace
+
+class EngineTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void sameSeedSameGame();
+    void otherSeedOtherGame();
+    void reduceReplaysStep();
+    void startNeedsEveryoneReady();
+    void rejectedActionKeepsState();
+    void randomAdvanceTo();
+};
+
+void EngineTest::sameSeedSameGame()
+{
+    for (quint64 seed : {1ull, 42ull, 0x9e3779b97f4a7c15ull}) {
+        const Game first = play(seed);
+        const Game second = play(seed);
+        QCOMPARE(first.errors, 0);
+        QVERIFY(first.actions.size() > 10);
+        QCOMPARE(second.trace, first.trace);
+    }
+}
+
+void EngineTest::otherSeedOtherGame()
+{
+    QVERIFY(play(1).trace != play(2).trace);
+}
+
+void EngineTest::reduceReplaysStep()
+{
+    const quint64 seed = 7;
+    const Game original = play(seed);
+
+    // nur Aktionen und Ausgangszustand, Zufall allein aus state.random
+    Engine::State state = newGame(seed);
+    QByteArray trace;
+    QDataStream out(&trace, QIODevice::WriteOnly);
+    for (const Engine::Action &action : original.actions) {
+        Engine::Result result = Engine::reduce(state, action);
+        QCOMPARE(int(result.error), int(Engine::Error::None));
+        writeEvents(out, result.events);
+        state = std::move(result.state);
+    }
+    writeState(out, state);
+
+    QCOMPARE(trace, original.trace);
+}
+
+void EngineTest::startNeedsEveryoneReady()
+{
+    Engine::State state = newGame(3);
+    Engine::Action ready{Engine::Action::SetReady, 0};
+    ready.ready = true;
+    for (int i = 0; i < playerCount; ++i) {
+        QCOMPARE(int(Engine::step(state, {Engine::Action::Start, 1}, nullptr)),
+                 int(Engine::Error::NotReady));
+        ready.playerId = state.players.at(i).id;
+        QVector<Engine::Event> events;
+        QCOMPARE(int(Engine::step(state, ready, &events)), int(Engine::Error::None));
+        QCOMPARE(events.size(), 1);
+        QCOMPARE(int(events.at(0).type), int(Engine::Event::Ready));
+        QVERIFY(events.at(0).ready);
+    }
+    QCOMPARE(int(Engine::step(state, {Engine::Action::Start, 1}, nullptr)), int(Engine::Error::None));
+    QVERIFY(state.started);
+}
+
+void EngineTest::rejectedActionKeepsState()
+{
+    Engine::State state = newGame(3);
+    for (int id = 1; id <= playerCount; ++id) {
+        Engine::Action ready{Engine::Action::SetReady, id};
+        ready.ready = true;
+        QCOMPARE(int(Engine::step(state, ready, nullptr)), int(Engine::Error::None));
+    }
+    QCOMPARE(int(Engine::step(state, {Engine::Action::Start, 1}, nullptr)), int(Engine::Error::None));
+
+    QByteArray before;
+    {
+        QDataStream out(&before, QIODevice::WriteOnly);
+        writeState(out, state);
+    }
+
+    // nicht dran: kein Wurf, kein Zug an state.random
+    const int other = state.players.at((state.current + 1) % playerCount).id;
+    QVector<Engine::Event> events;
+    QCOMPARE(int(Engine::step(state, {Engine::Action::Roll, other}, &events)),
+             int(Engine::Error::NotYourTurn));
+    QVERIFY(events.isEmpty());
+
+    QByteArray after;
+    {
+        QDataStream out(&after, QIODevice::WriteOnly);
+        writeState(out, state);
+    }
+    QCOMPARE(after, before);
+}
+
+void EngineTest::randomAdvanceTo()
+{
+    RoomRandom drawn(1234);
+    for (int i = 0; i < 100; ++i) {
+        drawn.next();
+    }
+    RoomRandom restored(1234);
+    restored.advanceTo(drawn.draws());
+    QCOMPARE(restored.draws(), drawn.draws());
+    for (int i = 0; i < 16; ++i) {
+        QCOMPARE(restored.next(), drawn.next());
+    }
+}
+
+QTEST_GUILESS_MAIN(EngineTest)
+#include "enginetest.moc"
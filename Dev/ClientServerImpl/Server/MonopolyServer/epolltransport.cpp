@@ -0,0 +1,409 @@
+#include "epolltransport.h"
+
+#include <QDebug>
+
+#include <arpa/inet.h>
+#include <cerrno>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace {
+
+thread_local EpollLoop *currentLoop = nullptr;
+
+// Markierung fuer den Listener im epoll-Set (Transports tragen ihren Zeiger)
+char listenerTag;
+
+constexpr quint32 connectionEvents = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET;
+
+} // namespace
+
+EpollLoop::EpollLoop(QObject *parent)
+    : QObject(parent)
+    , events(new epoll_event[maxEvents])
+{
+    epollFd = epoll_create1(EPOLL_CLOEXEC);
+    if (epollFd < 0) {
+        qWarning() << "[EPOLL] epoll_create1 fehlgeschlagen, errno" << errno;
+        return;
+    }
+
+    // der epoll-fd selbst wird lesbar, sobald irgendein Socket ein Ereignis hat
+    notifier = new QSocketNotifier(epollFd, QSocketNotifier::Read, this);
+    connect(notifier, &QSocketNotifier::activated, this, &EpollLoop::process);
+    currentLoop = this;
+}
+
+EpollLoop::~EpollLoop()
+{
+    if (currentLoop == this) {
+        currentLoop = nullptr;
+    }
+    for (int fd : std::as_const(listenFds)) {
+        ::close(fd);
+    }
+    if (epollFd >= 0) {
+        ::close(epollFd);
+    }
+    delete[] events;
+}
+
+EpollLoop *EpollLoop::current()
+{
+    return currentLoop;
+}
+
+bool EpollLoop::isValid() const
+{
+    return epollFd >= 0;
+}
+
+bool EpollLoop::listen(quint16 port, std::function<void(int fd)> onAccept)
+{
+    if (!isValid()) return false;
+
+    const int fd = ::socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0) return false;
+
+    const int one = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, &one, sizeof(one));
+
+    sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    addr.sin_port = htons(port);
+    if (::bind(fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) < 0
+        || ::listen(fd, SOMAXCONN) < 0) {
+        qWarning() << "[EPOLL] Port" << port << "nicht verfuegbar, errno" << errno;
+        ::close(fd);
+        return false;
+    }
+    if (!watchListener(fd, std::move(onAccept))) {
+        ::close(fd);
+        return false;
+    }
+    return true;
+}
+
+bool EpollLoop::adoptListener(int fd, std::function<void(int fd)> onAccept)
+{
+    if (!isValid() || fd < 0) return false;
+
+    // der Listener des Qt-Backends kommt womoeglich blockierend
+    const int flags = fcntl(fd, F_GETFL);
+    if (flags < 0 || fcntl(fd, F_SETFL, flags | O_NONBLOCK) < 0) return false;
+    // bereits wartende Verbindungen meldet epoll beim Registrieren selbst
+    return watchListener(fd, std::move(onAccept));
+}
+
+bool EpollLoop::watchListener(int fd, std::function<void(int)> onAccept)
+{
+    if (!listenPaused) {
+        epoll_event ev = {};
+        ev.events = EPOLLIN | EPOLLET;
+        ev.data.ptr = &listenerTag;
+        if (epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &ev) < 0) return false;
+    }
+    listenFds.append(fd);
+    acceptHandler = std::move(onAccept);
+    return true;
+}
+
+QVector<int> EpollLoop::listeners() const
+{
+    return listenFds;
+}
+
+void EpollLoop::pauseListening()
+{
+    if (listenPaused) return;
+    listenPaused = true;
+    for (int fd : std::as_const(listenFds)) {
+        epoll_ctl(epollFd, EPOLL_CTL_DEL, fd, nullptr);
+    }
+    // schon abgeholte Listener-Ereignisse dieses Schwungs verwerfen
+    for (int i = eventIndex; i < eventCount; ++i) {
+        if (events[i].data.ptr == &listenerTag) {
+            events[i].data.ptr = nullptr;
+        }
+    }
+}
+
+void EpollLoop::resumeListening()
+{
+    if (!listenPaused) return;
+    listenPaused = false;
+    for (int fd : std::as_const(listenFds)) {
+        epoll_event ev = {};
+        ev.events = EPOLLIN | EPOLLET;
+        ev.data.ptr = &listenerTag;
+        epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &ev);
+    }
+}
+
+bool EpollLoop::add(EpollTransport *transport)
+{
+    epoll_event ev = {};
+    ev.events = connectionEvents;
+    ev.data.ptr = transport;
+    return epoll_ctl(epollFd, EPOLL_CTL_ADD, transport->fd, &ev) == 0;
+}
+
+void EpollLoop::remove(EpollTransport *transport)
+{
+    epoll_ctl(epollFd, EPOLL_CTL_DEL, transport->fd, nullptr);
+
+    // schon abgeholte, noch nicht verarbeitete Ereignisse verwerfen
+    for (int i = eventIndex; i < eventCount; ++i) {
+        if (events[i].data.ptr == transport) {
+            events[i].data.ptr = nullptr;
+        }
+    }
+}
+
+void EpollLoop::process()
+{
+    eventCount = epoll_wait(epollFd, events, maxEvents, 0);
+    for (eventIndex = 0; eventIndex < eventCount; ) {
+        const epoll_event &ev = events[eventIndex++];
+        if (ev.data.ptr == &listenerTag) {
+            acceptAll();
+        } else if (ev.data.ptr) {
+            static_cast<EpollTransport *>(ev.data.ptr)->handleEvents(ev.events);
+        }
+    }
+    eventCount = 0;
+    eventIndex = 0;
+}
+
+void EpollLoop::acceptAll()
+{
+    if (listenPaused) return;
+
+    // edge-triggered: jeden Listener bis EAGAIN leeren, sonst kommt kein
+    // neues Ereignis
+    for (int listenFd : std::as_const(listenFds)) {
+        while (true) {
+            const int fd = accept4(listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+            if (fd < 0) {
+                if (errno == EINTR || errno == ECONNABORTED) continue;
+                if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                    qWarning() << "[EPOLL] accept4 fehlgeschlagen, errno" << errno;
+                }
+                break;
+            }
+
+            const int one = 1;
+            setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+            setsockopt(fd, SOL_SOCKET, SO_KEEPALIVE, &one, sizeof(one));
+            acceptHandler(fd);
+        }
+    }
+}
+
+EpollTransport::EpollTransport(int fd)
+    : fd(fd)
+{
+}
+
+EpollTransport::~EpollTransport()
+{
+    detach();
+    if (fd >= 0) {
+        ::close(fd);
+    }
+}
+
+int EpollTransport::descriptor() const
+{
+    return fd;
+}
+
+void EpollTransport::attach(const Events &newEvents)
+{
+    detach();
+    events = newEvents;
+    loop = EpollLoop::current();
+    if (fd < 0 || !loop || !loop->add(this)) {
+        // keine Loop in diesem Thread oder Socket schon zu
+        loop = nullptr;
+        peerClosed = true;
+    }
+    // bereits anstehende Daten meldet epoll beim Registrieren selbst
+}
+
+void EpollTransport::detach()
+{
+    if (loop) {
+        loop->remove(this);
+        loop = nullptr;
+    }
+    events = Events();
+}
+
+void EpollTransport::moveToThread(QThread *)
+{
+    // nichts an Threads gebunden, attach() im Ziel registriert neu
+}
+
+bool EpollTransport::isConnected() const
+{
+    return fd >= 0 && !peerClosed;
+}
+
+QString EpollTransport::peerInfo() const
+{
+    sockaddr_in addr{};
+    socklen_t len = sizeof(addr);
+    char host[INET_ADDRSTRLEN] = {};
+    if (fd < 0 || ::getpeername(fd, reinterpret_cast<sockaddr *>(&addr), &len) != 0
+        || !::inet_ntop(AF_INET, &addr.sin_addr, host, sizeof(host))) {
+        return QString("tcp:?");
+    }
+    return QString("tcp:%1:%2").arg(QString::fromLatin1(host)).arg(ntohs(addr.sin_port));
+}
+
+qint64 EpollTransport::readInto(Protocol::FrameReader &reader)
+{
+    // edge-triggered: lesen bis EAGAIN
+    static constexpr qsizetype chunk = 64 * 1024;
+    qint64 total = 0;
+    while (fd >= 0) {
+        char *space = reader.reserve(chunk);
+        const ssize_t got = ::recv(fd, space, size_t(chunk), 0);
+        if (got > 0) {
+            reader.commit(got);
+            total += got;
+            if (got < chunk) break; // Puffer im Kernel leer
+            continue;
+        }
+        reader.commit(0);
+        if (got == 0) {
+            peerClosed = true;
+        } else if (errno == EINTR) {
+            continue;
+        } else if (errno != EAGAIN && errno != EWOULDBLOCK) {
+            peerClosed = true;
+        }
+        break;
+    }
+    return total;
+}
+
+bool EpollTransport::hasBytesAvailable() const
+{
+    return false;
+}
+
+void EpollTransport::write(const QByteArray &data)
+{
+    if (fd < 0 || data.isEmpty()) return;
+
+    // Puffer leer: direkt senden, nur den Rest aufheben
+    if (outBuffer.size() == outOffset) {
+        outBuffer = data;
+        outOffset = 0;
+    } else {
+        outBuffer.append(data);
+    }
+    drain();
+}
+
+void EpollTransport::flush()
+{
+    drain();
+}
+
+qint64 EpollTransport::bytesToWrite() const
+{
+    return outBuffer.size() - outOffset;
+}
+
+void EpollTransport::close()
+{
+    closeWhenDrained = true;
+    if (bytesToWrite() == 0) {
+        shutdown();
+    }
+}
+
+void EpollTransport::abort()
+{
+    shutdown();
+}
+
+int EpollTransport::releaseDescriptor()
+{
+    if (fd < 0 || peerClosed || bytesToWrite() > 0) return -1;
+
+    // ohne close(): der Socket lebt beim Nachfolger weiter
+    detach();
+    const int released = fd;
+    fd = -1;
+    peerClosed = true;
+    return released;
+}
+
+bool EpollTransport::drain()
+{
+    bool progressed = false;
+    while (fd >= 0 && outOffset < outBuffer.size()) {
+        const ssize_t sent = ::send(fd, outBuffer.constData() + outOffset,
+                                    size_t(outBuffer.size() - outOffset), MSG_NOSIGNAL);
+        if (sent > 0) {
+            outOffset += sent;
+            progressed = true;
+            continue;
+        }
+        if (sent < 0 && errno == EINTR) continue;
+        if (sent < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) break; // EPOLLOUT abwarten
+        peerClosed = true;
+        break;
+    }
+    if (outOffset == outBuffer.size()) {
+        outBuffer.clear();
+        outOffset = 0;
+    }
+    return progressed;
+}
+
+void EpollTransport::handleEvents(quint32 mask)
+{
+    // Callbacks koennen detach()/abort() ausloesen: danach nichts mehr melden
+    if ((mask & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR)) && events.readable) {
+        events.readable();
+    }
+    if (!loop) return;
+
+    if ((mask & EPOLLOUT) && bytesToWrite() > 0) {
+        if (drain() && events.writable) {
+            events.writable();
+        }
+        if (!loop) return;
+    }
+
+    if (closeWhenDrained && bytesToWrite() == 0) {
+        shutdown();
+    } else if (peerClosed || (mask & (EPOLLRDHUP | EPOLLHUP | EPOLLERR))) {
+        shutdown();
+    }
+}
+
+void EpollTransport::shutdown()
+{
+    if (fd < 0) return;
+
+    const std::function<void()> closed = events.closed;
+    detach();
+    ::close(fd);
+    fd = -1;
+    peerClosed = true;
+    if (closed) {
+        closed();
+    }
+}
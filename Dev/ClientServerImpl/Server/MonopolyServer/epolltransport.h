@@ -0,0 +1,111 @@
+#ifndef EPOLLTRANSPORT_H
+#define EPOLLTRANSPORT_H
+
+#include <QByteArray>
+#include <QObject>
+#include <QSocketNotifier>
+#include <QVector>
+#include <functional>
+
+#include "transport.h"
+
+struct epoll_event;
+class EpollTransport;
+
+// Natives Linux-Backend: ein epoll-Set pro Shard-Thread, eingehaengt in
+// dessen Qt-Event-Loop ueber einen einzigen QSocketNotifier auf dem
+// epoll-fd. Sockets sind edge-triggered registriert, pro Wecken wird ein
+// ganzer Schwung Ereignisse abgearbeitet - kein QObject und kein Signal
+// pro Verbindung.
+class EpollLoop : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit EpollLoop(QObject *parent = nullptr);
+    ~EpollLoop() override;
+
+    // Loop des aktuellen Threads (nullptr, wenn dort keiner laeuft)
+    static EpollLoop *current();
+
+    bool isValid() const;
+
+    // Listener mit SO_REUSEPORT: jeder Shard hat einen eigenen auf demselben
+    // Port, der Kernel verteilt neue Verbindungen. accept4() im Schwung bis EAGAIN.
+    bool listen(quint16 port, std::function<void(int fd)> onAccept);
+    // uebernimmt einen schon lauschenden Socket (Hot-Restart)
+    bool adoptListener(int fd, std::function<void(int fd)> onAccept);
+    QVector<int> listeners() const;
+
+    // Listener aus dem epoll-Set nehmen bzw. wieder aufnehmen; Verbindungen
+    // warten solange in der Accept-Queue des Kernels
+    void pauseListening();
+    void resumeListening();
+
+    bool add(EpollTransport *transport);
+    void remove(EpollTransport *transport);
+
+private:
+    static constexpr int maxEvents = 256;
+
+    int epollFd = -1;
+    QVector<int> listenFds;
+    bool listenPaused = false;
+    QSocketNotifier *notifier = nullptr;
+    std::function<void(int)> acceptHandler;
+
+    // aktueller Schwung; remove() loescht noch offene Eintraege darin
+    epoll_event *events;
+    int eventCount = 0;
+    int eventIndex = 0;
+
+    bool watchListener(int fd, std::function<void(int)> onAccept);
+    void process();
+    void acceptAll();
+};
+
+class EpollTransport : public Transport
+{
+public:
+    // uebernimmt den (nicht blockierenden) Socket-Deskriptor
+    explicit EpollTransport(int fd);
+    ~EpollTransport() override;
+
+    int descriptor() const;
+
+    void attach(const Events &events) override;
+    void detach() override;
+    void moveToThread(QThread *thread) override;
+
+    bool isConnected() const override;
+    QString peerInfo() const override;
+    qint64 readInto(Protocol::FrameReader &reader) override;
+    bool hasBytesAvailable() const override;
+
+    void write(const QByteArray &data) override;
+    void flush() override;
+    qint64 bytesToWrite() const override;
+
+    void close() override;
+    void abort() override;
+    int releaseDescriptor() override;
+
+private:
+    friend class EpollLoop;
+
+    int fd;
+    EpollLoop *loop = nullptr;
+    Events events;
+    bool peerClosed = false;
+    bool closeWhenDrained = false;
+
+    // nicht sofort gesendete Bytes, ab outOffset
+    QByteArray outBuffer;
+    qsizetype outOffset = 0;
+
+    void handleEvents(quint32 mask);
+    bool drain();
+    void shutdown();
+};
+
+#endif // EPOLLTRANSPORT_H
@@ -1,26 +0,0 @@
-#ifndef GAME_H
-#define GAME_H
-
-#include <QVector>
-#include "player.h"
-
-class Game
-{
-public:
-    void addPlayer(Player* player);
-    void removePlayer(Player* player);
-
-    Player* getCurrentPlayer();
-    void nextTurn();
-    void resetTurnOrder();
-
-    int boardSize() const;
-
-private:
-    QVector<Player*> players;
-    int currentPlayerIndex = 0;
-
-    void normalizeCurrentPlayer();
-};
-
-#endif // GAME_H
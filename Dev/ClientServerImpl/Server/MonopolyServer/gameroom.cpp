@@ -0,0 +1,1475 @@
+#include "gameroom.h"
+#include "roomshard.h"
+#include "journal.h"
+
+#include <QJsonDocument>
+#include <QJsonArray>
+#include <QCryptographicHash>
+#include <QDebug>
+#include <QSet>
+#include <algorithm>
+
+GameRoom::GameRoom(RoomShard &shard, int id, const QString &name)
+    : shard(shard)
+    , id(id)
+    , name(name)
+{
+    rules.random = RoomRandom(shard.roomSeed(id));
+    buildBoardCatalog();
+    // 64 Bit passen nicht verlustfrei in eine JSON-Zahl
+    record("open", {{"name", name}, {"seed", QString::number(rules.random.seed(), 16)}});
+}
+
+GameRoom::~GameRoom() = default;
+
+int GameRoom::getId() const
+{
+    return id;
+}
+
+QString GameRoom::getName() const
+{
+    return name;
+}
+
+int GameRoom::playerCount() const
+{
+    return int(players.size());
+}
+
+bool GameRoom::isStarted() const
+{
+    return rules.started;
+}
+
+bool GameRoom::isFinished() const
+{
+    return rules.finished;
+}
+
+bool GameRoom::isFull() const
+{
+    return playerCount() >= maxPlayers;
+}
+
+bool GameRoom::isEmpty() const
+{
+    return players.empty();
+}
+
+Player* GameRoom::addPlayer(std::unique_ptr<Player> player)
+{
+    player->id = nextPlayerId++;
+    if (player->name.isEmpty()) {
+        player->name = QString("Player%1").arg(player->id);
+    }
+
+    player->stateSynced = false;
+    players.push_back(std::move(player));
+    Player *added = players.back().get();
+    Engine::PlayerState state;
+    state.id = added->id;
+    rules.players.append(state);
+    record("join", {{"p", added->id}, {"name", added->name}, {"session", added->sessionToken}});
+
+    QJsonObject joined;
+    joined["type"] = "roomJoined";
+    joined["roomId"] = id;
+    joined["roomName"] = name;
+    sendToPlayer(*added, joined);
+
+    // Assign ID
+    QJsonObject msg;
+    msg["type"] = "assignPlayerId";
+    msg["playerId"] = added->id;
+    msg["name"] = added->name;
+    sendToPlayer(*added, msg);
+
+    sendCatalogIfNeeded(*added);
+
+    qDebug() << "[ROOM" << id << "] Spieler beigetreten:" << added->name
+             << "| players=" << players.size();
+
+    // State an alle im Raum
+    broadcastGameState("playerJoined");
+    return added;
+}
+
+void GameRoom::suspendPlayer(Player &player)
+{
+    player.connection = nullptr;
+    player.suspended = true;
+    player.suspendedTimer.start();
+    player.requestId = QJsonValue(QJsonValue::Undefined);
+
+    qDebug() << "[ROOM" << id << "] Verbindung verloren, Platz bleibt:" << player.name;
+    broadcastLog(player.id, "hat die Verbindung verloren, wartet auf Wiederverbindung");
+}
+
+void GameRoom::resumePlayer(Player &player, ClientConnection *connection, bool replayed)
+{
+    player.connection = connection;
+    player.suspended = false;
+
+    // Bezug fuer die Oberflaeche wie beim Beitritt
+    QJsonObject joined;
+    joined["type"] = "roomJoined";
+    joined["roomId"] = id;
+    joined["roomName"] = name;
+    sendToPlayer(player, joined);
+
+    QJsonObject msg;
+    msg["type"] = "assignPlayerId";
+    msg["playerId"] = player.id;
+    msg["name"] = player.name;
+    sendToPlayer(player, msg);
+
+    // Luecke nicht aus dem Puffer zu fuellen: Neuaufbau per Vollzustand
+    if (!replayed) {
+        player.stateSynced = false;
+        sendCatalogIfNeeded(player);
+        if (player.deltaUpdates) {
+            sendStateSnapshot(player);
+        } else {
+            const QJsonObject state = buildGameState("resume");
+            sendToPlayer(player, player.catalogAware ? state : withCatalog(state));
+        }
+    }
+
+    qDebug() << "[ROOM" << id << "] Spieler wieder verbunden:" << player.name
+             << "| replayed=" << replayed;
+    broadcastLog(player.id, "ist wieder verbunden");
+}
+
+std::unique_ptr<Player> GameRoom::removePlayer(Player *player, const QString &reason)
+{
+    auto it = std::find_if(players.begin(), players.end(),
+                           [&](const std::unique_ptr<Player>& p){
+                               return p.get() == player;
+                           });
+    if (it == players.end()) {
+        return nullptr;
+    }
+
+    qDebug() << "[ROOM" << id << "] Spieler verlaesst Raum:" << (*it)->name;
+
+    // Besitz, offene Entscheidungen, Zugreihenfolge und Sieger: Engine
+    std::unique_ptr<Player> removed = std::move(*it);
+    const Engine::PlayerState *current = Engine::currentPlayer(rules);
+    const bool wasCurrentPlayer = current && current->id == removed->id;
+
+    QVector<Engine::Event> events;
+    Engine::step(rules, {Engine::Action::Leave, removed->id}, &events);
+    players.erase(it);
+    record("leave", {{"p", removed->id}});
+    for (const Engine::Event &event : events) {
+        applyEngineEvent(event);
+        if (event.type == Engine::Event::Finished) {
+            broadcastGameState(reason);
+        }
+    }
+    if (!rules.finished && wasCurrentPlayer && rules.started && Engine::currentPlayer(rules)) {
+        broadcastLog(0, "Aktiver Spieler getrennt, Zug geht an den naechsten Spieler");
+    }
+    broadcastGameState(reason);
+
+    return removed;
+}
+
+const MessageTable<GameRoom> &GameRoom::messageTable()
+{
+    static const MessageTable<GameRoom> table = [] {
+        using J = QJsonValue;
+        MessageTable<GameRoom> t;
+        t.add(Protocol::StartGame, [](GameRoom &r, Player &p, const QJsonObject &) {
+            r.handleStartGame(p);
+        });
+        t.add(Protocol::RollDice, [](GameRoom &r, Player &p, const QJsonObject &) {
+            r.handleRollDice(p);
+        });
+        t.add(Protocol::EndTurn, [](GameRoom &r, Player &p, const QJsonObject &) {
+            r.handleEndTurn(p);
+        });
+        t.add(Protocol::Surrender, [](GameRoom &r, Player &p, const QJsonObject &) {
+            r.handleSurrender(p);
+        });
+        t.add(Protocol::SetReady, [](GameRoom &r, Player &p, const QJsonObject &m) {
+            r.handleSetReady(p, m.value("ready").toBool(true));
+        }, {{"ready", J::Bool, false}});
+        t.add(Protocol::SetName, [](GameRoom &r, Player &p, const QJsonObject &m) {
+            r.handleSetName(p, m.value("name").toString().trimmed());
+        }, {{"name", J::String}});
+        t.add(Protocol::RestartGame, [](GameRoom &r, Player &p, const QJsonObject &) {
+            r.handleRestartGame(p);
+        });
+        t.add(Protocol::BuyHouse, [](GameRoom &r, Player &p, const QJsonObject &m) {
+            r.handleBuyHouse(p, m.value("fieldIndex").toInt(-1));
+        }, {{"fieldIndex", J::Double}});
+        t.add(Protocol::BuyDecision, [](GameRoom &r, Player &p, const QJsonObject &m) {
+            r.handleBuyDecision(p, m.value("playerId").toInt(),
+                                m.value("fieldIndex").toInt(),
+                                m.value("buy").toBool(false));
+        }, {{"playerId", J::Double}, {"fieldIndex", J::Double}, {"buy", J::Bool, false}});
+        t.add(Protocol::AutoTurn, [](GameRoom &r, Player &p, const QJsonObject &m) {
+            r.handleAutoTurn(p, buyPolicyFromMessage(m), m.value("endTurn").toBool(true));
+        }, {{"buyPolicy", J::String, false}, {"minMoneyAfter", J::Double, false}, {"endTurn", J::Bool, false}});
+        t.add(Protocol::GetState, [](GameRoom &r, Player &p, const QJsonObject &m) {
+            r.handleGetState(p, m);
+        }, {{"delta", J::Bool, false}, {"catalog", J::Bool, false}, {"catalogHash", J::String, false}});
+        return t;
+    }();
+    return table;
+}
+
+void GameRoom::handleBuyDecision(Player &player, int playerId, int fieldIndex, bool buy)
+{
+    qDebug() << "[BUY] decision from pid=" << playerId
+             << "field=" << fieldIndex
+             << "buy=" << buy;
+
+    Engine::Action action{Engine::Action::BuyDecision, playerId, fieldIndex, buy};
+    QVector<Engine::Event> events;
+    if (!runEngine(player, action, &events)) {
+        qWarning() << "[BUY] Ignored (not pending / mismatch). pending pid="
+                   << rules.buyPlayerId << "field=" << rules.buyField;
+        return;
+    }
+    applyEngineEvents(events);
+
+    broadcastGameState("buyResolved");
+    broadcastGameState("awaitingEndTurn");
+}
+
+void GameRoom::handleGetState(Player &player, const QJsonObject &msg)
+{
+    // "delta": Client kann stateDelta anwenden und fordert hiermit
+    // auch den Resync an, wenn er eine Luecke in den Versionen sieht
+    // "catalog": Client cached den boardCatalog unter catalogHash
+    const bool delta = player.deltaUpdates || msg.value("delta").toBool(false);
+    const bool catalog = player.catalogAware || msg.value("catalog").toBool(false);
+    const QString hash = msg.contains("catalogHash")
+            ? msg.value("catalogHash").toString() : player.catalogHash;
+    enableStateCaps(player, delta, catalog, hash);
+    if (player.deltaUpdates) {
+        sendStateSnapshot(player);
+        return;
+    }
+    const QJsonObject state = buildGameState("getState");
+    sendToPlayer(player, player.catalogAware ? state : withCatalog(state));
+}
+
+void GameRoom::handleStartGame(Player &player)
+{
+    QVector<Engine::Event> events;
+    if (!runEngine(player, {Engine::Action::Start, player.id}, &events)) {
+        return;
+    }
+    applyEngineEvents(events);
+    broadcastGameState("gameStarted");
+}
+
+void GameRoom::handleSetReady(Player &player, bool ready)
+{
+    Engine::Action action{Engine::Action::SetReady, player.id};
+    action.ready = ready;
+    QVector<Engine::Event> events;
+    if (!runEngine(player, action, &events)) {
+        return;
+    }
+    applyEngineEvents(events);
+    broadcastGameState("playerReady");
+
+    if (!rules.started && areAllPlayersReady()) {
+        handleStartGame(player);
+    }
+}
+
+void GameRoom::handleSetName(Player &player, const QString &name)
+{
+    if (name.isEmpty()) {
+        return;
+    }
+    player.name = name.left(20);
+    record("name", {{"p", player.id}, {"name", player.name}});
+    broadcastLog(player.id, QString("heisst jetzt %1").arg(player.name));
+    broadcastGameState("playerName");
+}
+
+void GameRoom::handleRestartGame(Player &player)
+{
+    QVector<Engine::Event> events;
+    if (!runEngine(player, {Engine::Action::Restart, player.id}, &events)) {
+        return;
+    }
+    applyEngineEvents(events);
+    broadcastGameState("gameRestarted");
+}
+
+void GameRoom::handleBuyHouse(Player &player, int fieldIndex)
+{
+    // gebaut wird auf der Strasse unter dem Spieler, fieldIndex nur zur Info
+    (void)fieldIndex;
+    QVector<Engine::Event> events;
+    if (!runEngine(player, {Engine::Action::BuyHouse, player.id}, &events)) {
+        return;
+    }
+    applyEngineEvents(events);
+    broadcastGameState("houseBought");
+}
+
+void GameRoom::handleRollDice(Player &player)
+{
+    QVector<Engine::Event> events;
+    if (!runEngine(player, {Engine::Action::Roll, player.id}, &events)) {
+        return;
+    }
+
+    // turnResult-Clients bekommen den ganzen Zug als eine Nachricht
+    beginTurnBatch(player);
+    resolveRoll(events);
+    endTurnBatch();
+}
+
+void GameRoom::handleAutoTurn(Player &player, const Engine::BuyPolicy &policy, bool endTurn)
+{
+    QVector<Engine::Event> events;
+    if (!runEngine(player, {Engine::Action::Roll, player.id}, &events)) {
+        return;
+    }
+
+    // Wuerfeln, Kaufentscheidung nach Policy, Zugende - ein Roundtrip
+    beginTurnBatch(player);
+    autoTurnActive = true;
+    resolveRoll(events);
+    autoTurnActive = false;
+
+    if (rules.buyPlayerId == player.id) {
+        const Engine::PlayerState *state = playerState(player.id);
+        const int field = rules.buyField;
+        const bool buy = state && policy.wantsToBuy(state->money, Engine::board().at(field).price);
+        handleBuyDecision(player, player.id, field, buy);
+    }
+
+    if (endTurn && !rules.finished && rules.endTurnPlayerId == player.id) {
+        handleEndTurn(player);
+    }
+    endTurnBatch();
+}
+
+Engine::BuyPolicy GameRoom::buyPolicyFromMessage(const QJsonObject &msg)
+{
+    Engine::BuyPolicy policy;
+    const QString mode = msg.value("buyPolicy").toString("never");
+    if (mode == "always") {
+        policy.mode = Engine::BuyPolicy::Always;
+    } else if (mode == "reserve") {
+        policy.mode = Engine::BuyPolicy::KeepReserve;
+        policy.minMoneyAfter = msg.value("minMoneyAfter").toInt(0);
+    }
+    return policy;
+}
+
+void GameRoom::resolveRoll(const QVector<Engine::Event> &events)
+{
+    // Zwischenstaende wie gehabt: Feldergebnis, dann Warten auf endTurn
+    QString resolved = "turnResolved";
+    for (const Engine::Event &event : events) {
+        if (event.type == Engine::Event::AwaitEnd) {
+            broadcastGameState(resolved);
+        }
+        applyEngineEvent(event);
+
+        switch (event.type) {
+        case Engine::Event::JailWait:
+            resolved = "jailWait";
+            break;
+        case Engine::Event::GoToJail:
+            resolved = "goToJail";
+            break;
+        case Engine::Event::Offer:
+            broadcastGameState("buyRequested"); // Zug erst nach buyDecision beenden
+            break;
+        case Engine::Event::Finished:
+            broadcastGameState("playerBankrupt");
+            break;
+        case Engine::Event::AwaitEnd:
+            broadcastGameState("awaitingEndTurn");
+            break;
+        default:
+            break;
+        }
+    }
+}
+
+void GameRoom::handleEndTurn(Player &player)
+{
+    // offenes Kaufangebot des Spielers gilt als abgelehnt
+    QVector<Engine::Event> events;
+    if (!runEngine(player, {Engine::Action::EndTurn, player.id}, &events)) {
+        return;
+    }
+    applyEngineEvents(events);
+    broadcastGameState("nextTurn");
+}
+
+void GameRoom::handleSurrender(Player &player)
+{
+    QVector<Engine::Event> events;
+    if (!runEngine(player, {Engine::Action::Surrender, player.id}, &events)) {
+        return;
+    }
+
+    bool nextTurn = false;
+    for (const Engine::Event &event : events) {
+        applyEngineEvent(event);
+        if (event.type == Engine::Event::Finished) {
+            broadcastGameState("playerSurrendered");
+        }
+        nextTurn = nextTurn || event.type == Engine::Event::Turn;
+    }
+    broadcastGameState(nextTurn ? "nextTurn" : "playerSurrendered");
+}
+
+bool GameRoom::runEngine(Player &player, const Engine::Action &action, QVector<Engine::Event> *events)
+{
+    // bei Fehler bleibt rules unveraendert
+    const Engine::Error error = Engine::step(rules, action, events);
+    if (error == Engine::Error::None) {
+        return true;
+    }
+
+    const QString message = Engine::errorText(action.type, error);
+    qDebug() << "[ENGINE] action" << int(action.type) << "from" << player.id
+             << "rejected:" << int(error) << message;
+    if (!message.isEmpty()) {
+        QJsonObject err;
+        // startGame im laufenden Spiel ist nur ein Hinweis
+        err["type"] = error == Engine::Error::AlreadyStarted ? "info" : "error";
+        err["message"] = message;
+        sendToPlayer(player, err);
+    }
+    return false;
+}
+
+Engine::PlayerState *GameRoom::playerState(int playerId)
+{
+    for (Engine::PlayerState &state : rules.players) {
+        if (state.id == playerId) return &state;
+    }
+    return nullptr;
+}
+
+const Engine::PlayerState *GameRoom::playerState(int playerId) const
+{
+    for (const Engine::PlayerState &state : rules.players) {
+        if (state.id == playerId) return &state;
+    }
+    return nullptr;
+}
+
+void GameRoom::applyEngineEvents(const QVector<Engine::Event> &events)
+{
+    for (const Engine::Event &event : events) {
+        applyEngineEvent(event);
+    }
+}
+
+void GameRoom::applyEngineEvent(const Engine::Event &event)
+{
+    using E = Engine::Event;
+    const int pid = event.playerId;
+    const QString fieldName = event.field >= 0 && event.field < Engine::boardSize
+            ? Engine::board().at(event.field).name : QString();
+
+    switch (event.type) {
+    case E::Started:
+        record("start");
+        qDebug() << "[GAME] STARTED by" << pid
+                 << "| currentPlayerId=" << (Engine::currentPlayer(rules) ? Engine::currentPlayer(rules)->id : -1);
+        broadcastLog(pid, "startet das Spiel");
+        break;
+
+    case E::Restarted:
+        record("restart");
+        for (const auto &p : players) {
+            if (p) {
+                sendCatalogIfNeeded(*p);
+            }
+        }
+        broadcastLog(pid, "startet einen Neustart");
+        break;
+
+    case E::JailWait:
+        record("jail", {{"p", pid}, {"inJail", event.inJail},
+                        {"turns", event.jailTurns}, {"pos", event.position}});
+        qDebug() << "[JAIL] Player" << pid << "waits. remaining=" << event.jailTurns;
+        turnBatch.outcome["jailWait"] = true;
+        turnBatch.outcome["jailTurns"] = event.jailTurns;
+        break;
+
+    case E::Dice: {
+        const int steps = event.d1 + event.d2;
+        record("dice", {{"p", pid}, {"d1", event.d1}, {"d2", event.d2},
+                        {"pos", event.position}, {"money", event.money},
+                        {"rng", qint64(event.randomDraws)}});
+
+        const QString landed = Engine::board().at(event.position).name;
+        for (int i = 1; i <= steps; ++i) {
+            turnBatch.path.append((event.from + i) % Engine::boardSize);
+        }
+        turnBatch.outcome["fieldIndex"] = event.position;
+        turnBatch.outcome["fieldName"] = landed;
+
+        qDebug() << "[TURN] Player" << pid
+                 << "rolled" << event.d1 << "+" << event.d2 << "=" << steps
+                 << "| pos" << event.from << "->" << event.position
+                 << "| money" << event.money
+                 << "| field=" << landed;
+
+        // Wuerfel-Event an alle
+        QJsonObject roll;
+        roll["type"] = "diceRolled";
+        roll["playerId"] = pid;
+        roll["d1"] = event.d1;
+        roll["d2"] = event.d2;
+        roll["steps"] = steps;
+        roll["newPosition"] = event.position;
+        roll["fieldName"] = landed;
+        broadcast(roll);
+        break;
+    }
+
+    case E::Rent: {
+        record("rent", {{"p", pid}, {"field", event.field}, {"to", event.otherId},
+                        {"amount", event.amount},
+                        {"money", event.money}, {"toMoney", event.otherMoney}});
+        const Player *owner = findPlayerById(event.otherId);
+        broadcastLog(pid, QString("zahlt %1$ Miete an %2 fuer %3")
+                             .arg(event.amount)
+                             .arg(owner ? owner->name : QString())
+                             .arg(fieldName));
+        break;
+    }
+
+    case E::Tax:
+        record("tax", {{"p", pid}, {"field", event.field}, {"amount", event.amount},
+                       {"money", event.money}});
+        broadcastLog(pid, QString("muss %2$ %1 zahlen").arg(fieldName).arg(event.amount));
+        break;
+
+    case E::Card: {
+        const QString text = QString("[Unterrichtskarte] %1").arg(Engine::cards().at(event.card).text);
+        record("card", {{"p", pid}, {"field", event.field}, {"amount", event.amount},
+                        {"text", text}, {"money", event.money},
+                        {"rng", qint64(event.randomDraws)}});
+        broadcastLog(pid, text);
+        break;
+    }
+
+    case E::Land:
+        record("land", {{"p", pid}, {"field", event.field}, {"money", event.money}});
+        if (event.amount > 0) {
+            broadcastLog(pid, QString("erhaelt %1$ auf %2").arg(event.amount).arg(fieldName));
+        }
+        break;
+
+    case E::GoToJail:
+        record("jail", {{"p", pid}, {"inJail", event.inJail},
+                        {"turns", event.jailTurns}, {"pos", event.position}});
+        broadcastLog(pid, "geht in die Berufsschule! (Gefaengnis, 3 Zuege)");
+        turnBatch.outcome["goToJail"] = true;
+        break;
+
+    case E::Bankrupt:
+        broadcastLog(pid, "ist pleite!");
+        turnBatch.outcome["bankrupt"] = true;
+        record("bankrupt", {{"p", pid}});
+        break;
+
+    case E::Finished:
+        record("finish", {{"winner", pid}});
+        broadcastLog(pid, "gewinnt das Spiel");
+        break;
+
+    case E::Offer: {
+        qDebug() << "[BUY?] Offer to player" << pid
+                 << "field=" << event.field << fieldName
+                 << "price=" << event.amount;
+        record("offer", {{"p", pid}, {"field", event.field}});
+        turnBatch.outcome["buyOffered"] = true;
+
+        // autoTurn entscheidet selbst, keine Nachfrage beim Client
+        Player *p = findPlayerById(pid);
+        if (p && !autoTurnActive) {
+            QJsonObject req;
+            req["type"] = "buyRequest";
+            req["playerId"] = pid;
+            req["fieldIndex"] = event.field;
+            req["fieldName"] = fieldName;
+            req["price"] = event.amount;
+            sendToPlayer(*p, req);
+        }
+        break;
+    }
+
+    case E::Bought:
+        qDebug() << "[BUY] Player" << pid << "buys" << fieldName
+                 << "for" << event.amount << "(money after=" << event.money << ")";
+        record("buy", {{"p", pid}, {"field", event.field}, {"money", event.money}});
+        broadcastLog(pid, QString("kauft %1 fuer %2$").arg(fieldName).arg(event.amount));
+        break;
+
+    case E::Declined:
+        qDebug() << "[BUY] Player" << pid << "declined" << fieldName;
+        record("decline", {{"p", pid}, {"field", event.field}});
+        broadcastLog(pid, QString("lehnt den Kauf von %1 ab").arg(fieldName));
+        break;
+
+    case E::House:
+        record("house", {{"p", pid}, {"field", event.field}, {"money", event.money}});
+        broadcastLog(pid, QString("kauft ein Haus auf %1 fuer %2$")
+                             .arg(fieldName)
+                             .arg(event.amount));
+        break;
+
+    case E::AwaitEnd:
+        record("awaitEnd", {{"p", pid}});
+        break;
+
+    case E::EndTurn:
+        broadcastLog(pid, "beendet den Zug");
+        break;
+
+    case E::Turn:
+        record("turn", {{"p", pid}});
+        qDebug() << "[TURN] nextTurn -> currentPlayerId=" << pid;
+        break;
+
+    case E::Surrendered:
+        record("surrender", {{"p", pid}});
+        broadcastLog(pid, "gibt auf");
+        break;
+
+    case E::Left:
+        break; // Spielerliste pflegt removePlayer selbst
+
+    case E::Ready:
+        record("ready", {{"p", pid}, {"ready", event.ready}});
+        broadcastLog(pid, event.ready ? "ist bereit" : "ist nicht mehr bereit");
+        break;
+    }
+}
+
+void GameRoom::sendToPlayer(Player &player, const QJsonObject &obj)
+{
+    if (isBatched(player)) {
+        // gezielte Nachrichten (z.B. buyRequest) erst nach dem turnResult
+        turnBatch.direct.append({player.id, obj});
+        return;
+    }
+    shard.sendToPlayer(player, obj);
+}
+
+void GameRoom::broadcast(const QJsonObject &obj)
+{
+    if (players.empty()) return;
+
+    if (turnBatch.active) {
+        collectForBatch(obj);
+    }
+
+    // je Format einmal kodieren, gleicher Puffer fuer alle Spieler im Raum
+    OutgoingMessage msg(obj);
+    qDebug() << "[NET] => room" << id << "x" << players.size() << obj.value("type").toString();
+
+    for (auto &p : players) {
+        if (p && p->isReachable() && !isBatched(*p)) {
+            shard.sendMessage(*p, msg);
+        }
+    }
+}
+
+void GameRoom::broadcastLog(int playerId, const QString &message)
+{
+    QJsonObject log;
+    log["type"] = "log";
+    log["playerId"] = playerId;
+    log["message"] = message;
+    broadcast(log);
+}
+
+QJsonObject GameRoom::buildGameState(const QString &reason) const
+{
+    QJsonObject state;
+    state["type"] = "state";
+    state["reason"] = reason;
+    state["catalogHash"] = catalogHash;
+    state["gameStarted"] = rules.started;
+    state["gameFinished"] = rules.finished;
+    state["winnerId"] = rules.winnerId;
+
+    const Engine::PlayerState *cur = Engine::currentPlayer(rules);
+    state["currentPlayerId"] = (rules.started && cur) ? cur->id : -1;
+
+    QJsonArray parr;
+    for (const auto &p : players) {
+        const Engine::PlayerState *ps = p ? playerState(p->id) : nullptr;
+        if (!ps) {
+            continue;
+        }
+        QJsonObject po;
+        po["id"] = p->id;
+        po["name"] = p->name;
+        po["position"] = ps->position;
+        po["money"] = ps->money;
+        po["inJail"] = ps->inJail;
+        po["jailTurns"] = ps->jailTurns;
+        po["bankrupt"] = ps->bankrupt;
+        po["ready"] = ps->ready;
+        parr.append(po);
+    }
+    state["players"] = parr;
+
+    // nur dynamische Feldwerte, der Rest steht im boardCatalog
+    QJsonArray farr;
+    const QVector<Engine::FieldSpec> &specs = Engine::board();
+    for (int i = 0; i < specs.size(); ++i) {
+        QJsonObject fo;
+        fo["index"] = i;
+        if (specs.at(i).isProperty()) {
+            fo["ownerId"] = rules.owner[i];
+            if (specs.at(i).kind == Engine::FieldKind::Street) {
+                fo["hasHotel"] = rules.hotel[i];
+            }
+        }
+        farr.append(fo);
+    }
+    state["fields"] = farr;
+
+    state["awaitingBuyDecision"] = rules.buyPlayerId >= 0;
+    state["pendingBuyPlayerId"] = rules.buyPlayerId;
+    state["pendingBuyFieldIndex"] = rules.buyField;
+    state["awaitingEndTurn"] = rules.endTurnPlayerId >= 0;
+    state["pendingEndTurnPlayerId"] = rules.endTurnPlayerId;
+
+    return state;
+}
+
+bool GameRoom::areAllPlayersReady() const
+{
+    if (rules.players.isEmpty()) {
+        return false;
+    }
+    for (const Engine::PlayerState &p : rules.players) {
+        if (!p.ready) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void GameRoom::broadcastGameState(const QString &reason)
+{
+    if (players.empty()) return;
+
+    QJsonObject full = buildGameState(reason);
+    QJsonObject delta = buildStateDelta(lastState, full);
+
+    // Version nur erhoehen, wenn sich wirklich etwas geaendert hat
+    // (z.B. buyResolved direkt gefolgt von awaitingEndTurn)
+    if (!delta.isEmpty()) {
+        ++stateVersion;
+        delta["type"] = "stateDelta";
+        delta["reason"] = reason;
+        delta["version"] = stateVersion;
+        delta["baseVersion"] = stateVersion - 1;
+    }
+    full["stateVersion"] = stateVersion;
+    rememberState(full);
+
+    // Delta-Clients bekommen das Delta, alle anderen (und wer noch keinen
+    // Snapshot dieses Raums hat) den vollen Zustand; Clients ohne Katalog
+    // zusaetzlich mit den statischen Felddaten - jede Variante je Format einmal kodiert
+    OutgoingMessage deltaMsg(delta);
+    OutgoingMessage dynamicMsg(full);
+    OutgoingMessage catalogMsg;
+    if (turnBatch.active) {
+        turnBatch.reason = reason;
+    }
+    for (auto &p : players) {
+        if (!p || !p->isReachable() || isBatched(*p)) {
+            continue;
+        }
+        if (p->deltaUpdates && p->stateSynced) {
+            if (deltaMsg.isEmpty()) {
+                continue;
+            }
+            shard.sendMessage(*p, deltaMsg);
+        } else if (p->catalogAware) {
+            // vor dem Senden: bei Ueberlast setzt der Shard das wieder zurueck
+            p->stateSynced = true;
+            shard.sendMessage(*p, dynamicMsg);
+        } else {
+            if (catalogMsg.isEmpty()) {
+                catalogMsg = OutgoingMessage(withCatalog(full));
+            }
+            p->stateSynced = true;
+            shard.sendMessage(*p, catalogMsg);
+        }
+    }
+}
+
+bool GameRoom::isBatched(const Player &player) const
+{
+    return turnBatch.active && player.turnResults;
+}
+
+void GameRoom::beginTurnBatch(Player &player)
+{
+    turnBatch = TurnBatch();
+    turnBatch.active = true;
+    turnBatch.playerId = player.id;
+    const Engine::PlayerState *state = playerState(player.id);
+    turnBatch.startMoney = state ? state->money : 0;
+    turnBatch.baseVersion = stateVersion;
+    turnBatch.base = lastState;
+}
+
+void GameRoom::collectForBatch(const QJsonObject &obj)
+{
+    const QString type = obj.value("type").toString();
+    if (type == "diceRolled") {
+        turnBatch.dice = obj;
+        turnBatch.dice.remove("type");
+    } else if (type == "log") {
+        QJsonObject event;
+        event["playerId"] = obj.value("playerId");
+        event["message"] = obj.value("message");
+        turnBatch.events.append(event);
+    } else {
+        turnBatch.after.append(obj);
+    }
+}
+
+void GameRoom::endTurnBatch()
+{
+    TurnBatch batch = std::move(turnBatch);
+    turnBatch = TurnBatch();
+
+    if (const Engine::PlayerState *current = playerState(batch.playerId)) {
+        batch.outcome["moneyDelta"] = current->money - batch.startMoney;
+    }
+
+    QJsonObject env;
+    env["type"] = "turnResult";
+    env["playerId"] = batch.playerId;
+    env["reason"] = batch.reason;
+    if (!batch.dice.isEmpty()) {
+        env["dice"] = batch.dice;
+        env["path"] = batch.path;
+    }
+    env["outcome"] = batch.outcome;
+    env["events"] = batch.events;
+
+    // wie broadcastGameState: Delta ueber den ganzen Zug fuer synchrone
+    // Delta-Clients, sonst voller Zustand - jede Variante einmal kodiert
+    const bool changed = stateVersion != batch.baseVersion;
+    OutgoingMessage plainMsg(env);
+    OutgoingMessage deltaMsg;
+    OutgoingMessage dynamicMsg;
+    OutgoingMessage catalogMsg;
+    for (auto &p : players) {
+        if (!p || !p->isReachable() || !p->turnResults) {
+            continue;
+        }
+        if (p->deltaUpdates && p->stateSynced) {
+            if (!changed) {
+                shard.sendMessage(*p, plainMsg);
+                continue;
+            }
+            if (deltaMsg.isEmpty()) {
+                QJsonObject delta = buildStateDelta(batch.base, lastState.full);
+                delta["type"] = "stateDelta";
+                delta["reason"] = batch.reason;
+                delta["version"] = stateVersion;
+                delta["baseVersion"] = batch.baseVersion;
+                QJsonObject withDelta = env;
+                withDelta["delta"] = delta;
+                deltaMsg = OutgoingMessage(withDelta);
+            }
+            shard.sendMessage(*p, deltaMsg);
+        } else if (lastState.full.isEmpty()) {
+            shard.sendMessage(*p, plainMsg);
+        } else if (p->catalogAware) {
+            if (dynamicMsg.isEmpty()) {
+                QJsonObject withState = env;
+                withState["state"] = lastState.full;
+                dynamicMsg = OutgoingMessage(withState);
+            }
+            p->stateSynced = true;
+            shard.sendMessage(*p, dynamicMsg);
+        } else {
+            if (catalogMsg.isEmpty()) {
+                QJsonObject withState = env;
+                withState["state"] = withCatalog(lastState.full);
+                catalogMsg = OutgoingMessage(withState);
+            }
+            p->stateSynced = true;
+            shard.sendMessage(*p, catalogMsg);
+        }
+    }
+
+    for (const QJsonObject &obj : batch.after) {
+        OutgoingMessage msg(obj);
+        for (auto &p : players) {
+            if (p && p->isReachable() && p->turnResults) {
+                shard.sendMessage(*p, msg);
+            }
+        }
+    }
+    for (const auto &direct : batch.direct) {
+        if (Player *p = findPlayerById(direct.first)) {
+            shard.sendToPlayer(*p, direct.second);
+        }
+    }
+}
+
+QJsonObject GameRoom::withCatalog(QJsonObject state) const
+{
+    // alte Clients: statische Felddaten wieder in jedes Feld mischen
+    QJsonArray farr = state.value("fields").toArray();
+    for (int i = 0; i < farr.size() && i < catalogFields.size(); ++i) {
+        QJsonObject fo = catalogFields.at(i);
+        const QJsonObject dyn = farr.at(i).toObject();
+        for (auto it = dyn.begin(); it != dyn.end(); ++it) {
+            fo[it.key()] = it.value();
+        }
+        farr.replace(i, fo);
+    }
+    state["fields"] = farr;
+    return state;
+}
+
+void GameRoom::buildBoardCatalog()
+{
+    const QVector<Engine::FieldSpec> &specs = Engine::board();
+    catalogFields.clear();
+    catalogFields.reserve(specs.size());
+
+    QJsonArray farr;
+    for (int i = 0; i < specs.size(); ++i) {
+        const Engine::FieldSpec &spec = specs.at(i);
+        QJsonObject fo;
+        fo["index"] = i;
+        fo["name"] = spec.name;
+
+        if (spec.isProperty()) {
+            fo["type"] = "property";
+            fo["price"] = spec.price;
+            fo["baseRent"] = spec.rent;
+        }
+        switch (spec.kind) {
+        case Engine::FieldKind::Street:
+            fo["subtype"] = "street";
+            fo["color"] = spec.color;
+            fo["hotelPrice"] = spec.hotelPrice;
+            fo["hotelRent"] = spec.hotelRent;
+            break;
+        case Engine::FieldKind::Railroad:
+            fo["subtype"] = "railroad";
+            break;
+        case Engine::FieldKind::Utility:
+            fo["subtype"] = "utility";
+            break;
+        case Engine::FieldKind::GoToJail:
+            fo["type"] = "gotojail";
+            break;
+        case Engine::FieldKind::Card:
+            fo["type"] = "card";
+            break;
+        case Engine::FieldKind::Tax:
+            fo["type"] = "tax";
+            fo["price"] = spec.amount;
+            break;
+        case Engine::FieldKind::Start:
+            fo["type"] = "start";
+            break;
+        case Engine::FieldKind::Jail:
+            fo["type"] = "jail";
+            break;
+        }
+
+        catalogFields.append(fo);
+        farr.append(fo);
+    }
+
+    const QByteArray raw = QJsonDocument(farr).toJson(QJsonDocument::Compact);
+    catalogHash = QString::fromLatin1(
+        QCryptographicHash::hash(raw, QCryptographicHash::Sha1).toHex().left(16));
+}
+
+void GameRoom::enableStateCaps(Player &player, bool delta, bool catalog, const QString &hash)
+{
+    player.deltaUpdates = delta;
+    if (catalog) {
+        player.catalogAware = true;
+        player.catalogHash = hash;
+        sendCatalogIfNeeded(player);
+    }
+}
+
+void GameRoom::sendCatalogIfNeeded(Player &player)
+{
+    if (!player.catalogAware || player.catalogHash == catalogHash) {
+        return;
+    }
+
+    QJsonArray farr;
+    for (const QJsonObject &fo : catalogFields) {
+        farr.append(fo);
+    }
+
+    QJsonObject msg;
+    msg["type"] = "boardCatalog";
+    msg["hash"] = catalogHash;
+    msg["fields"] = farr;
+    sendToPlayer(player, msg);
+
+    player.catalogHash = catalogHash;
+    // Snapshot passt evtl. nicht mehr zum neuen Katalog
+    player.stateSynced = false;
+}
+
+QJsonObject GameRoom::buildStateDelta(const StateBase &base, const QJsonObject &full) const
+{
+    QJsonObject delta;
+    if (base.full.isEmpty()) {
+        // noch keine Basis: alles ist neu
+        delta = full;
+        delta.remove("type");
+        delta.remove("reason");
+        delta.remove("stateVersion");
+        return delta;
+    }
+
+    // Skalare Felder auf oberster Ebene
+    for (auto it = full.begin(); it != full.end(); ++it) {
+        const QString key = it.key();
+        if (key == "type" || key == "reason" || key == "stateVersion"
+            || key == "players" || key == "fields") {
+            continue;
+        }
+        if (base.full.value(key) != it.value()) {
+            delta[key] = it.value();
+        }
+    }
+
+    // Spieler: nur geaenderte Werte (+ id), neue Spieler komplett
+    QJsonArray changedPlayers;
+    QSet<int> seenPlayers;
+    const QJsonArray parr = full.value("players").toArray();
+    for (const QJsonValue &v : parr) {
+        const QJsonObject po = v.toObject();
+        const int pid = po.value("id").toInt();
+        seenPlayers.insert(pid);
+
+        auto old = base.players.constFind(pid);
+        if (old == base.players.constEnd()) {
+            changedPlayers.append(po);
+            continue;
+        }
+        QJsonObject patch;
+        for (auto it = po.begin(); it != po.end(); ++it) {
+            if (old->value(it.key()) != it.value()) {
+                patch[it.key()] = it.value();
+            }
+        }
+        if (!patch.isEmpty()) {
+            patch["id"] = pid;
+            changedPlayers.append(patch);
+        }
+    }
+    QJsonArray removedPlayers;
+    for (auto it = base.players.constBegin(); it != base.players.constEnd(); ++it) {
+        if (!seenPlayers.contains(it.key())) {
+            removedPlayers.append(it.key());
+        }
+    }
+
+    // Felder: nur geaenderte Werte (+ index)
+    QJsonArray changedFields;
+    const QJsonArray farr = full.value("fields").toArray();
+    for (int i = 0; i < farr.size(); ++i) {
+        const QJsonObject fo = farr.at(i).toObject();
+        if (i >= base.fields.size()) {
+            changedFields.append(fo);
+            continue;
+        }
+        const QJsonObject &old = base.fields.at(i);
+        QJsonObject patch;
+        for (auto it = fo.begin(); it != fo.end(); ++it) {
+            if (old.value(it.key()) != it.value()) {
+                patch[it.key()] = it.value();
+            }
+        }
+        if (!patch.isEmpty()) {
+            patch["index"] = i;
+            changedFields.append(patch);
+        }
+    }
+
+    if (!changedPlayers.isEmpty()) delta["players"] = changedPlayers;
+    if (!removedPlayers.isEmpty()) delta["removedPlayers"] = removedPlayers;
+    if (!changedFields.isEmpty()) delta["fields"] = changedFields;
+    return delta;
+}
+
+void GameRoom::rememberState(const QJsonObject &full)
+{
+    lastState.full = full;
+
+    lastState.players.clear();
+    const QJsonArray parr = full.value("players").toArray();
+    for (const QJsonValue &v : parr) {
+        const QJsonObject po = v.toObject();
+        lastState.players.insert(po.value("id").toInt(), po);
+    }
+
+    lastState.fields.clear();
+    const QJsonArray farr = full.value("fields").toArray();
+    lastState.fields.reserve(farr.size());
+    for (const QJsonValue &v : farr) {
+        lastState.fields.append(v.toObject());
+    }
+}
+
+void GameRoom::sendStateSnapshot(Player &player)
+{
+    // Snapshot = zuletzt verteilter Zustand, damit das naechste Delta
+    // exakt auf diese Version passt
+    if (lastState.full.isEmpty()) {
+        QJsonObject full = buildGameState("getState");
+        full["stateVersion"] = stateVersion;
+        rememberState(full);
+    }
+
+    QJsonObject snapshot = player.catalogAware ? lastState.full : withCatalog(lastState.full);
+    snapshot["reason"] = "getState";
+    player.stateSynced = true;
+    sendToPlayer(player, snapshot);
+}
+
+Player* GameRoom::findPlayerByConnection(ClientConnection *connection)
+{
+    auto it = std::find_if(players.begin(), players.end(),
+                           [&](const std::unique_ptr<Player>& p){
+                               return p && connection && p->connection == connection;
+                           });
+    if (it == players.end()) return nullptr;
+    return it->get();
+}
+
+Player* GameRoom::findPlayerBySession(const QString &token)
+{
+    auto it = std::find_if(players.begin(), players.end(),
+                           [&](const std::unique_ptr<Player>& p){
+                               return p && !token.isEmpty() && p->sessionToken == token;
+                           });
+    if (it == players.end()) return nullptr;
+    return it->get();
+}
+
+Player* GameRoom::findPlayerById(int id)
+{
+    auto it = std::find_if(players.begin(), players.end(),
+                           [&](const std::unique_ptr<Player>& p){
+                               return p && p->id == id;
+                           });
+    if (it == players.end()) return nullptr;
+    return it->get();
+}
+
+QVector<Player*> GameRoom::allPlayers() const
+{
+    QVector<Player*> result;
+    result.reserve(int(players.size()));
+    for (const auto &p : players) {
+        result.append(p.get());
+    }
+    return result;
+}
+
+void GameRoom::setSessionToken(Player &player, const QString &token)
+{
+    player.sessionToken = token;
+    record("session", {{"p", player.id}, {"session", token}});
+}
+
+void GameRoom::record(const QString &event, QJsonObject data)
+{
+    GameJournal *journal = shard.getJournal();
+    if (!journal) return;
+
+    // nur einreihen, geschrieben wird im Journal-Thread
+    data["e"] = event;
+    data["s"] = qint64(++journalSeq);
+    journal->append(id, data);
+
+    // Snapshot erst nach der laufenden Nachricht, dann ist der Raum konsistent
+    if (++journalPending >= journal->snapshotEvents() && !snapshotRequested) {
+        snapshotRequested = true;
+        shard.requestJournalSnapshot(id);
+    }
+}
+
+bool GameRoom::hasUnsavedJournal() const
+{
+    return journalPending > 0;
+}
+
+void GameRoom::writeJournalSnapshot()
+{
+    snapshotRequested = false;
+    GameJournal *journal = shard.getJournal();
+    if (!journal) return;
+
+    journal->writeSnapshot(id, captureState().toJson());
+    journalPending = 0;
+}
+
+quint64 GameRoom::randomSeed() const
+{
+    return rules.random.seed();
+}
+
+RoomState GameRoom::captureState() const
+{
+    RoomState state;
+    state.roomId = id;
+    state.name = name;
+    state.journalSeq = journalSeq;
+    state.nextPlayerId = nextPlayerId;
+    state.gameStarted = rules.started;
+    state.gameFinished = rules.finished;
+    state.winnerId = rules.winnerId;
+    const Engine::PlayerState *cur = Engine::currentPlayer(rules);
+    state.currentPlayerId = cur ? cur->id : -1;
+    state.awaitingBuyDecision = rules.buyPlayerId >= 0;
+    state.pendingBuyPlayerId = rules.buyPlayerId;
+    state.pendingBuyFieldIndex = rules.buyField;
+    state.awaitingEndTurn = rules.endTurnPlayerId >= 0;
+    state.pendingEndTurnPlayerId = rules.endTurnPlayerId;
+    state.randomSeed = rules.random.seed();
+    state.randomDraws = rules.random.draws();
+
+    // Reihenfolge = Zugreihenfolge
+    state.players.reserve(int(players.size()));
+    for (const auto &p : players) {
+        const Engine::PlayerState *rp = playerState(p->id);
+        if (!rp) continue;
+        PlayerState ps;
+        ps.id = p->id;
+        ps.name = p->name;
+        ps.session = p->sessionToken;
+        ps.position = rp->position;
+        ps.money = rp->money;
+        ps.inJail = rp->inJail;
+        ps.jailTurns = rp->jailTurns;
+        ps.bankrupt = rp->bankrupt;
+        ps.ready = rp->ready;
+        state.players.append(ps);
+    }
+
+    // nur Felder mit Besitzer, der Rest kommt aus Engine::board()
+    for (int i = 0; i < Engine::boardSize; ++i) {
+        if (rules.owner[i] < 0) continue;
+        FieldState fs;
+        fs.index = i;
+        fs.ownerId = rules.owner[i];
+        fs.hasHotel = rules.hotel[i];
+        state.fields.append(fs);
+    }
+    return state;
+}
+
+void GameRoom::restore(const RoomState &state, const QVector<QJsonObject> &events)
+{
+    journalSeq = state.journalSeq;
+    nextPlayerId = state.nextPlayerId;
+    rules.started = state.gameStarted;
+    rules.finished = state.gameFinished;
+    rules.winnerId = state.winnerId;
+
+    for (const PlayerState &ps : state.players) {
+        auto player = std::make_unique<Player>();
+        player->id = ps.id;
+        player->name = ps.name;
+        player->sessionToken = ps.session;
+        players.push_back(std::move(player));
+
+        Engine::PlayerState rp;
+        rp.id = ps.id;
+        rp.position = ps.position;
+        rp.money = ps.money;
+        rp.inJail = ps.inJail;
+        rp.jailTurns = ps.jailTurns;
+        rp.bankrupt = ps.bankrupt;
+        rp.ready = ps.ready;
+        rules.players.append(rp);
+    }
+
+    for (const FieldState &fs : state.fields) {
+        if (fs.index < 0 || fs.index >= Engine::boardSize
+            || !Engine::board().at(fs.index).isProperty() || !playerState(fs.ownerId)) {
+            continue;
+        }
+        rules.owner[fs.index] = fs.ownerId;
+        rules.hotel[fs.index] = fs.hasHotel
+                && Engine::board().at(fs.index).kind == Engine::FieldKind::Street;
+    }
+
+    for (int i = 0; i < rules.players.size(); ++i) {
+        if (rules.players[i].id == state.currentPlayerId) {
+            rules.current = i;
+        }
+    }
+    rules.buyPlayerId = state.awaitingBuyDecision ? state.pendingBuyPlayerId : -1;
+    rules.buyField = state.awaitingBuyDecision ? state.pendingBuyFieldIndex : -1;
+    rules.endTurnPlayerId = state.awaitingEndTurn ? state.pendingEndTurnPlayerId : -1;
+    // aeltere Snapshots ohne Seed behalten den frisch gezogenen
+    if (state.randomSeed != 0) {
+        rules.random = RoomRandom(state.randomSeed);
+        rules.random.advanceTo(state.randomDraws);
+    }
+
+    for (const QJsonObject &event : events) {
+        applyJournalEvent(event);
+        journalSeq = quint64(event.value("s").toDouble());
+    }
+
+    // niemand ist verbunden: Plaetze warten auf resume
+    for (const auto &p : players) {
+        p->connection = nullptr;
+        p->suspended = true;
+        p->suspendedTimer.start();
+    }
+
+    qDebug() << "[ROOM" << id << "] wiederhergestellt | seq=" << journalSeq
+             << "players=" << players.size() << "events=" << events.size();
+}
+
+void GameRoom::applyJournalEvent(const QJsonObject &event)
+{
+    // wie die Handler, nur ohne Nachrichten und ohne Zufall:
+    // Ereignisse tragen die Ergebnisse (Wuerfel, Kontostaende)
+    const QString type = event.value("e").toString();
+    Player *p = findPlayerById(event.value("p").toInt(-1));
+    Engine::PlayerState *ps = p ? playerState(p->id) : nullptr;
+    const int index = event.value("field").toInt(-1);
+    const bool validField = index >= 0 && index < Engine::boardSize;
+
+    if (type == "join") {
+        auto player = std::make_unique<Player>();
+        player->id = event.value("p").toInt();
+        player->name = event.value("name").toString();
+        player->sessionToken = event.value("session").toString();
+        nextPlayerId = std::max(nextPlayerId, player->id + 1);
+        Engine::PlayerState state;
+        state.id = player->id;
+        rules.players.append(state);
+        players.push_back(std::move(player));
+        return;
+    }
+    if (type == "finish") {
+        rules.finished = true;
+        rules.winnerId = event.value("winner").toInt(-1);
+        return;
+    }
+    if (type == "start") {
+        rules.started = true;
+        rules.finished = false;
+        rules.winnerId = -1;
+        return;
+    }
+    if (type == "restart") {
+        Engine::step(rules, {Engine::Action::Restart, -1}, nullptr);
+        return;
+    }
+    if (type == "turn") {
+        rules.endTurnPlayerId = -1;
+        for (int i = 0; p && i < rules.players.size(); ++i) {
+            if (rules.players[i].id == p->id) {
+                rules.current = i;
+            }
+        }
+        return;
+    }
+    if (type == "decline") {
+        rules.buyPlayerId = -1;
+        rules.buyField = -1;
+        return;
+    }
+    // Zufall auf denselben Stand wie im Original
+    if (type == "open" && event.contains("seed")) {
+        rules.random = RoomRandom(event.value("seed").toString().toULongLong(nullptr, 16));
+    }
+    if (event.contains("rng")) {
+        rules.random.advanceTo(quint64(event.value("rng").toDouble()));
+    }
+
+    if (type == "open" || !p || !ps) {
+        return;
+    }
+
+    if (type == "leave") {
+        Engine::step(rules, {Engine::Action::Leave, p->id}, nullptr);
+        players.erase(std::find_if(players.begin(), players.end(),
+                                   [&](const std::unique_ptr<Player>& q){ return q.get() == p; }));
+    } else if (type == "session") {
+        p->sessionToken = event.value("session").toString();
+    } else if (type == "name") {
+        p->name = event.value("name").toString();
+    } else if (type == "ready") {
+        ps->ready = event.value("ready").toBool();
+    } else if (type == "dice" || type == "jail") {
+        ps->position = event.value("pos").toInt();
+        if (type == "dice") {
+            ps->money = event.value("money").toInt();
+        } else {
+            ps->inJail = event.value("inJail").toBool();
+            ps->jailTurns = event.value("turns").toInt();
+        }
+    } else if (type == "rent") {
+        ps->money = event.value("money").toInt();
+        if (Engine::PlayerState *to = playerState(event.value("to").toInt(-1))) {
+            to->money = event.value("toMoney").toInt();
+        }
+    } else if (type == "card" || type == "tax" || type == "land") {
+        ps->money = event.value("money").toInt();
+    } else if (type == "buy") {
+        if (validField && Engine::board().at(index).isProperty() && rules.owner[index] < 0) {
+            rules.owner[index] = p->id;
+        }
+        ps->money = event.value("money").toInt();
+        rules.buyPlayerId = -1;
+        rules.buyField = -1;
+    } else if (type == "house") {
+        if (validField && Engine::board().at(index).kind == Engine::FieldKind::Street) {
+            rules.hotel[index] = true;
+        }
+        ps->money = event.value("money").toInt();
+    } else if (type == "offer") {
+        rules.buyPlayerId = p->id;
+        rules.buyField = index;
+    } else if (type == "awaitEnd") {
+        rules.endTurnPlayerId = p->id;
+    } else if (type == "bankrupt" || type == "surrender") {
+        ps->bankrupt = true;
+        Engine::releaseAssets(rules, p->id);
+        if (type == "surrender") {
+            Engine::clearPending(rules, p->id);
+        }
+    } else {
+        qWarning() << "[ROOM" << id << "] unbekanntes Journal-Ereignis:" << type;
+    }
+}
@@ -0,0 +1,179 @@
+#ifndef GAMEROOM_H
+#define GAMEROOM_H
+
+#include <QHash>
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QPair>
+#include <QString>
+#include <QVector>
+#include <memory>
+#include <vector>
+
+#include "player.h"
+#include "engine.h"
+#include "messagetable.h"
+#include "roomstate.h"
+
+class RoomShard;
+
+// Ein Spieltisch: jeder Raum hat sein eigenes Spiel (Engine::State mit
+// Spielstand, Besitz, Kauf-/Zugende-Status und Zufall) und seine eigene
+// Spielerliste mit Verbindungen und Sitzungen.
+class GameRoom
+{
+public:
+    static constexpr int maxPlayers = 4;
+
+    GameRoom(RoomShard &shard, int id, const QString &name);
+    ~GameRoom();
+
+    GameRoom(const GameRoom &) = delete;
+    GameRoom &operator=(const GameRoom &) = delete;
+
+    int getId() const;
+    QString getName() const;
+    int playerCount() const;
+    bool isStarted() const;
+    bool isFinished() const;
+    bool isFull() const;
+    bool isEmpty() const;
+
+    // Raumbeitritt/-austritt (Ownership des Players wandert mit)
+    Player* addPlayer(std::unique_ptr<Player> player);
+    std::unique_ptr<Player> removePlayer(Player *player, const QString &reason);
+
+    // Handler fuer Spiel-Nachrichten, nach Typ-Code (siehe protocol.h)
+    static const MessageTable<GameRoom> &messageTable();
+
+    // per Handshake ausgehandelte State-Faehigkeiten eines Clients setzen
+    void enableStateCaps(Player &player, bool delta, bool catalog, const QString &catalogHash);
+
+    // Verbindungsabbruch mit Sitzung: Platz bleibt, Nachrichten werden gepuffert.
+    // resumePlayer haengt den neuen Socket an; replayed = false -> voller State
+    void suspendPlayer(Player &player);
+    void resumePlayer(Player &player, ClientConnection *connection, bool replayed);
+
+    // Lookup
+    Player* findPlayerByConnection(ClientConnection *connection);
+    Player* findPlayerById(int id);
+    Player* findPlayerBySession(const QString &token);
+    QVector<Player*> allPlayers() const;
+
+    // Sitzungs-Token nach hello (landet mit im Journal)
+    void setSessionToken(Player &player, const QString &token);
+
+    // Seed des Raum-Zufalls (Wuerfel, Karten), steht im "open"-Ereignis
+    quint64 randomSeed() const;
+
+    // Abbild des Raums fuer Journal-Snapshots und Checkpoints; Wiederaufbau
+    // nach einem Neustart aus Ausgangszustand + neueren Journal-Ereignissen.
+    // Wiederhergestellte Spieler sind pausiert und warten auf resume.
+    RoomState captureState() const;
+    void restore(const RoomState &state, const QVector<QJsonObject> &events);
+    void writeJournalSnapshot();
+    bool hasUnsavedJournal() const;
+
+private:
+    RoomShard &shard;
+    int id;
+    QString name;
+
+    // gleiche Reihenfolge wie rules.players (Zugreihenfolge)
+    std::vector<std::unique_ptr<Player>> players;
+    int nextPlayerId = 1;
+
+    // der Spielstand; Engine::step aendert ihn direkt, State-Nachrichten,
+    // Snapshots und Checkpoints lesen nur hier
+    Engine::State rules;
+
+    // Statische Felddaten (Name, Preise, Farbe ...) aus Engine::board(),
+    // gehen nur einmal per boardCatalog raus
+    QVector<QJsonObject> catalogFields;
+    QString catalogHash;
+
+    // Versionierter State-Stream: zuletzt gesendeter Zustand als Basis fuer Deltas
+    struct StateBase {
+        QJsonObject full;
+        QHash<int, QJsonObject> players;
+        QVector<QJsonObject> fields;
+    };
+    int stateVersion = 0;
+    StateBase lastState;
+
+    // Zug-Buendelung: Clients mit "turnResult"-Faehigkeit bekommen einen
+    // aufgeloesten Zug (Wuerfel, Weg, Feldergebnis, Logs, State) als eine
+    // Nachricht statt diceRolled + logs + mehrerer States
+    struct TurnBatch {
+        bool active = false;
+        int playerId = -1;
+        int startMoney = 0;
+        QJsonObject dice;
+        QJsonArray path;
+        QJsonObject outcome;
+        QJsonArray events;
+        QString reason;
+        int baseVersion = 0;
+        StateBase base;
+        QVector<QJsonObject> after;                // andere Broadcasts, nach dem Envelope
+        QVector<QPair<int, QJsonObject>> direct;   // gezielte Nachrichten, nach dem Envelope
+    };
+    TurnBatch turnBatch;
+
+    // Journal: seq je Raum, Ereignisse seit dem letzten Snapshot
+    quint64 journalSeq = 0;
+    int journalPending = 0;
+    bool snapshotRequested = false;
+    void record(const QString &event, QJsonObject data = QJsonObject());
+    void applyJournalEvent(const QJsonObject &event);
+
+    // Regeln rechnet Engine (engine.h) direkt auf rules; aus den Ereignissen
+    // werden Journal, Logs und Nachrichten
+    bool runEngine(Player &player, const Engine::Action &action, QVector<Engine::Event> *events);
+    void applyEngineEvent(const Engine::Event &event);
+    void applyEngineEvents(const QVector<Engine::Event> &events);
+    Engine::PlayerState *playerState(int playerId);
+    const Engine::PlayerState *playerState(int playerId) const;
+
+    // Spielablauf
+    void handleStartGame(Player &player);
+    void handleRollDice(Player &player);
+    void resolveRoll(const QVector<Engine::Event> &events);
+
+    // autoTurn: Kaufregel fuer den ganzen Zug aus der Nachricht
+    static Engine::BuyPolicy buyPolicyFromMessage(const QJsonObject &msg);
+    bool autoTurnActive = false;
+    void handleAutoTurn(Player &player, const Engine::BuyPolicy &policy, bool endTurn);
+    void handleEndTurn(Player &player);
+    void handleSurrender(Player &player);
+    void handleSetReady(Player &player, bool ready);
+    void handleSetName(Player &player, const QString &name);
+    void handleRestartGame(Player &player);
+    void handleBuyHouse(Player &player, int fieldIndex);
+    void handleBuyDecision(Player &player, int playerId, int fieldIndex, bool buy);
+    void handleGetState(Player &player, const QJsonObject &msg);
+    bool areAllPlayersReady() const;
+
+    // JSON helpers
+    void sendToPlayer(Player &player, const QJsonObject &obj);
+    void broadcast(const QJsonObject &obj);
+    void broadcastLog(int playerId, const QString &message);
+
+    // State
+    void broadcastGameState(const QString &reason = QString());
+    QJsonObject buildGameState(const QString &reason = QString()) const;
+    QJsonObject buildStateDelta(const StateBase &base, const QJsonObject &full) const;
+    QJsonObject withCatalog(QJsonObject state) const;
+    void buildBoardCatalog();
+    void sendCatalogIfNeeded(Player &player);
+    void rememberState(const QJsonObject &full);
+
+    // turnResult
+    bool isBatched(const Player &player) const;
+    void beginTurnBatch(Player &player);
+    void collectForBatch(const QJsonObject &obj);
+    void endTurnBatch();
+    void sendStateSnapshot(Player &player);
+};
+
+#endif // GAMEROOM_H
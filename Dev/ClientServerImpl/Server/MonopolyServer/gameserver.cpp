@@ -1,1038 +1,692 @@
 ﻿#include "gameserver.h"
-
-#include <QJsonDocument>
-#include <QJsonArray>
+#include "tcptransport.h"
+#include "localtransport.h"
+#include "checkpoint.h"
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QLocalSocket>
+#include <QFile>
+#include <QJsonObject>
+#include <QSet>
 #include <QDebug>
-#include <QRandomGenerator>
 #include <algorithm>
 
-// Fields
-#include "startfield.h"
-#include "streetfield.h"
-#include "railroadfield.h"
-#include "utilityfield.h"
-#include "taxfield.h"
-#include "jailfield.h"
-#include "gotojailfield.h"
-#include "cardfield.h"
-#include "propertyfield.h"
-
-GameServer::GameServer(QObject *parent)
+GameServer::GameServer(int shardCount, QObject *parent)
     : QObject(parent)
+    , directory(std::max(1, shardCount))
 {
-    connect(&server, &QTcpServer::newConnection,
-            this, &GameServer::onNewConnection);
-}
+    const int count = std::max(1, shardCount);
+    for (int i = 0; i < count; ++i) {
+        auto *thread = new QThread(this);
+        thread->setObjectName(QString("shard-%1").arg(i));
 
-void GameServer::startServer(quint16 port)
-{
-    if (!server.listen(QHostAddress::Any, port)) {
-        qWarning() << "[SERVER] konnte nicht starten:" << server.errorString();
-        return;
-    }
-    qDebug() << "[SERVER] laeuft auf Port" << port;
-}
-
-void GameServer::onNewConnection()
-{
-    while (server.hasPendingConnections()) {
-        QTcpSocket* client = server.nextPendingConnection();
-        if (!client) continue;
+        auto *shard = new RoomShard(*this, directory, i);
+        shard->moveToThread(thread);
+        connect(thread, &QThread::finished, shard, &QObject::deleteLater);
 
-        auto player = std::make_unique<Player>();
-        player->id = nextPlayerId++;
-        player->socket = client;
-        player->name = QString("Player%1").arg(player->id);
-
-        players.push_back(std::move(player));
-        game.addPlayer(players.back().get());
-
-        recvBuffers.insert(client, QByteArray());
-
-        connect(client, &QTcpSocket::readyRead,
-                this, &GameServer::onReadyRead);
-        connect(client, &QTcpSocket::disconnected,
-                this, &GameServer::onClientDisconnected);
-
-        initBoardIfNeeded();
-
-        // Assign ID
-        QJsonObject msg;
-        msg["type"] = "assignPlayerId";
-        msg["playerId"] = players.back()->id;
-        msg["name"] = players.back()->name;
-        sendToSocket(client, msg);
-
-        qDebug() << "[NET] Neuer Client:" << players.back()->name
-                 << "| players=" << players.size();
-
-        // State an alle
-        broadcastGameState("playerJoined");
+        threads.append(thread);
+        shards.append(shard);
+        thread->start();
     }
-}
-
-void GameServer::onReadyRead()
-{
-    QTcpSocket* socket = qobject_cast<QTcpSocket*>(sender());
-    if (!socket) return;
-
-    Player *playerPtr = findPlayerBySocket(socket);
-    if (!playerPtr) return;
-
-    // newline-delimited JSON
-    recvBuffers[socket].append(socket->readAll());
-    auto &buf = recvBuffers[socket];
-
-    while (true) {
-        int nl = buf.indexOf('\n');
-        if (nl < 0) break;
-
-        QByteArray line = buf.left(nl);
-        buf.remove(0, nl + 1);
 
-        line = line.trimmed();
-        if (line.isEmpty()) continue;
+    connect(&server, &QTcpServer::newConnection,
+            this, &GameServer::onNewConnection);
+    connect(&localServer, &QLocalServer::newConnection,
+            this, &GameServer::onNewLocalConnection);
 
-        QJsonParseError err;
-        QJsonDocument doc = QJsonDocument::fromJson(line, &err);
-        if (err.error != QJsonParseError::NoError || !doc.isObject()) {
-            qWarning() << "[SERVER] JSON error:" << err.errorString()
-            << "raw=" << line;
-            continue;
-        }
+    connect(&statsTimer, &QTimer::timeout,
+            this, &GameServer::logShardStats);
+    statsTimer.start(60000);
 
-        qDebug() << "[SERVER] <= from" << playerPtr->name << line;
-        processMessage(*playerPtr, doc.object());
-    }
+    connect(&checkpointTimer, &QTimer::timeout,
+            this, &GameServer::writeCheckpoint);
+    connect(&handoverServer, &QLocalServer::newConnection,
+            this, &GameServer::onHandoverRequest);
 }
 
-void GameServer::processMessage(Player &player, const QJsonObject &msg)
+GameServer::~GameServer()
 {
-    const QString type = msg.value("type").toString();
-
-    if (type == "startGame") {
-        handleStartGame(player);
-        return;
+    // letzter Checkpoint, solange die Shards noch laufen
+    if (!checkpointPath.isEmpty()) {
+        writeCheckpoint();
     }
-
-    if (type == "rollDice") {
-        handleRollDice(player);
-        return;
+    for (QThread *thread : threads) {
+        thread->quit();
     }
-
-    if (type == "endTurn") {
-        handleEndTurn(player);
-        return;
-    }
-
-    if (type == "surrender") {
-        handleSurrender(player);
-        return;
-    }
-
-    if (type == "setReady") {
-        const bool ready = msg.value("ready").toBool(true);
-        handleSetReady(player, ready);
-        return;
-    }
-
-    if (type == "setName") {
-        const QString name = msg.value("name").toString().trimmed();
-        handleSetName(player, name);
-        return;
-    }
-
-    if (type == "restartGame") {
-        handleRestartGame(player);
-        return;
-    }
-
-    if (type == "buyHouse") {
-        handleBuyHouse(player, msg.value("fieldIndex").toInt(-1));
-        return;
+    for (QThread *thread : threads) {
+        thread->wait();
     }
+}
 
-    if (type == "buyDecision") {
-        const int pid = msg.value("playerId").toInt();
-        const int fieldIndex = msg.value("fieldIndex").toInt();
-        const bool buy = msg.value("buy").toBool(false);
-
-        qDebug() << "[BUY] decision from pid=" << pid
-                 << "field=" << fieldIndex
-                 << "buy=" << buy;
-
-        if (!awaitingBuyDecision ||
-            pid != pendingBuyPlayerId ||
-            fieldIndex != pendingBuyFieldIndex) {
-            qWarning() << "[BUY] Ignored (not pending / mismatch). pending pid="
-                       << pendingBuyPlayerId << "field=" << pendingBuyFieldIndex;
-            return;
+bool GameServer::startServer(quint16 port, Backend backend)
+{
+    if (backend == Backend::Epoll) {
+        if (!isBackendAvailable(backend)) {
+            qWarning() << "[SERVER] epoll-Backend nicht verfuegbar";
+            return false;
+        }
+        // Listener des Vorgaengers; die eines epoll-Vorgaengers reihum
+        // auf die Shards, ihre Accept-Queues gehen so nicht verloren
+        QVector<int> inherited;
+        bool shared = true;
+        if (takenOver) {
+            inherited = takenOver->listenerFds;
+            takenOver->listenerFds.clear();
+            // der Listener eines Qt-Vorgaengers hat kein SO_REUSEPORT, solange
+            // er offen ist, bindet niemand sonst den Port. Er bleibt offen
+            // (schliessen wuerde mit dem noch laufenden Vorgaenger um den Port
+            // konkurrieren), nimmt bei Shard 0 an und verteilt von dort
+            shared = takenOver->reusePort || inherited.isEmpty();
         }
 
-        Player *p = findPlayerById(pid);
-        Field *f = board.getField(fieldIndex);
-        auto *pf = dynamic_cast<PropertyField*>(f);
-
-        if (p && pf && pf->owner == nullptr) {
-            if (buy) {
-                qDebug() << "[BUY] Player" << p->id << "buys" << pf->name
-                         << "for" << pf->price << "(money before=" << p->money << ")";
-                pf->buy(*p);
-                qDebug() << "[BUY] money after=" << p->money;
-                broadcastLog(p->id, QString("kauft %1 fuer %2$")
-                                       .arg(pf->name)
-                                       .arg(pf->price));
-            } else {
-                qDebug() << "[BUY] Player" << p->id << "declined" << pf->name;
-                broadcastLog(p->id, QString("lehnt den Kauf von %1 ab")
-                                       .arg(pf->name));
+        // ein Listener pro Shard auf demselben Port
+        for (int i = 0; i < shards.size(); ++i) {
+            RoomShard *shard = shards[i];
+            QVector<int> own;
+            for (int j = i; j < inherited.size(); j += int(shards.size())) {
+                own.append(inherited[j]);
+            }
+            bool listening = false;
+            QMetaObject::invokeMethod(shard, [shard, port, own, shared]() {
+                if (own.isEmpty()) {
+                    return shared ? shard->listenNative(port) : shard->startNative();
+                }
+                bool adopted = true;
+                for (int fd : own) {
+                    if (!shard->adoptNativeListener(fd)) {
+                        Handover::closeDescriptor(fd);
+                        adopted = false;
+                    }
+                }
+                return adopted;
+            }, Qt::BlockingQueuedConnection, &listening);
+            if (!listening) {
+                qWarning() << "[SERVER] shard" << shard->getIndex() << "konnte nicht starten";
+                return false;
             }
-        } else {
-            qWarning() << "[BUY] Invalid buy target or player not found.";
         }
-
-        awaitingBuyDecision = false;
-        pendingBuyPlayerId = -1;
-        pendingBuyFieldIndex = -1;
-
-        awaitingEndTurn = true;
-        pendingEndTurnPlayerId = pid;
-
-        broadcastGameState("buyResolved");
-        broadcastGameState("awaitingEndTurn");
-        return;
+        qDebug() << "[SERVER] laeuft auf Port" << port << "| shards=" << shards.size() << "| epoll"
+                 << (shared ? "" : "| ein Listener bis zum naechsten Neustart");
+        finishTakeOver();
+        return true;
+    }
+
+    // Hot-Restart: derselbe Listener, wartende Verbindungen gehen nicht verloren
+    int inherited = -1;
+    if (takenOver && !takenOver->listenerFds.isEmpty()) {
+        inherited = takenOver->listenerFds.takeFirst();
+        if (!takenOver->listenerFds.isEmpty()) {
+            // epoll-Vorgaenger: QTcpServer nimmt nur einen seiner Listener,
+            // was in den uebrigen wartet, geht verloren
+            qWarning() << "[SERVER]" << takenOver->listenerFds.size()
+                       << "Listener des Vorgaengers geschlossen";
+            Handover::closeListeners(*takenOver);
+            takenOver->listenerFds.clear();
+        }
     }
-
-    if (type == "getState") {
-        sendToPlayer(player, buildGameState("getState"));
-        return;
+    const bool listening = inherited >= 0
+            ? server.setSocketDescriptor(inherited)
+            : server.listen(QHostAddress::Any, port);
+    if (!listening) {
+        qWarning() << "[SERVER] konnte nicht starten:" << server.errorString();
+        return false;
     }
-
-    qWarning() << "[NET] Unknown type:" << type;
+    qDebug() << "[SERVER] laeuft auf Port" << server.serverPort() << "| shards=" << shards.size();
+    finishTakeOver();
+    return true;
 }
 
-void GameServer::handleStartGame(Player &player)
+bool GameServer::listenLocal(const QString &name)
 {
-    if (gameStarted) {
-        qDebug() << "[GAME] startGame ignored (already started)";
-        QJsonObject info;
-        info["type"] = "info";
-        info["message"] = "Game already started.";
-        sendToPlayer(player, info);
-        return;
-    }
-
-    // Mindestspieler (aendere auf 1 wenn du solo willst)
-    if (players.size() < 2) {
-        qDebug() << "[GAME] startGame blocked (need 2 players), have" << players.size();
-        QJsonObject err;
-        err["type"] = "error";
-        err["message"] = "Mindestens 2 Spieler noetig um zu starten.";
-        sendToPlayer(player, err);
-        return;
-    }
-
-    if (!areAllPlayersReady()) {
-        QJsonObject err;
-        err["type"] = "error";
-        err["message"] = "Alle Spieler muessen bereit sein, bevor das Spiel startet.";
-        sendToPlayer(player, err);
-        return;
+    // Reste eines abgestuerzten Servers entfernen
+    QLocalServer::removeServer(name);
+    if (!localServer.listen(name)) {
+        qWarning() << "[SERVER] lokaler Socket" << name << "fehlgeschlagen:" << localServer.errorString();
+        return false;
     }
-
-    gameStarted = true;
-    gameFinished = false;
-    winnerId = -1;
-    qDebug() << "[GAME] STARTED by" << player.name
-             << "| currentPlayerId=" << (game.getCurrentPlayer() ? game.getCurrentPlayer()->id : -1);
-
-    broadcastLog(player.id, "startet das Spiel");
-    broadcastGameState("gameStarted");
+    qDebug() << "[SERVER] lokal erreichbar unter" << localServer.fullServerName();
+    return true;
 }
 
-void GameServer::handleSetReady(Player &player, bool ready)
+std::unique_ptr<LoopbackClient> GameServer::connectLoopback()
 {
-    player.isReady = ready;
-    broadcastLog(player.id, ready ? "ist bereit" : "ist nicht mehr bereit");
-    broadcastGameState("playerReady");
-
-    if (!gameStarted && areAllPlayersReady()) {
-        handleStartGame(player);
-    }
+    std::unique_ptr<LoopbackTransport> transport;
+    std::unique_ptr<LoopbackClient> client = LoopbackClient::create(&transport, nextLoopbackId++);
+    placeTransport(transport.release());
+    return client;
 }
 
-void GameServer::handleSetName(Player &player, const QString &name)
+bool GameServer::isBackendAvailable(Backend backend)
 {
-    if (name.isEmpty()) {
-        return;
-    }
-    player.name = name.left(20);
-    broadcastLog(player.id, QString("heisst jetzt %1").arg(player.name));
-    broadcastGameState("playerName");
+#ifdef MONOPOLY_EPOLL
+    Q_UNUSED(backend);
+    return true;
+#else
+    return backend == Backend::Qt;
+#endif
 }
 
-void GameServer::handleRestartGame(Player &player)
+bool GameServer::enableJournal(const QString &directoryPath)
 {
-    gameStarted = false;
-    gameFinished = false;
-    winnerId = -1;
-    clearPendingStateForPlayer(-1);
-
-    boardInitialized = false;
-    initBoardIfNeeded();
-
-    for (const auto &p : players) {
-        if (!p) {
-            continue;
+    if (journal) return true;
+
+    auto created = std::make_unique<GameJournal>(directoryPath);
+    int maxRoomId = 0;
+    const QVector<GameJournal::RoomLog> logs = created->recover(&maxRoomId);
+    directory.reserveRoomIds(maxRoomId);
+
+    // nach einer Uebergabe ist deren Zustand neuer als alles im Journal:
+    // nur noch die alten Raeume abschliessen
+    if (takenOver) {
+        QSet<int> handed;
+        for (const RoomRestore &room : std::as_const(takenOver->rooms)) {
+            handed.insert(room.state.roomId);
         }
-        p->position = 0;
-        p->money = 1500;
-        p->isBankrupt = false;
-        p->inJail = false;
-        p->jailTurns = 0;
-        p->properties.clear();
-        p->isReady = false;
-    }
-
-    game.resetTurnOrder();
-
-    broadcastLog(player.id, "startet einen Neustart");
-    broadcastGameState("gameRestarted");
-}
-
-void GameServer::handleBuyHouse(Player &player, int fieldIndex)
-{
-    if (!gameStarted || gameFinished) {
-        QJsonObject err;
-        err["type"] = "error";
-        err["message"] = "Hauskauf ist nur waehrend eines laufenden Spiels moeglich.";
-        sendToPlayer(player, err);
-        return;
+        if (!created->open()) {
+            return false;
+        }
+        for (const GameJournal::RoomLog &log : logs) {
+            if (!handed.contains(log.roomId)) {
+                created->dropRoom(log.roomId);
+            }
+        }
+        journal = std::move(created);
+        GameJournal *shared = journal.get();
+        for (RoomShard *shard : shards) {
+            QMetaObject::invokeMethod(shard, [shard, shared]() {
+                shard->setJournal(shared);
+            }, Qt::BlockingQueuedConnection);
+        }
+        qDebug() << "[SERVER] Journal in" << directoryPath << "| Raeume aus der Uebergabe";
+        return true;
     }
 
-    if (awaitingBuyDecision) {
-        QJsonObject err;
-        err["type"] = "error";
-        err["message"] = "Warte auf Kaufentscheidung. Hauskauf derzeit gesperrt.";
-        sendToPlayer(player, err);
-        return;
+    // Checkpoint als Ausgangspunkt, das Journal liefert, was danach kam
+    std::map<int, RoomRestore> restore = loadCheckpointRooms();
+    QSet<int> logged;
+    for (const GameJournal::RoomLog &log : logs) {
+        logged.insert(log.roomId);
     }
-
-    Player *current = game.getCurrentPlayer();
-    if (!current || current->id != player.id) {
-        QJsonObject err;
-        err["type"] = "error";
-        err["message"] = "Du bist nicht dran.";
-        sendToPlayer(player, err);
-        return;
+    for (auto it = restore.begin(); it != restore.end();) {
+        // dem Journal bekannt, aber dort nicht mehr offen: geschlossen
+        if (it->first <= maxRoomId && !logged.contains(it->first)) {
+            it = restore.erase(it);
+        } else {
+            ++it;
+        }
     }
 
-    // Spieler muss auf der Strasse stehen
-    (void)fieldIndex;
-    Field *f = board.getField(player.position);
-    auto *sf = dynamic_cast<StreetField*>(f);
+    for (const GameJournal::RoomLog &log : logs) {
+        RoomState base;
+        if (!log.snapshot.isEmpty()) {
+            base = RoomState::fromJson(log.snapshot);
+        } else {
+            base.roomId = log.roomId;
+            if (!log.events.isEmpty()) {
+                base.name = log.events.first().value("name").toString();
+            }
+        }
+        auto checkpoint = restore.find(log.roomId);
+        if (checkpoint != restore.end() && checkpoint->second.state.journalSeq > base.journalSeq) {
+            base = checkpoint->second.state;
+        }
 
-    if (!sf || sf->owner != &player) {
-        QJsonObject err;
-        err["type"] = "error";
-        err["message"] = "Hauskauf nur auf eigener Strasse moeglich.";
-        sendToPlayer(player, err);
-        return;
+        RoomRestore entry;
+        entry.state = base;
+        for (const QJsonObject &event : log.events) {
+            if (quint64(event.value("s").toDouble()) > base.journalSeq) {
+                entry.events.append(event);
+            }
+        }
+        restore[log.roomId] = entry;
     }
+    const int restored = restoreRooms(restore);
 
-    if (sf->hasHotel) {
-        QJsonObject err;
-        err["type"] = "error";
-        err["message"] = "Es steht bereits ein Haus.";
-        sendToPlayer(player, err);
-        return;
+    if (!created->open()) {
+        return false;
     }
+    journal = std::move(created);
 
-    if (player.money < sf->hotelPrice) {
-        QJsonObject err;
-        err["type"] = "error";
-        err["message"] = "Nicht genug Geld fuer ein Haus.";
-        sendToPlayer(player, err);
-        return;
+    // ab hier schreiben die Raeume mit, jeder zuerst einen Snapshot
+    GameJournal *shared = journal.get();
+    for (RoomShard *shard : shards) {
+        QMetaObject::invokeMethod(shard, [shard, shared]() {
+            shard->setJournal(shared);
+        }, Qt::BlockingQueuedConnection);
     }
 
-    sf->buyHotel(player);
-    broadcastLog(player.id, QString("kauft ein Haus auf %1 fuer %2$")
-                               .arg(sf->name)
-                               .arg(sf->hotelPrice));
-    broadcastGameState("houseBought");
+    qDebug() << "[SERVER] Journal in" << directoryPath << "| rooms restored=" << restored
+             << "of" << restore.size();
+    return true;
 }
 
-void GameServer::handleRollDice(Player &player)
+bool GameServer::takeOver(const QString &path)
 {
-    initBoardIfNeeded();
-
-    if (gameFinished) {
-        QJsonObject err;
-        err["type"] = "error";
-        err["message"] = "Spiel ist bereits beendet.";
-        sendToPlayer(player, err);
-        return;
+    QString error;
+    const int socket = Handover::connectTo(path, &error);
+    if (socket < 0) {
+        qDebug() << "[HANDOVER]" << error << "- normaler Start";
+        return false;
     }
 
-    if (!gameStarted) {
-        qDebug() << "[TURN] rollDice blocked - game not started";
-        QJsonObject err;
-        err["type"] = "error";
-        err["message"] = "Spiel ist noch nicht gestartet. Sende {\"type\":\"startGame\"}.";
-        sendToPlayer(player, err);
-        return;
+    QElapsedTimer timer;
+    timer.start();
+    auto state = std::make_unique<Handover::State>();
+
+    // erst "alles da", dann wartet der Vorgaenger nicht mehr auf uns
+    // und gibt seine Sockets frei
+    const bool ok = Handover::receive(socket, state.get(), &error)
+            && Handover::acknowledge(socket, &error)
+            && Handover::waitForAcknowledge(socket, Handover::ackTimeoutMs, &error);
+    Handover::closeDescriptor(socket);
+    if (!ok) {
+        Handover::closeConnections(*state);
+        Handover::closeListeners(*state);
+        qWarning() << "[HANDOVER] Uebernahme fehlgeschlagen:" << error;
+        return false;
     }
 
-    if (awaitingEndTurn) {
-        qDebug() << "[TURN] rollDice blocked - awaiting endTurn";
-        QJsonObject err;
-        err["type"] = "error";
-        err["message"] = "Bitte zuerst den Zug beenden.";
-        sendToPlayer(player, err);
-        return;
+    int connections = 0;
+    for (const RoomRestore &room : std::as_const(state->rooms)) {
+        connections += room.connections.size();
+        directory.reserveRoomIds(room.state.roomId);
     }
+    qDebug() << "[HANDOVER] uebernommen: rooms=" << state->rooms.size()
+             << "connections=" << connections << "listeners=" << state->listenerFds.size()
+             << "in" << timer.elapsed() << "ms";
+    takenOver = std::move(state);
+    return true;
+}
 
-    if (awaitingBuyDecision) {
-        qDebug() << "[TURN] rollDice blocked - waiting for buyDecision";
-        QJsonObject err;
-        err["type"] = "error";
-        err["message"] = "Warte auf Kaufentscheidung. Erst buyDecision senden.";
-        sendToPlayer(player, err);
-        return;
+bool GameServer::listenHandover(const QString &path)
+{
+    if (!Handover::isSupported()) {
+        qWarning() << "[HANDOVER] Hot-Restart nur unter Unix";
+        return false;
     }
-
-    Player *current = game.getCurrentPlayer();
-
-    if (!current) return;
-
-    if (current->id != player.id) {
-        qDebug() << "[TURN] rollDice blocked - not your turn"
-                 << "| current=" << current->id
-                 << "| you=" << player.id;
-        QJsonObject err;
-        err["type"] = "error";
-        err["message"] = "Du bist nicht dran.";
-        sendToPlayer(player, err);
-        return;
+    // der Socket des Vorgaengers (oder eines abgestuerzten Servers) ist frei
+    QLocalServer::removeServer(path);
+    if (!handoverServer.listen(path)) {
+        qWarning() << "[HANDOVER]" << path << "fehlgeschlagen:" << handoverServer.errorString();
+        return false;
     }
+    qDebug() << "[HANDOVER] Nachfolger kann uebernehmen ueber" << handoverServer.fullServerName();
+    return true;
+}
 
-    // Minimal Jail-Wartezug (falls du jail benutzt)
-    if (current->inJail) {
-        current->jailTurns--;
-        qDebug() << "[JAIL] Player" << current->id << "waits. remaining=" << current->jailTurns;
-
-        if (current->jailTurns <= 0) {
-            current->inJail = false;
-            current->jailTurns = 0;
-            qDebug() << "[JAIL] Player" << current->id << "released.";
+void GameServer::onHandoverRequest()
+{
+    QLocalSocket *peer = handoverServer.nextPendingConnection();
+    if (!peer) return;
+    const int socket = int(peer->socketDescriptor());
+
+    QElapsedTimer timer;
+    timer.start();
+    qDebug() << "[HANDOVER] Nachfolger meldet sich";
+
+    // 1. nichts Neues mehr annehmen oder lesen, Ausgaenge leeren
+    server.pauseAccepting();
+    for (RoomShard *shard : shards) {
+        QMetaObject::invokeMethod(shard, [shard]() {
+            shard->pauseForHandover();
+        }, Qt::BlockingQueuedConnection);
+    }
+    while (timer.elapsed() < Handover::drainTimeoutMs) {
+        bool drained = true;
+        for (RoomShard *shard : shards) {
+            bool shardDrained = false;
+            QMetaObject::invokeMethod(shard, [shard]() {
+                return shard->isDrained();
+            }, Qt::BlockingQueuedConnection, &shardDrained);
+            drained = drained && shardDrained;
         }
-
-        broadcastGameState("jailWait");
-        awaitingEndTurn = true;
-        pendingEndTurnPlayerId = current->id;
-        broadcastGameState("awaitingEndTurn");
-        return;
-    }
-
-    int d1 = int(QRandomGenerator::global()->bounded(1, 7));
-    int d2 = int(QRandomGenerator::global()->bounded(1, 7));
-    int steps = d1 + d2;
-
-    const int oldPos = current->position;
-    const int oldMoney = current->money;
-
-    current->move(steps);
-
-    Field *f = board.getField(current->position);
-
-    qDebug() << "[TURN] Player" << current->id
-             << "rolled" << d1 << "+" << d2 << "=" << steps
-             << "| pos" << oldPos << "->" << current->position
-             << "| money" << oldMoney << "->" << current->money
-             << "| field=" << (f ? f->name : QString("<null>"));
-
-    // Utility: lastDiceRoll setzen, bevor onLand Miete berechnet
-    if (auto *uf = dynamic_cast<UtilityField*>(f)) {
-        uf->lastDiceRoll = steps;
-        qDebug() << "[FIELD] Utility lastDiceRoll set to" << steps;
+        if (drained) break;
+        QThread::msleep(10);
     }
 
-    // Wuerfel-Event an alle
-    QJsonObject roll;
-    roll["type"] = "diceRolled";
-    roll["playerId"] = current->id;
-    roll["d1"] = d1;
-    roll["d2"] = d2;
-    roll["steps"] = steps;
-    roll["newPosition"] = current->position;
-    roll["fieldName"] = f ? f->name : QString();
-    broadcast(roll);
-
-    // Feld auswerten (Miete/Steuer etc. passiert in deinen Field-Klassen)
-    if (f) {
-        const int before = current->money;
-        qDebug() << "[FIELD] onLand ->" << f->index << f->name
-                 << "| playerMoneyBefore=" << before;
-
-        f->onLand(*current);
-
-        qDebug() << "[FIELD] onLand done"
-                 << "| playerMoneyAfter=" << current->money;
-
-
-        const int delta = current->money - before;
-        if (auto *tf = dynamic_cast<TaxField*>(f)) {
-            broadcastLog(current->id, QString("muss %2$ %1 zahlen")
-                                       .arg(tf->name)
-                                       .arg(tf->taxAmount));
-        } else if (auto *sf = dynamic_cast<StreetField*>(f)) {
-            if (sf->owner && sf->owner != current) {
-                broadcastLog(current->id, QString("zahlt %1$ Miete an %2 fuer %3")
-                                           .arg(sf->calculateRent())
-                                           .arg(sf->owner->name)
-                                           .arg(sf->name));
-            }
-        } else if (auto *rf = dynamic_cast<RailroadField*>(f)) {
-            if (rf->owner && rf->owner != current) {
-                broadcastLog(current->id, QString("zahlt %1$ Miete an %2 fuer %3")
-                                           .arg(rf->calculateRent())
-                                           .arg(rf->owner->name)
-                                           .arg(rf->name));
-            }
-        } else if (auto *uf = dynamic_cast<UtilityField*>(f)) {
-            if (uf->owner && uf->owner != current) {
-                broadcastLog(current->id, QString("zahlt %1$ Miete an %2 fuer %3")
-                                           .arg(uf->calculateRent())
-                                           .arg(uf->owner->name)
-                                           .arg(uf->name));
-            }
+    // 2. Journal abschliessen, der Nachfolger liest es als Naechster
+    if (journal) {
+        for (RoomShard *shard : shards) {
+            QMetaObject::invokeMethod(shard, [shard]() {
+                shard->setJournal(nullptr);
+            }, Qt::BlockingQueuedConnection);
         }
-        if (delta > 0 && !dynamic_cast<CardField*>(f)) {
-            broadcastLog(current->id, QString("erhaelt %1$ auf %2").arg(delta).arg(f->name));
+        journal->close();
+    }
+
+    // 3. Raeume und Sockets einsammeln und schicken
+    Handover::State state;
+    if (server.isListening()) {
+        state.listenerFds.append(int(server.socketDescriptor()));
+    }
+    for (RoomShard *shard : shards) {
+        QVector<int> listeners;
+        QMetaObject::invokeMethod(shard, [shard]() {
+            return shard->nativeListeners();
+        }, Qt::BlockingQueuedConnection, &listeners);
+        state.listenerFds += listeners;
+        state.reusePort = state.reusePort || !listeners.isEmpty();
+    }
+    QVector<QVector<RoomRestore>> released(shards.size());
+    int connections = 0;
+    for (int i = 0; i < shards.size(); ++i) {
+        RoomShard *shard = shards[i];
+        QMetaObject::invokeMethod(shard, [shard]() {
+            return shard->releaseForHandover();
+        }, Qt::BlockingQueuedConnection, &released[i]);
+        for (const RoomRestore &room : std::as_const(released[i])) {
+            connections += room.connections.size();
         }
-
-        // Ereigniskarte: Nachricht an alle senden
-        if (auto *cf = dynamic_cast<CardField*>(f)) {
-            if (!cf->lastCardMessage.isEmpty()) {
-                broadcastLog(current->id, cf->lastCardMessage);
-                cf->lastCardMessage.clear();
-            }
-        }
-
-        // Gehe zu Berufsschule: Spieler ist jetzt im Gefaengnis
-        if (dynamic_cast<GoToJailField*>(f)) {
-            broadcastLog(current->id, "geht in die Berufsschule! (Gefaengnis, 3 Zuege)");
-            // Position wurde bereits in goToJail() auf 10 gesetzt
-            broadcastGameState("goToJail");
-            awaitingEndTurn = true;
-            pendingEndTurnPlayerId = current->id;
-            broadcastGameState("awaitingEndTurn");
-            return;
-        }
-
-        // Pleite-Check nach jedem Feld
-        if (current->isBankrupt) {
-            broadcastLog(current->id, "ist pleite!");
-            releasePlayerAssets(*current);
-            updateWinnerIfNeeded("playerBankrupt");
-            if (gameFinished) {
-                return;
-            }
-        }
-    }
-
-    // Freies Property? -> Kaufen anbieten
-    if (auto *pf = dynamic_cast<PropertyField*>(f)) {
-        if (pf->owner == nullptr && current->money >= pf->price) {
-            qDebug() << "[BUY?] Offer to player" << current->id
-                     << "field=" << pf->index << pf->name
-                     << "price=" << pf->price;
-
-            askToBuy(*current, pf->index, pf->price, pf->name);
-            broadcastGameState("buyRequested");
-            return; // Turn erst nach buyDecision beenden
+        state.rooms += released[i];
+    }
+
+    QString error;
+    const bool ok = Handover::send(socket, state, &error)
+            && Handover::waitForAcknowledge(socket, Handover::ackTimeoutMs, &error)
+            && Handover::acknowledge(socket, &error);
+    delete peer;
+
+    if (ok) {
+        // die Sockets gehoeren jetzt dem Nachfolger; kein letzter
+        // Checkpoint mit veraltetem Stand
+        Handover::closeConnections(state);
+        checkpointTimer.stop();
+        checkpointPath.clear();
+        handoverServer.close();
+        qDebug() << "[HANDOVER] abgeschlossen: rooms=" << state.rooms.size()
+                 << "connections=" << connections << "in" << timer.elapsed() << "ms, beende";
+        QCoreApplication::quit();
+        return;
+    }
+
+    // Nachfolger gescheitert: alles zuruecknehmen und weiterlaufen
+    qWarning() << "[HANDOVER] fehlgeschlagen:" << error << "- laufe weiter";
+    for (int i = 0; i < shards.size(); ++i) {
+        RoomShard *shard = shards[i];
+        const QVector<RoomRestore> &rooms = released[i];
+        QMetaObject::invokeMethod(shard, [shard, &rooms]() {
+            shard->resumeAfterHandover(rooms);
+        }, Qt::BlockingQueuedConnection);
+    }
+    if (journal && journal->open()) {
+        GameJournal *shared = journal.get();
+        for (RoomShard *shard : shards) {
+            QMetaObject::invokeMethod(shard, [shard, shared]() {
+                shard->setJournal(shared);
+            }, Qt::BlockingQueuedConnection);
         }
     }
-
-    broadcastGameState("turnResolved");
-    awaitingEndTurn = true;
-    pendingEndTurnPlayerId = current->id;
-    broadcastGameState("awaitingEndTurn");
+    server.resumeAccepting();
 }
 
-void GameServer::handleEndTurn(Player &player)
+void GameServer::finishTakeOver()
 {
-    if (gameFinished) {
-        QJsonObject err;
-        err["type"] = "error";
-        err["message"] = "Spiel ist bereits beendet.";
-        sendToPlayer(player, err);
-        return;
-    }
-
-    if (!gameStarted) {
-        QJsonObject err;
-        err["type"] = "error";
-        err["message"] = "Spiel ist noch nicht gestartet.";
-        sendToPlayer(player, err);
-        return;
-    }
-
-    // Auto-Decline: Spieler beendet Zug ohne zu kaufen
-    if (awaitingBuyDecision && pendingBuyPlayerId == player.id) {
-        Field *f = board.getField(pendingBuyFieldIndex);
-        auto *pf = dynamic_cast<PropertyField*>(f);
-        if (pf) {
-            broadcastLog(player.id, QString("lehnt den Kauf von %1 ab").arg(pf->name));
-        }
-        awaitingBuyDecision = false;
-        pendingBuyPlayerId = -1;
-        pendingBuyFieldIndex = -1;
-        awaitingEndTurn = true;
-        pendingEndTurnPlayerId = player.id;
-    } else if (awaitingBuyDecision) {
-        QJsonObject err;
-        err["type"] = "error";
-        err["message"] = "Erst Kaufentscheidung treffen.";
-        sendToPlayer(player, err);
-        return;
-    }
-
-    Player *current = game.getCurrentPlayer();
-    if (!current) return;
+    if (!takenOver) return;
 
-    if (!awaitingEndTurn || pendingEndTurnPlayerId != player.id || current->id != player.id) {
-        QJsonObject err;
-        err["type"] = "error";
-        err["message"] = "Du kannst den Zug gerade nicht beenden.";
-        sendToPlayer(player, err);
-        return;
+    // Raeume samt Verbindungen auf ihre Shards, erst jetzt gibt es dort
+    // (beim epoll-Backend) die Event-Loops fuer die Sockets
+    std::map<int, RoomRestore> restore;
+    for (const RoomRestore &room : std::as_const(takenOver->rooms)) {
+        restore[room.state.roomId] = room;
     }
+    takenOver.reset();
 
-    awaitingEndTurn = false;
-    pendingEndTurnPlayerId = -1;
-    broadcastLog(player.id, "beendet den Zug");
-    finishTurnAndBroadcast();
+    const int restored = restoreRooms(restore);
+    qDebug() << "[HANDOVER] Raeume uebernommen:" << restored << "of" << restore.size();
 }
 
-void GameServer::handleSurrender(Player &player)
+void GameServer::setCheckpoint(const QString &path, int intervalMs)
 {
-    if (!gameStarted || gameFinished) {
-        QJsonObject err;
-        err["type"] = "error";
-        err["message"] = "Aufgeben ist nur waehrend eines laufenden Spiels moeglich.";
-        sendToPlayer(player, err);
-        return;
-    }
-
-    const bool wasCurrentPlayer = game.getCurrentPlayer() == &player;
-
-    player.isBankrupt = true;
-    releasePlayerAssets(player);
-    clearPendingStateForPlayer(player.id);
-    broadcastLog(player.id, "gibt auf");
-    updateWinnerIfNeeded("playerSurrendered");
-    if (!gameFinished && wasCurrentPlayer) {
-        finishTurnAndBroadcast();
-        return;
+    checkpointPath = path;
+    if (intervalMs > 0) {
+        checkpointTimer.start(intervalMs);
+    } else {
+        checkpointTimer.stop();
     }
-    broadcastGameState("playerSurrendered");
 }
 
-void GameServer::initBoardIfNeeded()
+bool GameServer::writeCheckpoint()
 {
-    if (boardInitialized) return;
-    boardInitialized = true;
+    if (checkpointPath.isEmpty()) return false;
 
-    qDebug() << "[BOARD] initializing...";
+    QElapsedTimer timer;
+    timer.start();
 
-    for (Field *f : board.fields) {
-        delete f;
+    // jeder Shard liefert seine Raeume zwischen zwei Nachrichten
+    QVector<RoomState> rooms;
+    for (RoomShard *shard : shards) {
+        QVector<RoomState> part;
+        QMetaObject::invokeMethod(shard, [shard]() {
+            return shard->captureRooms();
+        }, Qt::BlockingQueuedConnection, &part);
+        rooms += part;
     }
-    board.fields.clear();
-    board.fields.reserve(40);
-
-    auto fast = [](int value) {
-        return std::max(1, value / 2);
-    };
-
-    auto mkStart = [&](int idx, const QString &nm, int bonus){
-        auto *f = new StartField();
-        f->index = idx;
-        f->name = nm;
-        f->startBonus = fast(bonus);
-        board.fields.append(f);
-    };
-
-    auto mkStreet = [&](int idx, const QString &nm, const QString &color,
-                        int price, int baseRent, int hotelPrice, int hotelRent){
-        auto *f = new StreetField();
-        f->index = idx;
-        f->name = nm;
-        f->color = color;
-        f->price = fast(price);
-        f->baseRent = fast(baseRent * 2);
-        f->hotelPrice = fast(hotelPrice);
-        f->hotelRent  = fast(hotelRent);
-        board.fields.append(f);
-    };
-
-    auto mkRail = [&](int idx, const QString &nm, int price, int rent){
-        auto *f = new RailroadField();
-        f->index = idx;
-        f->name = nm;
-        f->price = fast(price);
-        f->baseRent = fast(rent * 2);
-        board.fields.append(f);
-    };
-
-    auto mkUtil = [&](int idx, const QString &nm, int price){
-        auto *f = new UtilityField();
-        f->index = idx;
-        f->name = nm;
-        f->price = fast(price);
-        f->baseRent = 0;
-        board.fields.append(f);
-    };
-
-    auto mkTax = [&](int idx, const QString &nm, int tax){
-        auto *f = new TaxField();
-        f->index = idx;
-        f->name = nm;
-        f->taxAmount = fast(tax);
-        board.fields.append(f);
-    };
-
-    auto mkJail = [&](int idx, const QString &nm){
-        auto *f = new JailField();
-        f->index = idx;
-        f->name = nm;
-        board.fields.append(f);
-    };
-
-    auto mkGoToJail = [&](int idx, const QString &nm){
-        auto *f = new GoToJailField();
-        f->index = idx;
-        f->name = nm;
-        board.fields.append(f);
-    };
-
-    auto mkCard = [&](int idx, const QString &nm){
-        auto *f = new CardField();
-        f->index = idx;
-        f->name = nm;
-        board.fields.append(f);
-    };
-
-    mkStart(0, "Start", 300);
-    mkStreet(1, "Altbau", "Braun", 60, 2, 50, 10);
-    mkCard(2, "Unterricht");
-    mkStreet(3, "Sporthalle", "Braun", 60, 4, 50, 20);
-    mkTax(4, "Papiergeld", 100);
-    mkRail(5, "Erlanger Bahnhof", 200, 25);
-    mkStreet(6, "Kaufland", "Hellblau", 100, 6, 50, 30);
-    mkCard(7, "Unterricht");
-    mkStreet(8, "Back21", "Hellblau", 100, 6, 50, 30);
-    mkStreet(9, "Brezenkolb", "Hellblau", 120, 8, 50, 40);
-    mkJail(10, "Berufsschule / Schulfrei");
-    mkStreet(11, "Franken Doener", "Pink", 140, 10, 100, 50);
-    mkUtil(12, "Wasserspender", 150);
-    mkStreet(13, "Berliner Doener", "Pink", 140, 10, 100, 50);
-    mkStreet(14, "Subway", "Pink", 160, 12, 100, 60);
-    mkRail(15, "Nuernberger Bahnhof", 200, 25);
-    mkStreet(16, "Sekretariat", "Orange", 180, 14, 100, 70);
-    mkCard(17, "Unterricht");
-    mkStreet(18, "Lehrerzimmer", "Orange", 180, 14, 100, 70);
-    mkStreet(19, "Buero-Direktor", "Orange", 200, 16, 100, 80);
-    mkTax(20, "Ferien", 0);
-    mkStreet(21, "Neubau", "Rot", 220, 18, 150, 90);
-    mkCard(22, "Unterricht");
-    mkStreet(23, "FOS", "Rot", 220, 18, 150, 90);
-    mkStreet(24, "Pausenhof", "Rot", 240, 20, 150, 100);
-    mkRail(25, "Busbahnhof Erlangen", 200, 25);
-    mkStreet(26, "Serverraum", "Gelb", 260, 22, 150, 110);
-    mkStreet(27, "Lager", "Gelb", 260, 22, 150, 110);
-    mkUtil(28, "Toilette", 150);
-    mkStreet(29, "Klassenraum", "Gelb", 280, 24, 150, 120);
-    mkGoToJail(30, "Gehe zu Berufsschule");
-    mkStreet(31, "IHK Pruefungshalle", "Gruen", 300, 26, 200, 130);
-    mkStreet(32, "Fraenky", "Gruen", 300, 26, 200, 130);
-    mkCard(33, "Unterricht");
-    mkStreet(34, "DerBeck", "Gruen", 320, 28, 200, 150);
-    mkRail(35, "Baiersdorfer Bahnhof", 200, 25);
-    mkCard(36, "Unterricht");
-    mkStreet(37, "Berufsagentur", "Dunkelblau", 350, 35, 200, 175);
-    mkTax(38, "Papiergeld", 100);
-    mkStreet(39, "ProLeiT", "Dunkelblau", 400, 50, 200, 200);
-
-    qDebug() << "[BOARD] ready with fields=" << board.fields.size();
-}
 
-void GameServer::askToBuy(Player &player, int fieldIndex, int price, const QString &fieldName)
-{
-    awaitingBuyDecision = true;
-    pendingBuyPlayerId = player.id;
-    pendingBuyFieldIndex = fieldIndex;
-
-    QJsonObject req;
-    req["type"] = "buyRequest";
-    req["playerId"] = player.id;
-    req["fieldIndex"] = fieldIndex;
-    req["fieldName"] = fieldName;
-    req["price"] = price;
-
-    sendToPlayer(player, req);
+    QString error;
+    if (!Checkpoint::write(checkpointPath, rooms, &error)) {
+        qWarning() << "[SERVER] Checkpoint fehlgeschlagen:" << error;
+        return false;
+    }
+    qDebug() << "[SERVER] Checkpoint:" << rooms.size() << "rooms in" << timer.elapsed() << "ms";
+    return true;
 }
 
-void GameServer::finishTurnAndBroadcast()
+bool GameServer::restoreCheckpoint()
 {
-    awaitingEndTurn = false;
-    pendingEndTurnPlayerId = -1;
-    game.nextTurn();
-    qDebug() << "[TURN] nextTurn -> currentPlayerId="
-             << (game.getCurrentPlayer() ? game.getCurrentPlayer()->id : -1);
-    broadcastGameState("nextTurn");
+    const std::map<int, RoomRestore> restore = loadCheckpointRooms();
+    if (restore.empty()) return false;
+
+    directory.reserveRoomIds(restore.rbegin()->first);
+    const int restored = restoreRooms(restore);
+    qDebug() << "[SERVER] Checkpoint" << checkpointPath << "| rooms restored=" << restored
+             << "of" << restore.size();
+    return true;
 }
 
-void GameServer::releasePlayerAssets(Player &player)
+std::map<int, RoomRestore> GameServer::loadCheckpointRooms() const
 {
-    for (PropertyField *property : player.properties) {
-        if (!property) {
-            continue;
-        }
-        property->release();
-        if (auto *street = dynamic_cast<StreetField*>(property)) {
-            street->hasHotel = false;
-        }
+    std::map<int, RoomRestore> restore;
+    if (checkpointPath.isEmpty()
+        || (!QFile::exists(checkpointPath) && !QFile::exists(checkpointPath + ".tmp"))) {
+        return restore;
     }
-    player.properties.clear();
-}
 
-void GameServer::clearPendingStateForPlayer(int playerId)
-{
-    if (playerId < 0 || pendingBuyPlayerId == playerId) {
-        awaitingBuyDecision = false;
-        pendingBuyPlayerId = -1;
-        pendingBuyFieldIndex = -1;
+    QElapsedTimer timer;
+    timer.start();
+    QVector<RoomState> rooms;
+    QString error;
+    if (!Checkpoint::load(checkpointPath, &rooms, &error)) {
+        qWarning() << "[SERVER] Checkpoint verworfen:" << error;
+        return restore;
     }
-    if (playerId < 0 || pendingEndTurnPlayerId == playerId) {
-        awaitingEndTurn = false;
-        pendingEndTurnPlayerId = -1;
+    for (const RoomState &room : rooms) {
+        restore[room.roomId].state = room;
     }
+    qDebug() << "[SERVER] Checkpoint gelesen:" << rooms.size() << "rooms in" << timer.elapsed() << "ms";
+    return restore;
 }
 
-void GameServer::sendToSocket(QTcpSocket *socket, const QJsonObject &obj)
+int GameServer::restoreRooms(const std::map<int, RoomRestore> &restore)
 {
-    if (!socket) return;
-    QByteArray data = QJsonDocument(obj).toJson(QJsonDocument::Compact);
-    data.append('\n');
-    socket->write(data);
-    socket->flush();
-
-    qDebug() << "[NET] => to socket" << data.trimmed();
-}
-
-void GameServer::sendToPlayer(Player &player, const QJsonObject &obj)
-{
-    sendToSocket(player.socket, obj);
+    // Raeume mit ihrer alten ID auf die Shards verteilen, dann je Shard
+    // ein Aufruf fuer alle seine Raeume
+    QVector<QVector<const RoomRestore*>> perShard(shards.size());
+    for (const auto &entry : restore) {
+        perShard[directory.restoreRoom(entry.first, entry.second.state.name)].append(&entry.second);
+    }
+
+    int restored = 0;
+    for (int i = 0; i < shards.size(); ++i) {
+        if (perShard[i].isEmpty()) continue;
+        RoomShard *shard = shards[i];
+        const QVector<const RoomRestore*> &rooms = perShard[i];
+        int kept = 0;
+        QMetaObject::invokeMethod(shard, [shard, &rooms]() {
+            int count = 0;
+            for (const RoomRestore *room : rooms) {
+                if (shard->restoreRoom(*room)) {
+                    count++;
+                }
+            }
+            return count;
+        }, Qt::BlockingQueuedConnection, &kept);
+        restored += kept;
+    }
+    return restored;
 }
 
-void GameServer::broadcast(const QJsonObject &obj)
+void GameServer::setHeartbeat(int intervalMs, int maxMissed)
 {
-    for (auto &p : players) {
-        if (p && p->socket) {
-            sendToPlayer(*p, obj);
-        }
+    for (RoomShard *shard : shards) {
+        QMetaObject::invokeMethod(shard, [shard, intervalMs, maxMissed]() {
+            shard->setHeartbeat(intervalMs, maxMissed);
+        }, Qt::QueuedConnection);
     }
 }
 
-void GameServer::broadcastLog(int playerId, const QString &message)
+void GameServer::setResumeGrace(int graceMs)
 {
-    QJsonObject log;
-    log["type"] = "log";
-    log["playerId"] = playerId;
-    log["message"] = message;
-    broadcast(log);
+    for (RoomShard *shard : shards) {
+        QMetaObject::invokeMethod(shard, [shard, graceMs]() {
+            shard->setResumeGrace(graceMs);
+        }, Qt::QueuedConnection);
+    }
 }
 
-QJsonObject GameServer::buildGameState(const QString &reason) const
+void GameServer::setRoomSeed(quint64 seed)
 {
-    QJsonObject state;
-    state["type"] = "state";
-    state["reason"] = reason;
-    state["gameStarted"] = gameStarted;
-    state["gameFinished"] = gameFinished;
-    state["winnerId"] = winnerId;
-
-    Player *cur = const_cast<Game&>(game).getCurrentPlayer();
-    if (gameStarted && !cur && !players.empty()) {
-        cur = players.front().get();
-    }
-    state["currentPlayerId"] = (gameStarted && cur) ? cur->id : -1;
-
-    QJsonArray parr;
-    for (const auto &p : players) {
-        QJsonObject po;
-        if (!p) {
-            continue;
-        }
-        po["id"] = p->id;
-        po["name"] = p->name;
-        po["position"] = p->position;
-        po["money"] = p->money;
-        po["inJail"] = p->inJail;
-        po["jailTurns"] = p->jailTurns;
-        po["bankrupt"] = p->isBankrupt;
-        po["ready"] = p->isReady;
-        parr.append(po);
-    }
-    state["players"] = parr;
-
-    QJsonArray farr;
-    for (int i = 0; i < board.fields.size(); ++i) {
-        Field *f = board.fields[i];
-        QJsonObject fo;
-        fo["index"] = i;
-        fo["name"] = f ? f->name : QString();
-
-        if (auto *pf = dynamic_cast<PropertyField*>(f)) {
-            fo["type"] = "property";
-            fo["price"] = pf->price;
-            fo["baseRent"] = pf->baseRent;
-            fo["ownerId"] = pf->owner ? pf->owner->id : -1;
-
-            if (auto *sf = dynamic_cast<StreetField*>(f)) {
-                fo["subtype"] = "street";
-                fo["color"] = sf->color;
-                fo["hasHotel"] = sf->hasHotel;
-                fo["hotelPrice"] = sf->hotelPrice;
-                fo["hotelRent"] = sf->hotelRent;
-            } else if (dynamic_cast<RailroadField*>(f)) {
-                fo["subtype"] = "railroad";
-            } else if (dynamic_cast<UtilityField*>(f)) {
-                fo["subtype"] = "utility";
-            }
-        } else if (dynamic_cast<GoToJailField*>(f)) {
-            fo["type"] = "gotojail";
-        } else if (dynamic_cast<CardField*>(f)) {
-            fo["type"] = "card";
-        } else if (auto *tf = dynamic_cast<TaxField*>(f)) {
-            fo["type"] = "tax";
-            fo["price"] = tf->taxAmount;
-        } else if (dynamic_cast<StartField*>(f)) {
-            fo["type"] = "start";
-        } else if (dynamic_cast<JailField*>(f)) {
-            fo["type"] = "jail";
-        } else {
-            fo["type"] = "field";
-        }
-
-        farr.append(fo);
+    for (RoomShard *shard : shards) {
+        QMetaObject::invokeMethod(shard, [shard, seed]() {
+            shard->setRoomSeed(seed);
+        }, Qt::QueuedConnection);
     }
-    state["fields"] = farr;
-
-    state["awaitingBuyDecision"] = awaitingBuyDecision;
-    state["pendingBuyPlayerId"] = pendingBuyPlayerId;
-    state["pendingBuyFieldIndex"] = pendingBuyFieldIndex;
-    state["awaitingEndTurn"] = awaitingEndTurn;
-    state["pendingEndTurnPlayerId"] = pendingEndTurnPlayerId;
-
-    return state;
 }
 
-bool GameServer::areAllPlayersReady() const
+RoomShard* GameServer::shardAt(int index) const
 {
-    if (players.empty()) {
-        return false;
-    }
-    for (const auto &p : players) {
-        if (!p || !p->isReady) {
-            return false;
-        }
-    }
-    return true;
+    return shards.value(index, nullptr);
 }
 
-void GameServer::broadcastGameState(const QString &reason)
+int GameServer::shardCount() const
 {
-    broadcast(buildGameState(reason));
+    return shards.size();
 }
 
-void GameServer::updateWinnerIfNeeded(const QString &reason)
+void GameServer::onNewConnection()
 {
-    if (gameFinished) {
-        return;
-    }
-
-    int activePlayers = 0;
-    Player *lastActive = nullptr;
-    for (const auto &p : players) {
-        if (p && !p->isBankrupt) {
-            activePlayers++;
-            lastActive = p.get();
-        }
-    }
+    while (server.hasPendingConnections()) {
+        QTcpSocket* client = server.nextPendingConnection();
+        if (!client) continue;
 
-    if (activePlayers == 1 && lastActive) {
-        gameFinished = true;
-        winnerId = lastActive->id;
-        broadcastLog(winnerId, "gewinnt das Spiel");
-        broadcastGameState(reason);
+        placeTransport(new TcpTransport(client));
     }
 }
 
-Player* GameServer::findPlayerBySocket(QTcpSocket *socket)
+void GameServer::onNewLocalConnection()
 {
-    auto it = std::find_if(players.begin(), players.end(),
-                           [&](const std::unique_ptr<Player>& p){
-                               return p && p->socket == socket;
-                           });
-    if (it == players.end()) return nullptr;
-    return it->get();
+    while (localServer.hasPendingConnections()) {
+        QLocalSocket* client = localServer.nextPendingConnection();
+        if (!client) continue;
+
+        placeTransport(new LocalTransport(client));
+    }
 }
 
-Player* GameServer::findPlayerById(int id)
+void GameServer::placeTransport(Transport *transport)
 {
-    auto it = std::find_if(players.begin(), players.end(),
-                           [&](const std::unique_ptr<Player>& p){
-                               return p && p->id == id;
-                           });
-    if (it == players.end()) return nullptr;
-    return it->get();
+    // Neue Clients landen am naechsten offenen Tisch (alte Clients
+    // kennen keine Raeume und verhalten sich damit wie bisher)
+    int roomId = -1;
+    int shardIndex = 0;
+    directory.placeNewConnection(&roomId, &shardIndex);
+
+    // Transport an den Thread des Shards uebergeben, der den Raum besitzt
+    // danach gehoert der Transport dem Shard-Thread, nicht mehr anfassen
+    const QString peer = transport->peerInfo();
+    RoomShard *shard = shards[shardIndex];
+    transport->moveToThread(shard->thread());
+    QMetaObject::invokeMethod(shard, [shard, transport, roomId]() {
+        shard->adoptTransport(transport, roomId);
+    }, Qt::QueuedConnection);
+
+    qDebug() << "[NET] Neuer Client" << peer << "-> Raum" << roomId
+             << "| shard" << shardIndex;
 }
 
-void GameServer::onClientDisconnected()
+QJsonArray GameServer::buildShardStats() const
 {
-    QTcpSocket* socket = qobject_cast<QTcpSocket*>(sender());
-    if (!socket) return;
-
-    auto it = std::find_if(players.begin(), players.end(),
-                           [&](const std::unique_ptr<Player>& p){
-                               return p && p->socket == socket;
-                           });
-
-    if (it != players.end()) {
-        qDebug() << "[NET] client disconnected:" << (*it)->name;
-
-        Player *disconnectedPlayer = it->get();
-        const bool wasCurrentPlayer = game.getCurrentPlayer() == disconnectedPlayer;
-
-        clearPendingStateForPlayer(disconnectedPlayer->id);
-        releasePlayerAssets(*disconnectedPlayer);
-        game.removePlayer(disconnectedPlayer);
-        players.erase(it);
-        updateWinnerIfNeeded("playerLeft");
-        if (!gameFinished && wasCurrentPlayer && gameStarted && game.getCurrentPlayer()) {
-            broadcastLog(0, "Aktiver Spieler getrennt, Zug geht an den naechsten Spieler");
+    QJsonArray arr;
+    for (const RoomShard *shard : shards) {
+        const ShardStats &s = shard->getStats();
+        QJsonObject o;
+        o["shard"] = shard->getIndex();
+        o["rooms"] = s.rooms.load();
+        o["connections"] = s.connections.load();
+        o["messagesIn"] = qint64(s.messagesIn.load());
+        o["bytesIn"] = qint64(s.bytesIn.load());
+        o["bytesOut"] = qint64(s.bytesOut.load());
+        o["framesEncoded"] = qint64(s.framesEncoded.load());
+        o["framesSent"] = qint64(s.framesSent.load());
+        o["socketWrites"] = qint64(s.socketWrites.load());
+        o["congestionEvents"] = qint64(s.congestionEvents.load());
+        o["stateFramesDropped"] = qint64(s.stateFramesDropped.load());
+        o["slowConsumerDisconnects"] = qint64(s.slowConsumerDisconnects.load());
+        o["pingsSent"] = qint64(s.pingsSent.load());
+        o["deadPeersEvicted"] = qint64(s.deadPeersEvicted.load());
+        o["rttAvgMs"] = s.rttAvgMs.load();
+        o["rttMaxMs"] = s.rttMaxMs.load();
+        o["sessionsSuspended"] = qint64(s.sessionsSuspended.load());
+        o["sessionsResumed"] = qint64(s.sessionsResumed.load());
+        o["sessionsExpired"] = qint64(s.sessionsExpired.load());
+        o["messagesReplayed"] = qint64(s.messagesReplayed.load());
+        o["invalidMessages"] = qint64(s.invalidMessages.load());
+        o["unknownMessages"] = qint64(s.unknownMessages.load());
+        o["oversizedFrames"] = qint64(s.oversizedFrames.load());
+
+        QJsonObject byType;
+        for (int code = 0; code < Protocol::TypeCodeLimit; ++code) {
+            const quint64 count = s.messagesByType[code].load();
+            if (count > 0) {
+                byType[Protocol::typeName(code)] = qint64(count);
+            }
         }
-        broadcastGameState("playerLeft");
+        o["messagesByType"] = byType;
+        arr.append(o);
     }
-
-    recvBuffers.remove(socket);
-    socket->deleteLater();
+    return arr;
 }
 
-
-
-
+void GameServer::logShardStats()
+{
+    for (const RoomShard *shard : shards) {
+        const ShardStats &s = shard->getStats();
+        qDebug() << "[SHARD" << shard->getIndex() << "]"
+                 << "rooms=" << s.rooms.load()
+                 << "conns=" << s.connections.load()
+                 << "msgs=" << s.messagesIn.load()
+                 << "in=" << s.bytesIn.load()
+                 << "out=" << s.bytesOut.load()
+                 << "encoded=" << s.framesEncoded.load()
+                 << "sent=" << s.framesSent.load()
+                 << "writes=" << s.socketWrites.load()
+                 << "congested=" << s.congestionEvents.load()
+                 << "stateDropped=" << s.stateFramesDropped.load()
+                 << "slowDropped=" << s.slowConsumerDisconnects.load()
+                 << "dead=" << s.deadPeersEvicted.load()
+                 << "rttAvg=" << s.rttAvgMs.load()
+                 << "rttMax=" << s.rttMaxMs.load()
+                 << "resumed=" << s.sessionsResumed.load()
+                 << "expired=" << s.sessionsExpired.load()
+                 << "replayed=" << s.messagesReplayed.load()
+                 << "invalid=" << s.invalidMessages.load()
+                 << "unknown=" << s.unknownMessages.load()
+                 << "oversized=" << s.oversizedFrames.load();
+    }
+    if (journal) {
+        qDebug() << "[JOURNAL]"
+                 << "events=" << journal->eventCount()
+                 << "commits=" << journal->commitCount()
+                 << "snapshots=" << journal->snapshotCount();
+    }
+}
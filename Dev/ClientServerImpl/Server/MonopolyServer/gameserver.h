@@ -3,89 +3,109 @@
 
 #include <QObject>
 #include <QTcpServer>
-#include <QTcpSocket>
-#include <QHash>
-#include <QJsonObject>
+#include <QLocalServer>
+#include <QJsonArray>
+#include <QThread>
+#include <QTimer>
+#include <QVector>
+#include <map>
 #include <memory>
-#include <vector>
-
-#include "game.h"
-#include "player.h"
-#include "board.h"
 
+#include "handover.h"
+#include "journal.h"
+#include "loopbacktransport.h"
+#include "roomdirectory.h"
+#include "roomshard.h"
+
+// Nimmt Verbindungen an und verteilt sie auf die Shards.
+// Jeder Shard ist ein Worker-Thread mit eigener Event-Loop, der seine
+// Raeume samt Sockets allein bedient (ein Shard je CPU-Kern).
+//
+// Backend Qt: QTcpServer im Hauptthread, QTcpSocket je Verbindung.
+// Backend Epoll (nur Linux): jeder Shard nimmt selbst an (SO_REUSEPORT)
+// und bedient seine Sockets ueber ein epoll-Set ohne QObject pro Verbindung.
+// Zusaetzlich: lokale Clients ueber Unix-Domain-Socket (listenLocal) und
+// In-Process-Clients ohne Socket (connectLoopback).
 class GameServer : public QObject
 {
     Q_OBJECT
 
 public:
-    explicit GameServer(QObject *parent = nullptr);
-    void startServer(quint16 port = 4242);
+    explicit GameServer(int shardCount = QThread::idealThreadCount(), QObject *parent = nullptr);
+    ~GameServer() override;
 
-private:
-    QTcpServer server;
+    enum class Backend { Qt, Epoll };
 
-    // newline-delimited JSON: wir puffern je Socket
-    QHash<QTcpSocket*, QByteArray> recvBuffers;
+    bool startServer(quint16 port = 4242, Backend backend = Backend::Qt);
+    static bool isBackendAvailable(Backend backend);
 
-    std::vector<std::unique_ptr<Player>> players;
-    int nextPlayerId = 1;
+    // lokaler Socket (AF_UNIX bzw. Named Pipe), z.B. fuer Bots auf demselben Rechner
+    bool listenLocal(const QString &name);
 
-    Game game;
+    // In-Process-Client: wird wie eine neue Verbindung platziert
+    std::unique_ptr<LoopbackClient> connectLoopback();
 
-    // Monopoly Board liegt beim Server
-    Board board;
-    bool boardInitialized = false;
+    // Journal in directory: Raeume aus einem frueheren Lauf wiederherstellen,
+    // danach jede Zustandsaenderung mitschreiben. Vor startServer() aufrufen.
+    bool enableJournal(const QString &directory);
 
-    // Startlogik
-    bool gameStarted = false;
+    // Binaer-Checkpoint aller Raeume (siehe checkpoint.h), alle intervalMs
+    // und beim Beenden geschrieben. Vor enableJournal() setzen: das Journal
+    // setzt dann auf dem Checkpoint auf und spielt nur den Rest nach.
+    void setCheckpoint(const QString &path, int intervalMs = 10000);
+    // ohne Journal: Raeume direkt aus dem Checkpoint wiederherstellen
+    bool restoreCheckpoint();
 
-    // Kaufen-Flow (max. 1 pending Kaufentscheidung)
-    bool awaitingBuyDecision = false;
-    int pendingBuyPlayerId = -1;
-    int pendingBuyFieldIndex = -1;
-    bool awaitingEndTurn = false;
-    int pendingEndTurnPlayerId = -1;
-    bool gameFinished = false;
-    int winnerId = -1;
+    // Hot-Restart (handover.h, nur Unix). takeOver(): Listener, Verbindungen
+    // und Raeume vom Vorgaenger unter path abholen, vor enableJournal() und
+    // startServer(); false, wenn dort keiner laeuft. listenHandover(): selbst
+    // unter path auf einen Nachfolger warten, nach der Uebergabe endet der Prozess.
+    bool takeOver(const QString &path);
+    bool listenHandover(const QString &path);
 
-private slots:
-    void onNewConnection();
-    void onReadyRead();
-    void onClientDisconnected();
+    // Heartbeat fuer alle Shards (Standard: alle 5 s, tot nach 3 Fehlversuchen)
+    void setHeartbeat(int intervalMs, int maxMissed);
+
+    // Frist fuer resume nach Verbindungsabbruch (Standard 60 s, 0 = aus)
+    void setResumeGrace(int graceMs);
+
+    // fester Seed fuer den Raum-Zufall, sonst je Raum zufaellig
+    void setRoomSeed(quint64 seed);
+
+    RoomShard* shardAt(int index) const;
+    int shardCount() const;
+    QJsonArray buildShardStats() const;
 
 private:
-    void processMessage(Player &player, const QJsonObject &msg);
-
-    // Spielablauf
-    void initBoardIfNeeded();
-    void handleStartGame(Player &player);
-    void handleRollDice(Player &player);
-    void handleEndTurn(Player &player);
-    void handleSurrender(Player &player);
-    void handleSetReady(Player &player, bool ready);
-    void handleSetName(Player &player, const QString &name);
-    void handleRestartGame(Player &player);
-    void handleBuyHouse(Player &player, int fieldIndex);
-    void askToBuy(Player &player, int fieldIndex, int price, const QString &fieldName);
-    void finishTurnAndBroadcast();
-    void updateWinnerIfNeeded(const QString &reason);
-    bool areAllPlayersReady() const;
-    void releasePlayerAssets(Player &player);
-    void clearPendingStateForPlayer(int playerId);
-
-    // JSON helpers
-    void sendToSocket(QTcpSocket *socket, const QJsonObject &obj);
-    void sendToPlayer(Player &player, const QJsonObject &obj);
-    void broadcast(const QJsonObject &obj);
-    void broadcastLog(int playerId, const QString &message);
-
-    // State
-    void broadcastGameState(const QString &reason = QString());
-    QJsonObject buildGameState(const QString &reason = QString()) const;
-
-    // Lookup
-    Player* findPlayerBySocket(QTcpSocket *socket);
-    Player* findPlayerById(int id);
+    QTcpServer server;
+    QLocalServer localServer;
+    RoomDirectory directory;
+    int nextLoopbackId = 1;
+    std::unique_ptr<GameJournal> journal;
+    QString checkpointPath;
+    QTimer checkpointTimer;
+    QLocalServer handoverServer;
+    std::unique_ptr<Handover::State> takenOver; // bis startServer()
+
+    QVector<QThread*> threads;
+    QVector<RoomShard*> shards;
+
+    QTimer statsTimer;
+
+    // neue Verbindung platzieren und an den Thread des Shards uebergeben
+    void placeTransport(Transport *transport);
+
+    std::map<int, RoomRestore> loadCheckpointRooms() const;
+    // Raeume mit alter ID anlegen und fuellen, liefert die Anzahl behaltener
+    int restoreRooms(const std::map<int, RoomRestore> &restore);
+    void finishTakeOver();
+
+private slots:
+    void onNewConnection();
+    void onNewLocalConnection();
+    void onHandoverRequest();
+    void logShardStats();
+    bool writeCheckpoint();
 };
 
 #endif // GAMESERVER_H
@@ -0,0 +1,388 @@
+#include "handover.h"
+
+#include <QDir>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QtEndian>
+#include <cstring>
+
+#ifdef Q_OS_UNIX
+#include <cerrno>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+constexpr char magic[8] = {'M', 'N', 'P', 'L', 'H', 'O', 'V', '1'};
+constexpr quint32 formatVersion = 2;
+constexpr int headerSize = 28;
+constexpr quint32 flagReusePort = 1;
+constexpr int ioTimeoutMs = 10000;
+
+// unter SCM_MAX_FD (253 unter Linux)
+constexpr int fdsPerMessage = 200;
+
+// oberhalb dieser Groesse ist es kein Zustand von uns
+constexpr quint32 maxJsonBytes = 512 * 1024 * 1024;
+
+#ifdef Q_OS_UNIX
+
+#ifdef MSG_NOSIGNAL
+constexpr int sendFlags = MSG_NOSIGNAL;
+#else
+constexpr int sendFlags = 0;
+#endif
+
+#ifdef MSG_CMSG_CLOEXEC
+constexpr int recvFlags = MSG_CMSG_CLOEXEC;
+#else
+constexpr int recvFlags = 0;
+#endif
+
+bool waitFor(int socket, short events, int timeoutMs)
+{
+    pollfd p = {};
+    p.fd = socket;
+    p.events = events;
+    int ready = 0;
+    do {
+        ready = ::poll(&p, 1, timeoutMs);
+    } while (ready < 0 && errno == EINTR);
+    return ready > 0;
+}
+
+// der Socket des Vorgaengers kommt aus QLocalServer und ist nicht blockierend
+bool writeAll(int socket, const char *data, qint64 size)
+{
+    while (size > 0) {
+        const ssize_t n = ::send(socket, data, size_t(size), sendFlags);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            if ((errno == EAGAIN || errno == EWOULDBLOCK) && waitFor(socket, POLLOUT, ioTimeoutMs)) continue;
+            return false;
+        }
+        data += n;
+        size -= n;
+    }
+    return true;
+}
+
+bool readAll(int socket, char *data, qint64 size, int timeoutMs)
+{
+    while (size > 0) {
+        if (!waitFor(socket, POLLIN, timeoutMs)) return false;
+        const ssize_t n = ::recv(socket, data, size_t(size), 0);
+        if (n < 0) {
+            if (errno == EINTR || errno == EAGAIN || errno == EWOULDBLOCK) continue;
+            return false;
+        }
+        if (n == 0) return false; // Gegenseite weg
+        data += n;
+        size -= n;
+    }
+    return true;
+}
+
+bool sendDescriptors(int socket, const int *fds, int count)
+{
+    char byte = 'F';
+    iovec iov = {};
+    iov.iov_base = &byte;
+    iov.iov_len = 1;
+
+    alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int) * fdsPerMessage)];
+    std::memset(control, 0, sizeof(control));
+    msghdr msg = {};
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control;
+    msg.msg_controllen = CMSG_SPACE(sizeof(int) * size_t(count));
+
+    cmsghdr *cmsg = CMSG_FIRSTHDR(&msg);
+    cmsg->cmsg_level = SOL_SOCKET;
+    cmsg->cmsg_type = SCM_RIGHTS;
+    cmsg->cmsg_len = CMSG_LEN(sizeof(int) * size_t(count));
+    std::memcpy(CMSG_DATA(cmsg), fds, sizeof(int) * size_t(count));
+
+    while (true) {
+        const ssize_t n = ::sendmsg(socket, &msg, sendFlags);
+        if (n == 1) return true;
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK) && waitFor(socket, POLLOUT, ioTimeoutMs)) continue;
+        return false;
+    }
+}
+
+bool receiveDescriptors(int socket, int *fds, int count)
+{
+    char byte = 0;
+    iovec iov = {};
+    iov.iov_base = &byte;
+    iov.iov_len = 1;
+
+    alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int) * fdsPerMessage)];
+    std::memset(control, 0, sizeof(control));
+    msghdr msg = {};
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control;
+    msg.msg_controllen = sizeof(control);
+
+    ssize_t n = -1;
+    while (true) {
+        if (!waitFor(socket, POLLIN, ioTimeoutMs)) return false;
+        n = ::recvmsg(socket, &msg, recvFlags);
+        if (n < 0 && (errno == EINTR || errno == EAGAIN || errno == EWOULDBLOCK)) continue;
+        break;
+    }
+    if (n != 1) return false;
+
+    int received = 0;
+    for (cmsghdr *cmsg = CMSG_FIRSTHDR(&msg); cmsg; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+        if (cmsg->cmsg_level != SOL_SOCKET || cmsg->cmsg_type != SCM_RIGHTS) continue;
+        const int inMessage = int((cmsg->cmsg_len - CMSG_LEN(0)) / sizeof(int));
+        const int take = qMin(inMessage, count - received);
+        std::memcpy(fds + received, CMSG_DATA(cmsg), sizeof(int) * size_t(take));
+        // mehr als angekuendigt: nicht einfach offen lassen
+        for (int i = take; i < inMessage; ++i) {
+            int extra = -1;
+            std::memcpy(&extra, CMSG_DATA(cmsg) + sizeof(int) * size_t(i), sizeof(int));
+            ::close(extra);
+        }
+        received += take;
+    }
+    return received == count && !(msg.msg_flags & MSG_CTRUNC);
+}
+
+#endif // Q_OS_UNIX
+
+} // namespace
+
+bool Handover::isSupported()
+{
+#ifdef Q_OS_UNIX
+    return true;
+#else
+    return false;
+#endif
+}
+
+int Handover::connectTo(const QString &path, QString *error)
+{
+#ifdef Q_OS_UNIX
+    const QString full = QDir::isAbsolutePath(path) ? path : QDir(QDir::tempPath()).filePath(path);
+    const QByteArray encoded = QFile::encodeName(full);
+
+    sockaddr_un address = {};
+    address.sun_family = AF_UNIX;
+    if (size_t(encoded.size()) >= sizeof(address.sun_path)) {
+        *error = QString("Pfad zu lang: %1").arg(full);
+        return -1;
+    }
+    std::memcpy(address.sun_path, encoded.constData(), size_t(encoded.size()));
+
+    const int socket = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (socket < 0) {
+        *error = QString("socket: %1").arg(QString::fromLocal8Bit(std::strerror(errno)));
+        return -1;
+    }
+    if (::connect(socket, reinterpret_cast<const sockaddr *>(&address), sizeof(address)) != 0) {
+        *error = errno == ENOENT || errno == ECONNREFUSED
+                ? QString("kein laufender Server unter %1").arg(full)
+                : QString("%1: %2").arg(full, QString::fromLocal8Bit(std::strerror(errno)));
+        ::close(socket);
+        return -1;
+    }
+    return socket;
+#else
+    *error = QString("Hot-Restart nur unter Unix (%1)").arg(path);
+    return -1;
+#endif
+}
+
+bool Handover::send(int socket, const State &state, QString *error)
+{
+#ifdef Q_OS_UNIX
+    QJsonArray rooms;
+    QVector<int> fds = state.listenerFds;
+    for (const RoomRestore &restore : state.rooms) {
+        QJsonObject room = restore.state.toJson();
+        QJsonArray connections;
+        for (const ConnectionState &connection : restore.connections) {
+            connections.append(connection.toJson());
+            fds.append(connection.fd);
+        }
+        room["connections"] = connections;
+        rooms.append(room);
+    }
+    QJsonObject doc;
+    doc["rooms"] = rooms;
+    const QByteArray json = QJsonDocument(doc).toJson(QJsonDocument::Compact);
+
+    char header[headerSize];
+    std::memcpy(header, magic, sizeof(magic));
+    qToLittleEndian<quint32>(formatVersion, header + 8);
+    qToLittleEndian<quint32>(quint32(json.size()), header + 12);
+    qToLittleEndian<quint32>(quint32(fds.size()), header + 16);
+    qToLittleEndian<quint32>(state.reusePort ? flagReusePort : 0, header + 20);
+    qToLittleEndian<quint32>(quint32(state.listenerFds.size()), header + 24);
+
+    if (!writeAll(socket, header, headerSize) || !writeAll(socket, json.constData(), json.size())) {
+        *error = "Zustand nicht gesendet";
+        return false;
+    }
+    for (int i = 0; i < fds.size(); i += fdsPerMessage) {
+        if (!sendDescriptors(socket, fds.constData() + i, qMin(fdsPerMessage, int(fds.size()) - i))) {
+            *error = QString("Deskriptoren ab %1 nicht gesendet").arg(i);
+            return false;
+        }
+    }
+    return true;
+#else
+    Q_UNUSED(socket);
+    Q_UNUSED(state);
+    *error = "Hot-Restart nur unter Unix";
+    return false;
+#endif
+}
+
+bool Handover::receive(int socket, State *state, QString *error)
+{
+#ifdef Q_OS_UNIX
+    char header[headerSize];
+    if (!readAll(socket, header, headerSize, ackTimeoutMs)) {
+        *error = "kein Header vom Vorgaenger";
+        return false;
+    }
+    if (std::memcmp(header, magic, sizeof(magic)) != 0
+        || qFromLittleEndian<quint32>(header + 8) != formatVersion) {
+        *error = "Vorgaenger spricht ein anderes Uebergabeformat";
+        return false;
+    }
+    const quint32 jsonBytes = qFromLittleEndian<quint32>(header + 12);
+    const quint32 fdCount = qFromLittleEndian<quint32>(header + 16);
+    const bool reusePort = qFromLittleEndian<quint32>(header + 20) & flagReusePort;
+    const quint32 listenerCount = qFromLittleEndian<quint32>(header + 24);
+    if (jsonBytes > maxJsonBytes) {
+        *error = QString("Zustand zu gross (%1 Byte)").arg(jsonBytes);
+        return false;
+    }
+    if (listenerCount > fdCount) {
+        *error = QString("%1 Listener bei %2 Deskriptoren").arg(listenerCount).arg(fdCount);
+        return false;
+    }
+
+    QByteArray json(qsizetype(jsonBytes), Qt::Uninitialized);
+    if (!readAll(socket, json.data(), json.size(), ioTimeoutMs)) {
+        *error = "Zustand unvollstaendig";
+        return false;
+    }
+    const QJsonObject doc = QJsonDocument::fromJson(json).object();
+
+    QVector<int> fds(int(fdCount), -1);
+    for (int i = 0; i < fds.size(); i += fdsPerMessage) {
+        if (!receiveDescriptors(socket, fds.data() + i, qMin(fdsPerMessage, int(fds.size()) - i))) {
+            for (int fd : fds) {
+                closeDescriptor(fd);
+            }
+            *error = QString("Deskriptoren ab %1 nicht empfangen").arg(i);
+            return false;
+        }
+    }
+
+    // Deskriptoren in der Reihenfolge der Verbindungen zuordnen
+    int next = 0;
+    state->listenerFds.clear();
+    state->reusePort = reusePort;
+    while (next < int(listenerCount)) {
+        state->listenerFds.append(fds.value(next++, -1));
+    }
+    state->rooms.clear();
+    for (const QJsonValue &value : doc.value("rooms").toArray()) {
+        const QJsonObject room = value.toObject();
+        RoomRestore restore;
+        restore.state = RoomState::fromJson(room);
+        for (const QJsonValue &c : room.value("connections").toArray()) {
+            ConnectionState connection = ConnectionState::fromJson(c.toObject());
+            connection.fd = fds.value(next++, -1);
+            restore.connections.append(connection);
+        }
+        state->rooms.append(restore);
+    }
+    if (next != fds.size()) {
+        closeConnections(*state);
+        closeListeners(*state);
+        for (int i = next; i < fds.size(); ++i) {
+            closeDescriptor(fds[i]);
+        }
+        *error = QString("%1 Deskriptoren fuer %2 Verbindungen").arg(fds.size()).arg(next);
+        return false;
+    }
+    return true;
+#else
+    Q_UNUSED(socket);
+    Q_UNUSED(state);
+    *error = "Hot-Restart nur unter Unix";
+    return false;
+#endif
+}
+
+bool Handover::acknowledge(int socket, QString *error)
+{
+#ifdef Q_OS_UNIX
+    const char ack = 'A';
+    if (writeAll(socket, &ack, 1)) return true;
+    *error = "Bestaetigung nicht gesendet";
+    return false;
+#else
+    Q_UNUSED(socket);
+    *error = "Hot-Restart nur unter Unix";
+    return false;
+#endif
+}
+
+bool Handover::waitForAcknowledge(int socket, int timeoutMs, QString *error)
+{
+#ifdef Q_OS_UNIX
+    char ack = 0;
+    if (readAll(socket, &ack, 1, timeoutMs) && ack == 'A') return true;
+    *error = "keine Bestaetigung der Gegenseite";
+    return false;
+#else
+    Q_UNUSED(socket);
+    Q_UNUSED(timeoutMs);
+    *error = "Hot-Restart nur unter Unix";
+    return false;
+#endif
+}
+
+void Handover::closeDescriptor(int fd)
+{
+#ifdef Q_OS_UNIX
+    if (fd >= 0) {
+        ::close(fd);
+    }
+#else
+    Q_UNUSED(fd);
+#endif
+}
+
+void Handover::closeConnections(const State &state)
+{
+    for (const RoomRestore &restore : state.rooms) {
+        for (const ConnectionState &connection : restore.connections) {
+            closeDescriptor(connection.fd);
+        }
+    }
+}
+
+void Handover::closeListeners(const State &state)
+{
+    for (int fd : state.listenerFds) {
+        closeDescriptor(fd);
+    }
+}
@@ -0,0 +1,54 @@
+#ifndef HANDOVER_H
+#define HANDOVER_H
+
+#include <QString>
+#include <QVector>
+
+#include "roomstate.h"
+
+// Hot-Restart ohne Verbindungsabbruch (nur Unix): ein laufender Server
+// uebergibt Listener, Client-Sockets und alle Raeume an ein neues Binary.
+//
+// Der alte Prozess wartet auf einem Unix-Domain-Socket auf seinen
+// Nachfolger. Meldet der sich, nimmt der alte nichts mehr an, liest nichts
+// mehr, leert seine Ausgangspuffer, schliesst das Journal und schickt
+//   Header  magic "MNPLHOV1", Laenge des JSON, Anzahl Deskriptoren,
+//           Anzahl Listener
+//   JSON    Raeume wie im Snapshot, je Raum die Verbindungen (roomstate.h)
+//   fds     Listener (falls vorhanden) und Client-Sockets per SCM_RIGHTS,
+//           je Nachricht ein Byte mit bis zu fdsPerMessage Deskriptoren
+// Danach zweiseitige Bestaetigung: der Nachfolger meldet "alles da", der
+// alte antwortet "uebernimm" und beendet sich. Bleibt die erste aus,
+// nimmt der alte seine Verbindungen zurueck und laeuft weiter; bleibt die
+// zweite aus, gibt der Nachfolger auf.
+namespace Handover
+{
+    struct State {
+        QVector<RoomRestore> rooms; // ohne events
+        QVector<int> listenerFds;   // TCP-Listener: einer (Qt) bzw. je Shard einer (epoll)
+        bool reusePort = false;     // Listener mit SO_REUSEPORT (epoll-Backend)
+    };
+
+    constexpr int drainTimeoutMs = 5000;
+    constexpr int ackTimeoutMs = 30000;
+
+    bool isSupported();
+
+    // Nachfolger: verbindet sich mit dem Vorgaenger unter path
+    // (relativ = im Temp-Verzeichnis wie bei QLocalServer), -1 wenn keiner da ist
+    int connectTo(const QString &path, QString *error);
+
+    bool send(int socket, const State &state, QString *error);
+    bool receive(int socket, State *state, QString *error);
+
+    // ein Byte Bestaetigung in jede Richtung
+    bool acknowledge(int socket, QString *error);
+    bool waitForAcknowledge(int socket, int timeoutMs, QString *error);
+
+    void closeDescriptor(int fd);
+    // Client-Sockets in state schliessen (die Listener gehoeren dem Aufrufer)
+    void closeConnections(const State &state);
+    void closeListeners(const State &state);
+}
+
+#endif // HANDOVER_H
@@ -0,0 +1,155 @@
+// Headless-Lauf ueber LoopbackHarness: kompletter Nachrichtenpfad ohne
+// Sockets, Ausgaben nur gezaehlt.
+//
+//   1. Verbinden: N Clients, bis jeder seine Begruessung hat
+//   2. Durchsatz: je Client M Anfragen (setWireFormat mit rid) am Stueck
+//   3. Spiel:     alle bereit, dann T Runden autoTurn von jedem Client
+//                 (nur der Spieler am Zug spielt, die anderen bekommen nack)
+//
+// Jede Anfrage traegt eine rid und wird genau einmal mit ack/nack
+// beantwortet, daran erkennt der Lauf das Ende jeder Phase.
+//
+// Aufruf: MonopolyHarness [--clients N] [--requests M] [--turns T] [--shards S]
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QJsonObject>
+#include <QLoggingCategory>
+#include <QStringList>
+#include <QThread>
+#include <QDebug>
+
+#include "gameserver.h"
+#include "loopbackharness.h"
+
+#include <algorithm>
+#include <cstdio>
+
+namespace {
+
+int argValue(const QStringList &args, const QString &name, int fallback)
+{
+    const int at = args.indexOf(name);
+    return at >= 0 && at + 1 < args.size() ? args.at(at + 1).toInt() : fallback;
+}
+
+void printPhase(const char *name, quint64 requests, quint64 frames, qint64 nsecs)
+{
+    const double seconds = double(std::max<qint64>(nsecs, 1)) / 1e9;
+    std::printf("%-8s requests=%llu frames=%llu %.1fms  %.0f req/s  %.0f msg/s (ein+aus)\n",
+                name, static_cast<unsigned long long>(requests),
+                static_cast<unsigned long long>(frames), seconds * 1000.0,
+                double(requests) / seconds, double(requests + frames) / seconds);
+}
+
+// wartet, bis insgesamt expected ack/nack da sind
+bool waitForReplies(LoopbackHarness &harness, quint64 expected)
+{
+    return harness.waitUntil([&harness, expected]() {
+        return harness.totalRepliesReceived() >= expected;
+    }, 120000);
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    const QStringList args = app.arguments();
+    const int clientCount = std::max(4, argValue(args, "--clients", 1000));
+    const int requests = std::max(1, argValue(args, "--requests", 1000));
+    const int turns = std::max(0, argValue(args, "--turns", 50));
+    const int shardCount = std::max(1, argValue(args, "--shards", QThread::idealThreadCount()));
+
+    // Protokoll-Logs pro Nachricht wuerden die Messung dominieren
+    QLoggingCategory::setFilterRules("default.debug=false");
+
+    GameServer server(shardCount);
+    // --seed <n>: reproduzierbare Wuerfe fuer Vergleichslaeufe
+    const int seed = args.indexOf("--seed");
+    if (seed >= 0) {
+        server.setRoomSeed(args.value(seed + 1).toULongLong());
+    }
+    LoopbackHarness harness(server, LoopbackHarness::Capture::Count);
+
+    // 1. Verbinden
+    QElapsedTimer timer;
+    timer.start();
+    harness.addClients(clientCount);
+    const bool connected = harness.waitUntil([&harness]() {
+        for (int i = 0; i < harness.clientCount(); ++i) {
+            if (harness.framesReceived(i) == 0) return false;
+        }
+        return true;
+    }, 60000);
+    if (!connected) {
+        std::printf("connect  fehlgeschlagen\n");
+        return 1;
+    }
+    std::printf("connect  clients=%d shards=%d %.1fms\n",
+                clientCount, shardCount, double(timer.nsecsElapsed()) / 1e6);
+
+    // 2. Durchsatz: ein Puffer mit M Frames, fuer alle Clients geteilt
+    QByteArray batch;
+    for (int i = 0; i < requests; ++i) {
+        QJsonObject msg;
+        msg["type"] = "setWireFormat";
+        msg["format"] = "json";
+        msg["rid"] = i;
+        batch += Protocol::encode(msg, Protocol::WireFormat::Json);
+    }
+    quint64 expected = harness.totalRepliesReceived();
+    quint64 framesBefore = harness.totalFramesReceived();
+    timer.restart();
+    for (int i = 0; i < clientCount; ++i) {
+        harness.sendFrame(i, batch);
+    }
+    expected += quint64(clientCount) * quint64(requests);
+    if (!waitForReplies(harness, expected)) {
+        std::printf("echo     fehlgeschlagen (%llu/%llu Antworten)\n",
+                    static_cast<unsigned long long>(harness.totalRepliesReceived()),
+                    static_cast<unsigned long long>(expected));
+        return 1;
+    }
+    printPhase("echo", quint64(clientCount) * quint64(requests),
+               harness.totalFramesReceived() - framesBefore, timer.nsecsElapsed());
+
+    // 3. Spiel: volle Tische starten, sobald alle bereit sind
+    int rid = 0;
+    framesBefore = harness.totalFramesReceived();
+    timer.restart();
+    for (int i = 0; i < clientCount; ++i) {
+        QJsonObject ready;
+        ready["type"] = "setReady";
+        ready["ready"] = true;
+        ready["rid"] = ++rid;
+        harness.send(i, ready);
+    }
+    expected += quint64(clientCount);
+    bool ok = waitForReplies(harness, expected);
+
+    for (int turn = 0; ok && turn < turns; ++turn) {
+        for (int i = 0; i < clientCount; ++i) {
+            QJsonObject autoTurn;
+            autoTurn["type"] = "autoTurn";
+            autoTurn["buyPolicy"] = "always";
+            autoTurn["rid"] = ++rid;
+            harness.send(i, autoTurn);
+        }
+        expected += quint64(clientCount);
+        ok = waitForReplies(harness, expected);
+    }
+    if (!ok) {
+        std::printf("game     fehlgeschlagen (%llu/%llu Antworten)\n",
+                    static_cast<unsigned long long>(harness.totalRepliesReceived()),
+                    static_cast<unsigned long long>(expected));
+        return 1;
+    }
+    printPhase("game", quint64(clientCount) * quint64(turns + 1),
+               harness.totalFramesReceived() - framesBefore, timer.nsecsElapsed());
+
+    std::printf("total    frames=%llu bytes=%llu\n",
+                static_cast<unsigned long long>(harness.totalFramesReceived()),
+                static_cast<unsigned long long>(harness.totalBytesReceived()));
+    return 0;
+}
@@ -0,0 +1,228 @@
+// Ein Spielanfang ueber LoopbackHarness mit dekodierten Antworten:
+// hello -> welcome, setReady bis zum Start, dann rollDice vom Spieler am Zug
+// (turnResult vor dem ack mit seiner rid) und vom anderen Spieler (nack).
+
+#include <QJsonArray>
+#include <QLoggingCategory>
+#include <QStringList>
+#include <QtTest>
+#include <functional>
+#include <memory>
+
+#include "gameserver.h"
+#include "loopbackharness.h"
+
+namespace {
+
+QJsonObject request(const QString &type, int rid)
+{
+    return {{"type", type}, {"rid", rid}};
+}
+
+bool isReply(const QJsonObject &msg, const QString &type, int rid)
+{
+    return msg.value("type").toString() == type && msg.value("rid").toInt() == rid;
+}
+
+} // namespace
+
+class HarnessTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void init();
+    void cleanup();
+
+    void helloGetsWelcome();
+    void readyStartsGame();
+    void rollDiceOnTurn();
+    void rollDiceOutOfTurn();
+
+private:
+    std::unique_ptr<GameServer> server;
+    std::unique_ptr<LoopbackHarness> harness;
+    QVector<QVector<QJsonObject>> inbox;
+    QVector<int> playerIds;
+
+    // erste passende Nachricht von client; sie und alles davor fallen weg
+    QJsonObject waitFor(int client, const std::function<bool(const QJsonObject &)> &match);
+    QJsonObject waitForReply(int client, const QString &type, int rid);
+    void hello(int client);
+    // beide bereit, liefert den Index des Clients am Zug
+    int startGame();
+};
+
+void HarnessTest::initTestCase()
+{
+    QLoggingCategory::setFilterRules("default.debug=false");
+}
+
+void HarnessTest::init()
+{
+    server = std::make_unique<GameServer>(1);
+    server->setRoomSeed(7);
+    harness = std::make_unique<LoopbackHarness>(*server, LoopbackHarness::Capture::Messages);
+    harness->addClients(2);
+    inbox = QVector<QVector<QJsonObject>>(2);
+    playerIds = QVector<int>(2, -1);
+}
+
+void HarnessTest::cleanup()
+{
+    harness.reset();
+    server.reset();
+}
+
+QJsonObject HarnessTest::waitFor(int client, const std::function<bool(const QJsonObject &)> &match)
+{
+    QVector<QJsonObject> &messages = inbox[client];
+    QJsonObject found;
+    harness->waitUntil([&]() {
+        messages += harness->takeMessages(client);
+        for (int i = 0; i < messages.size(); ++i) {
+            if (match(messages.at(i))) {
+                found = messages.at(i);
+                messages.remove(0, i + 1);
+                return true;
+            }
+        }
+        return false;
+    }, 5000);
+    return found;
+}
+
+QJsonObject HarnessTest::waitForReply(int client, const QString &type, int rid)
+{
+    return waitFor(client, [&](const QJsonObject &msg) { return isReply(msg, type, rid); });
+}
+
+void HarnessTest::hello(int client)
+{
+    QJsonObject msg = request("hello", 1);
+    msg["protocolVersion"] = Protocol::Version;
+    msg["caps"] = QJsonArray{Protocol::CapTurnResult, Protocol::CapRequestIds};
+    harness->send(client, msg);
+
+    const QJsonObject welcome = waitFor(client, [](const QJsonObject &m) {
+        return m.value("type").toString() == "welcome";
+    });
+    QVERIFY2(!welcome.isEmpty(), "kein welcome");
+    playerIds[client] = welcome.value("playerId").toInt(-1);
+
+    const QJsonObject ack = waitForReply(client, "ack", 1);
+    QVERIFY2(!ack.isEmpty(), "kein ack auf hello");
+    QCOMPARE(ack.value("requestType").toString(), QString("hello"));
+}
+
+int HarnessTest::startGame()
+{
+    for (int client = 0; client < 2; ++client) {
+        hello(client);
+        if (QTest::currentTestFailed()) return -1;
+        QJsonObject ready = request("setReady", 2);
+        ready["ready"] = true;
+        harness->send(client, ready);
+    }
+    for (int client = 0; client < 2; ++client) {
+        if (waitForReply(client, "ack", 2).isEmpty()) return -1;
+    }
+
+    const QJsonObject state = waitFor(0, [](const QJsonObject &m) {
+        return m.value("type").toString() == "state" && m.value("gameStarted").toBool();
+    });
+    return playerIds.indexOf(state.value("currentPlayerId").toInt(-1));
+}
+
+void HarnessTest::helloGetsWelcome()
+{
+    QJsonObject msg = request("hello", 1);
+    msg["protocolVersion"] = Protocol::Version;
+    msg["caps"] = QJsonArray{Protocol::CapTurnResult, Protocol::CapRequestIds, "unbekannt"};
+    harness->send(0, msg);
+
+    const QJsonObject welcome = waitFor(0, [](const QJsonObject &m) {
+        return m.value("type").toString() == "welcome";
+    });
+    QVERIFY2(!welcome.isEmpty(), "kein welcome");
+    QCOMPARE(welcome.value("protocolVersion").toInt(), Protocol::Version);
+    QVERIFY(welcome.value("playerId").toInt() > 0);
+    QVERIFY(welcome.value("roomId").toInt() > 0);
+
+    QStringList caps;
+    for (const QJsonValue &v : welcome.value("caps").toArray()) {
+        caps.append(v.toString());
+    }
+    QVERIFY(caps.contains(Protocol::CapTurnResult));
+    QVERIFY(caps.contains(Protocol::CapRequestIds));
+    QVERIFY(!caps.contains("unbekannt"));
+    QVERIFY(!caps.contains(Protocol::CapCbor));
+
+    const QJsonObject ack = waitForReply(0, "ack", 1);
+    QVERIFY2(!ack.isEmpty(), "kein ack auf hello");
+    QCOMPARE(ack.value("requestType").toString(), QString("hello"));
+}
+
+void HarnessTest::readyStartsGame()
+{
+    const int current = startGame();
+    QVERIFY2(current >= 0, "Spiel nicht gestartet");
+    QVERIFY(playerIds.at(0) != playerIds.at(1));
+}
+
+void HarnessTest::rollDiceOnTurn()
+{
+    const int current = startGame();
+    QVERIFY2(current >= 0, "Spiel nicht gestartet");
+    const int other = 1 - current;
+
+    harness->send(current, request("rollDice", 3));
+
+    // turnResult kommt vor dem ack derselben Anfrage
+    const QJsonObject result = waitFor(current, [](const QJsonObject &m) {
+        return m.value("type").toString() == "turnResult";
+    });
+    QVERIFY2(!result.isEmpty(), "kein turnResult");
+    QCOMPARE(result.value("playerId").toInt(), playerIds.at(current));
+    const QJsonObject dice = result.value("dice").toObject();
+    QVERIFY(dice.value("d1").toInt() >= 1 && dice.value("d1").toInt() <= 6);
+    QVERIFY(dice.value("d2").toInt() >= 1 && dice.value("d2").toInt() <= 6);
+    QVERIFY(result.contains("state"));
+
+    const QJsonObject ack = waitForReply(current, "ack", 3);
+    QVERIFY2(!ack.isEmpty(), "kein ack auf rollDice");
+    QCOMPARE(ack.value("requestType").toString(), QString("rollDice"));
+
+    // der andere Spieler sieht denselben Zug, aber kein ack
+    const QJsonObject seen = waitFor(other, [](const QJsonObject &m) {
+        return m.value("type").toString() == "turnResult";
+    });
+    QCOMPARE(seen.value("playerId").toInt(), playerIds.at(current));
+    QCOMPARE(seen.value("dice").toObject(), dice);
+    inbox[other] += harness->takeMessages(other);
+    for (const QJsonObject &m : inbox.at(other)) {
+        QVERIFY(!isReply(m, "ack", 3));
+    }
+}
+
+void HarnessTest::rollDiceOutOfTurn()
+{
+    const int current = startGame();
+    QVERIFY2(current >= 0, "Spiel nicht gestartet");
+    const int other = 1 - current;
+
+    harness->send(other, request("rollDice", 3));
+
+    const QJsonObject nack = waitForReply(other, "nack", 3);
+    QVERIFY2(!nack.isEmpty(), "kein nack fuer den Spieler, der nicht dran ist");
+    QCOMPARE(nack.value("requestType").toString(), QString("rollDice"));
+    QVERIFY(!nack.value("message").toString().isEmpty());
+
+    // kein Zug ausgefuehrt: der Spieler am Zug darf weiter wuerfeln
+    harness->send(current, request("rollDice", 4));
+    QVERIFY2(!waitForReply(current, "ack", 4).isEmpty(), "kein ack nach dem nack");
+}
+
+QTEST_GUILESS_MAIN(HarnessTest)
+#include "harnesstest.moc"
@@ -1,7 +0,0 @@
-#include "jailfield.h"
-#include "player.h"
-
-void JailField::onLand(Player& player) {
-    Q_UNUSED(player);
-    // "Nur zu Besuch" → keine Aktion
-}
@@ -1,7 +0,0 @@
-#pragma once
-#include "field.h"
-
-class JailField : public Field {
-public:
-    void onLand(Player& player) override;
-};
@@ -0,0 +1,406 @@
+#include "journal.h"
+
+#include <QDir>
+#include <QJsonDocument>
+#include <QJsonParseError>
+#include <QMutexLocker>
+#include <QSaveFile>
+#include <QThread>
+#include <QDebug>
+#include <map>
+
+#ifdef Q_OS_WIN
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace {
+
+// QFile::flush() landet nur im Page-Cache
+bool syncFile(QFile &file)
+{
+    if (!file.flush()) return false;
+#ifdef Q_OS_WIN
+    return _commit(file.handle()) == 0;
+#else
+    return ::fsync(file.handle()) == 0;
+#endif
+}
+
+} // namespace
+
+GameJournal::GameJournal(const QString &directory)
+    : dir(directory)
+{
+}
+
+GameJournal::~GameJournal()
+{
+    close();
+}
+
+QString GameJournal::directory() const
+{
+    return dir;
+}
+
+QVector<GameJournal::RoomLog> GameJournal::recover(int *maxRoomId)
+{
+    QDir d(dir);
+    int maxId = 0;
+    std::map<int, RoomLog> logs;
+    QSet<int> closed; // geschlossen (evtl. mit neuen Ereignissen danach)
+
+    // Segmente in Schreibreihenfolge (Index ist mit Nullen aufgefuellt)
+    const QStringList names = d.entryList({"journal-*.log"}, QDir::Files, QDir::Name);
+    for (const QString &name : names) {
+        QFile file(d.filePath(name));
+        if (!file.open(QIODevice::ReadOnly)) {
+            qWarning() << "[JOURNAL]" << name << "nicht lesbar:" << file.errorString();
+            continue;
+        }
+
+        Segment segment;
+        segment.index = name.mid(8, 6).toInt();
+        segment.bytes = file.size();
+        int lines = 0;
+        while (!file.atEnd()) {
+            const QByteArray line = file.readLine();
+            QJsonParseError error;
+            const QJsonDocument doc = QJsonDocument::fromJson(line, &error);
+            if (error.error != QJsonParseError::NoError || !doc.isObject()) {
+                // abgerissene letzte Zeile nach einem Absturz
+                qWarning() << "[JOURNAL]" << name << "endet unvollstaendig nach" << lines << "Zeilen";
+                break;
+            }
+            lines++;
+
+            const QJsonObject event = doc.object();
+            const int roomId = event.value("r").toInt();
+            maxId = qMax(maxId, roomId);
+            if (event.value("e").toString() == "close") {
+                logs.erase(roomId);
+                closed.insert(roomId);
+                continue;
+            }
+            segment.lastSeq[roomId] = quint64(event.value("s").toDouble());
+            RoomLog &log = logs[roomId];
+            log.roomId = roomId;
+            log.events.append(event);
+        }
+        segments.append(segment);
+        nextSegment = qMax(nextSegment, segment.index + 1);
+    }
+
+    const QStringList snaps = d.entryList({"room-*.json"}, QDir::Files, QDir::Name);
+    for (const QString &name : snaps) {
+        QFile file(d.filePath(name));
+        if (!file.open(QIODevice::ReadOnly)) continue;
+        const QJsonObject image = QJsonDocument::fromJson(file.readAll()).object();
+        const int roomId = image.value("roomId").toInt();
+        if (image.isEmpty() || roomId <= 0) {
+            qWarning() << "[JOURNAL] Snapshot" << name << "unbrauchbar";
+            continue;
+        }
+        maxId = qMax(maxId, roomId);
+
+        // nach dem Schliessen gilt der alte Snapshot nicht mehr; ein wieder
+        // geoeffneter Raum hat seine ganze Geschichte noch im Log
+        if (closed.contains(roomId)) continue;
+
+        const quint64 seq = quint64(image.value("seq").toDouble());
+        RoomLog &log = logs[roomId];
+        log.roomId = roomId;
+        log.snapshot = image;
+        QVector<QJsonObject> newer;
+        for (const QJsonObject &event : log.events) {
+            if (quint64(event.value("s").toDouble()) > seq) {
+                newer.append(event);
+            }
+        }
+        log.events = newer;
+        snapshotSeq.insert(roomId, seq);
+    }
+
+    // Raeume, die nicht wiederkommen, halten keine Segmente fest
+    for (const Segment &segment : segments) {
+        for (auto it = segment.lastSeq.constBegin(); it != segment.lastSeq.constEnd(); ++it) {
+            if (logs.find(it.key()) == logs.end()) {
+                dropped.insert(it.key());
+            }
+        }
+    }
+
+    QVector<RoomLog> result;
+    int events = 0;
+    for (auto &entry : logs) {
+        events += entry.second.events.size();
+        result.append(std::move(entry.second));
+    }
+    qDebug() << "[JOURNAL] wiederhergestellt: rooms=" << result.size()
+             << "events=" << events << "segments=" << segments.size();
+
+    if (maxRoomId) {
+        *maxRoomId = maxId;
+    }
+    return result;
+}
+
+bool GameJournal::open()
+{
+    if (writer) return true;
+    if (!QDir().mkpath(dir)) {
+        qWarning() << "[JOURNAL] Verzeichnis" << dir << "nicht anlegbar";
+        return false;
+    }
+    if (!startSegment()) {
+        return false;
+    }
+
+    stopping = false;
+    writer = QThread::create([this]() { run(); });
+    writer->setObjectName("journal");
+    writer->start();
+    qDebug() << "[JOURNAL] schreibt nach" << dir;
+    return true;
+}
+
+void GameJournal::close()
+{
+    if (!writer) return;
+    {
+        QMutexLocker locker(&mutex);
+        stopping = true;
+        wake.wakeAll();
+    }
+    writer->wait();
+    delete writer;
+    writer = nullptr;
+    current.close();
+}
+
+void GameJournal::append(int roomId, const QJsonObject &event)
+{
+    events++;
+    enqueue(Kind::Event, roomId, event);
+}
+
+void GameJournal::writeSnapshot(int roomId, const QJsonObject &image)
+{
+    enqueue(Kind::Snapshot, roomId, image);
+}
+
+void GameJournal::dropRoom(int roomId)
+{
+    enqueue(Kind::Drop, roomId, QJsonObject());
+}
+
+bool GameJournal::sync()
+{
+    QMutexLocker locker(&mutex);
+    const quint64 target = submitted;
+    while (writer && committed < target && !failing) {
+        drained.wait(&mutex);
+    }
+    return committed >= target;
+}
+
+int GameJournal::snapshotEvents() const
+{
+    return maxEvents;
+}
+
+int GameJournal::snapshotIntervalMs() const
+{
+    return intervalMs;
+}
+
+quint64 GameJournal::eventCount() const
+{
+    return events.load();
+}
+
+quint64 GameJournal::commitCount() const
+{
+    return commits.load();
+}
+
+quint64 GameJournal::snapshotCount() const
+{
+    return snapshots.load();
+}
+
+void GameJournal::enqueue(Kind kind, int roomId, const QJsonObject &obj)
+{
+    // nur einreihen: Serialisieren und fsync macht der Writer
+    QMutexLocker locker(&mutex);
+    if (!writer || stopping) return;
+    queue.append({kind, roomId, obj});
+    submitted++;
+    wake.wakeOne();
+}
+
+void GameJournal::run()
+{
+    QMutexLocker locker(&mutex);
+    while (true) {
+        while (queue.isEmpty() && !stopping) {
+            wake.wait(&mutex);
+        }
+        if (queue.isEmpty()) break;
+
+        // alles bis hierher ist ein Schub; waehrend wir schreiben,
+        // sammelt sich der naechste an
+        QVector<Item> batch;
+        batch.swap(queue);
+        const quint64 upTo = submitted;
+
+        locker.unlock();
+        const bool ok = commit(batch);
+        locker.relock();
+
+        if (ok) {
+            committed = upTo;
+            failing = false;
+            drained.wakeAll();
+            continue;
+        }
+
+        // nichts davon gilt als geschrieben: Schub vorne wieder einreihen
+        // und spaeter erneut versuchen, beim Beenden aufgeben
+        failing = true;
+        drained.wakeAll();
+        batch += queue;
+        queue.swap(batch);
+        if (stopping) {
+            qWarning() << "[JOURNAL]" << queue.size() << "Eintraege beim Beenden verloren";
+            queue.clear();
+            break;
+        }
+        wake.wait(&mutex, retryMs);
+    }
+}
+
+bool GameJournal::commit(const QVector<Item> &batch)
+{
+    const QHash<int, quint64> lastSeq = segments.last().lastSeq;
+    QByteArray lines;
+    QHash<int, QJsonObject> images; // je Raum nur der letzte Snapshot im Schub
+    QVector<int> drops;
+
+    for (const Item &item : batch) {
+        switch (item.kind) {
+        case Kind::Event: {
+            QJsonObject event = item.obj;
+            event["r"] = item.roomId;
+            lines += QJsonDocument(event).toJson(QJsonDocument::Compact);
+            lines += '\n';
+            segments.last().lastSeq[item.roomId] = quint64(item.obj.value("s").toDouble());
+            break;
+        }
+        case Kind::Snapshot:
+            images.insert(item.roomId, item.obj);
+            break;
+        case Kind::Drop: {
+            QJsonObject close;
+            close["r"] = item.roomId;
+            close["e"] = "close";
+            lines += QJsonDocument(close).toJson(QJsonDocument::Compact);
+            lines += '\n';
+            images.remove(item.roomId);
+            drops.append(item.roomId);
+            break;
+        }
+        }
+    }
+
+    // ein write + ein fsync fuer den ganzen Schub
+    if (!lines.isEmpty()) {
+        if (current.write(lines) != lines.size() || !syncFile(current)) {
+            qWarning() << "[JOURNAL] Schreiben fehlgeschlagen:" << current.errorString();
+            // keine abgerissene Zeile stehen lassen, recover() hoert dort auf
+            // und alles danach waere weg; notfalls in einem neuen Segment weiter
+            Segment &segment = segments.last();
+            segment.lastSeq = lastSeq;
+            if (!current.resize(segment.bytes) || !syncFile(current)) {
+                startSegment();
+            }
+            return false;
+        }
+        segments.last().bytes += lines.size();
+        commits++;
+    }
+
+    // Snapshots erst nach den Ereignissen, die sie abdecken
+    for (auto it = images.constBegin(); it != images.constEnd(); ++it) {
+        QSaveFile file(snapshotPath(it.key()));
+        if (!file.open(QIODevice::WriteOnly)) continue;
+        file.write(QJsonDocument(it.value()).toJson(QJsonDocument::Compact));
+        // commit() synct und ersetzt die alte Datei atomar per rename
+        if (!file.commit()) {
+            qWarning() << "[JOURNAL] Snapshot fuer Raum" << it.key() << "fehlgeschlagen";
+            continue;
+        }
+        snapshotSeq.insert(it.key(), quint64(it.value().value("seq").toDouble()));
+        snapshots++;
+    }
+
+    for (int roomId : drops) {
+        QFile::remove(snapshotPath(roomId));
+        snapshotSeq.remove(roomId);
+        dropped.insert(roomId);
+    }
+
+    if (segments.last().bytes >= segmentBytes) {
+        startSegment();
+    }
+    if (!images.isEmpty() || !drops.isEmpty()) {
+        deleteCoveredSegments();
+    }
+    return true;
+}
+
+bool GameJournal::startSegment()
+{
+    if (current.isOpen()) {
+        syncFile(current);
+        current.close();
+    }
+
+    Segment segment;
+    segment.index = nextSegment++;
+    current.setFileName(segmentPath(segment.index));
+    if (!current.open(QIODevice::WriteOnly | QIODevice::Append)) {
+        qWarning() << "[JOURNAL]" << current.fileName() << "nicht schreibbar:" << current.errorString();
+        return false;
+    }
+    segments.append(segment);
+    return true;
+}
+
+void GameJournal::deleteCoveredSegments()
+{
+    // nur von vorne: ein geloeschtes Segment hat nie aeltere Nachbarn
+    while (segments.size() > 1) {
+        const Segment &oldest = segments.first();
+        for (auto it = oldest.lastSeq.constBegin(); it != oldest.lastSeq.constEnd(); ++it) {
+            if (!dropped.contains(it.key()) && snapshotSeq.value(it.key(), 0) < it.value()) {
+                return;
+            }
+        }
+        QFile::remove(segmentPath(oldest.index));
+        qDebug() << "[JOURNAL] Segment" << oldest.index << "abgedeckt, geloescht";
+        segments.removeFirst();
+    }
+}
+
+QString GameJournal::segmentPath(int index) const
+{
+    return QDir(dir).filePath(QString("journal-%1.log").arg(index, 6, 10, QChar('0')));
+}
+
+QString GameJournal::snapshotPath(int roomId) const
+{
+    return QDir(dir).filePath(QString("room-%1.json").arg(roomId));
+}
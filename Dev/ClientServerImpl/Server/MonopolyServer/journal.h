@@ -0,0 +1,124 @@
+#ifndef JOURNAL_H
+#define JOURNAL_H
+
+#include <QFile>
+#include <QHash>
+#include <QJsonObject>
+#include <QMutex>
+#include <QSet>
+#include <QString>
+#include <QVector>
+#include <QWaitCondition>
+#include <atomic>
+
+class QThread;
+
+// Ereignis-Journal aller Raeume fuer den Neustart nach einem Absturz.
+//
+// Jede Zustandsaenderung eines Raums ist eine JSON-Zeile
+// {"r":roomId,"s":seq,"e":typ,...} in einem gemeinsamen Segment
+// (journal-000001.log, ...). append() stellt nur in eine Queue, ein
+// Writer-Thread schreibt alles Angesammelte am Stueck und macht ein fsync
+// je Schub (Group Commit) - der Spiel-Thread wartet nie auf die Platte.
+//
+// Dazu je Raum ein kompakter Snapshot (room-<id>.json). Segmente, deren
+// Ereignisse komplett von Snapshots abgedeckt sind, werden geloescht;
+// die Wiederherstellung liest also nur Snapshots plus einen kurzen Rest.
+class GameJournal
+{
+public:
+    // Zustand eines Raums fuer die Wiederherstellung
+    struct RoomLog {
+        int roomId = 0;
+        QJsonObject snapshot;        // leer = kein Snapshot
+        QVector<QJsonObject> events; // nach dem Snapshot, in seq-Reihenfolge
+    };
+
+    explicit GameJournal(const QString &directory);
+    ~GameJournal();
+
+    GameJournal(const GameJournal &) = delete;
+    GameJournal &operator=(const GameJournal &) = delete;
+
+    QString directory() const;
+
+    // liest Snapshots und Segmente, nur vor open();
+    // maxRoomId = hoechste im Journal vorkommende Raum-ID
+    QVector<RoomLog> recover(int *maxRoomId = nullptr);
+
+    // startet den Writer mit einem neuen Segment
+    bool open();
+    // Rest schreiben und Writer beenden
+    void close();
+
+    // aus den Raum-Threads, blockiert nur fuer das Einreihen
+    void append(int roomId, const QJsonObject &event);
+    void writeSnapshot(int roomId, const QJsonObject &image);
+    void dropRoom(int roomId);
+
+    // wartet, bis alles bisher Eingereichte auf der Platte ist;
+    // false, wenn der Writer gerade nicht schreiben kann (Platte voll o.ae.)
+    bool sync();
+
+    // Snapshot nach so vielen Ereignissen bzw. spaetestens nach so vielen ms
+    int snapshotEvents() const;
+    int snapshotIntervalMs() const;
+
+    quint64 eventCount() const;
+    quint64 commitCount() const;
+    quint64 snapshotCount() const;
+
+private:
+    enum class Kind { Event, Snapshot, Drop };
+    struct Item {
+        Kind kind = Kind::Event;
+        int roomId = 0;
+        QJsonObject obj;
+    };
+
+    // Segment mit hoechster seq je Raum, darf weg, sobald alle Raeume
+    // einen neueren Snapshot haben oder geschlossen sind
+    struct Segment {
+        int index = 0;
+        qint64 bytes = 0;
+        QHash<int, quint64> lastSeq;
+    };
+
+    static constexpr qint64 segmentBytes = 16 * 1024 * 1024;
+    static constexpr int retryMs = 1000;
+
+    QString dir;
+    int maxEvents = 500;
+    int intervalMs = 30000;
+
+    QMutex mutex;
+    QWaitCondition wake;    // Writer: neue Eintraege oder stopping
+    QWaitCondition drained; // sync(): Schub ist geschrieben
+    QVector<Item> queue;
+    quint64 submitted = 0;
+    quint64 committed = 0;  // nur, was wirklich auf der Platte ist
+    bool failing = false;   // letzter Schub nicht geschrieben, wird wiederholt
+    bool stopping = false;
+    QThread *writer = nullptr;
+
+    std::atomic<quint64> events{0};
+    std::atomic<quint64> commits{0};
+    std::atomic<quint64> snapshots{0};
+
+    // nur im Writer-Thread (bzw. vor open())
+    QVector<Segment> segments; // aeltestes zuerst, das letzte ist offen
+    QFile current;
+    QHash<int, quint64> snapshotSeq;
+    QSet<int> dropped;
+    int nextSegment = 1;
+
+    void enqueue(Kind kind, int roomId, const QJsonObject &obj);
+    void run();
+    bool commit(const QVector<Item> &batch);
+    bool startSegment();
+    void deleteCoveredSegments();
+    QString segmentPath(int index) const;
+    QString snapshotPath(int roomId) const;
+};
+
+#endif // JOURNAL_H
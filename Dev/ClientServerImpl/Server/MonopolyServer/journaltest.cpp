@@ -0,0 +1,171 @@
+// GameJournal::recover nach einem Absturz mitten im Schreiben: die
+// abgerissene letzte Zeile faellt weg, alles davor kommt vollstaendig und in
+// seq-Reihenfolge zurueck, und ein neues Segment schreibt dahinter weiter.
+
+#include <QFile>
+#include <QTemporaryDir>
+#include <QtTest>
+#include <memory>
+
+#include "journal.h"
+
+namespace {
+
+QJsonObject journalEvent(quint64 seq, const QString &type)
+{
+    return {{"s", qint64(seq)}, {"e", type}, {"p", 1}, {"money", 1500}};
+}
+
+QVector<quint64> seqs(const GameJournal::RoomLog &log)
+{
+    QVector<quint64> result;
+    for (const QJsonObject &e : log.events) {
+        result.append(quint64(e.value("s").toDouble()));
+    }
+    return result;
+}
+
+const GameJournal::RoomLog *findRoom(const QVector<GameJournal::RoomLog> &logs, int roomId)
+{
+    for (const GameJournal::RoomLog &log : logs) {
+        if (log.roomId == roomId) return &log;
+    }
+    return nullptr;
+}
+
+} // namespace
+
+class JournalTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void init();
+    void cleanup();
+
+    void recoversWrittenEvents();
+    void dropsTornTail();
+    void appendsAfterTornTail();
+    void snapshotCoversOlderEvents();
+
+private:
+    std::unique_ptr<QTemporaryDir> dir;
+
+    // Raum 1: seq 1..3, Raum 2: seq 1
+    void writeJournal();
+    void tearLastSegment();
+};
+
+void JournalTest::init()
+{
+    dir = std::make_unique<QTemporaryDir>();
+    QVERIFY(dir->isValid());
+}
+
+void JournalTest::cleanup()
+{
+    dir.reset();
+}
+
+void JournalTest::writeJournal()
+{
+    GameJournal journal(dir->path());
+    QVERIFY(journal.open());
+    journal.append(1, journalEvent(1, "join"));
+    journal.append(1, journalEvent(2, "start"));
+    journal.append(2, journalEvent(1, "join"));
+    journal.append(1, journalEvent(3, "dice"));
+    QVERIFY(journal.sync());
+    journal.close();
+}
+
+void JournalTest::tearLastSegment()
+{
+    // Absturz nach write(), vor dem Zeilenende
+    QFile segment(dir->filePath("journal-000001.log"));
+    QVERIFY(segment.open(QIODevice::Append));
+    segment.write(R"({"s":4,"e":"dice","p":1,"mon)");
+}
+
+void JournalTest::recoversWrittenEvents()
+{
+    writeJournal();
+
+    GameJournal journal(dir->path());
+    int maxRoomId = 0;
+    const QVector<GameJournal::RoomLog> logs = journal.recover(&maxRoomId);
+    QCOMPARE(logs.size(), 2);
+    QCOMPARE(maxRoomId, 2);
+
+    const GameJournal::RoomLog *room = findRoom(logs, 1);
+    QVERIFY(room);
+    QVERIFY(room->snapshot.isEmpty());
+    QCOMPARE(seqs(*room), QVector<quint64>({1, 2, 3}));
+    QCOMPARE(room->events.at(2).value("e").toString(), QString("dice"));
+    QCOMPARE(room->events.at(2).value("r").toInt(), 1);
+}
+
+void JournalTest::dropsTornTail()
+{
+    writeJournal();
+    tearLastSegment();
+
+    GameJournal journal(dir->path());
+    const QVector<GameJournal::RoomLog> logs = journal.recover();
+    QCOMPARE(logs.size(), 2);
+
+    const GameJournal::RoomLog *room = findRoom(logs, 1);
+    QVERIFY(room);
+    QCOMPARE(seqs(*room), QVector<quint64>({1, 2, 3}));
+    const GameJournal::RoomLog *other = findRoom(logs, 2);
+    QVERIFY(other);
+    QCOMPARE(seqs(*other), QVector<quint64>({1}));
+}
+
+void JournalTest::appendsAfterTornTail()
+{
+    writeJournal();
+    tearLastSegment();
+
+    // Neustart: wiederherstellen und in einem neuen Segment weiterschreiben
+    {
+        GameJournal journal(dir->path());
+        journal.recover();
+        QVERIFY(journal.open());
+        journal.append(1, journalEvent(4, "dice"));
+        QVERIFY(journal.sync());
+        journal.close();
+    }
+    QVERIFY(QFile::exists(dir->filePath("journal-000002.log")));
+
+    GameJournal journal(dir->path());
+    const QVector<GameJournal::RoomLog> logs = journal.recover();
+    const GameJournal::RoomLog *room = findRoom(logs, 1);
+    QVERIFY(room);
+    QCOMPARE(seqs(*room), QVector<quint64>({1, 2, 3, 4}));
+}
+
+void JournalTest::snapshotCoversOlderEvents()
+{
+    {
+        GameJournal journal(dir->path());
+        QVERIFY(journal.open());
+        journal.append(1, journalEvent(1, "join"));
+        journal.append(1, journalEvent(2, "start"));
+        journal.writeSnapshot(1, {{"roomId", 1}, {"seq", 2}, {"name", "Tisch 1"}});
+        journal.append(1, journalEvent(3, "dice"));
+        QVERIFY(journal.sync());
+        journal.close();
+    }
+    tearLastSegment();
+
+    GameJournal journal(dir->path());
+    const QVector<GameJournal::RoomLog> logs = journal.recover();
+    const GameJournal::RoomLog *room = findRoom(logs, 1);
+    QVERIFY(room);
+    QCOMPARE(room->snapshot.value("seq").toInt(), 2);
+    QCOMPARE(seqs(*room), QVector<quint64>({3}));
+}
+
+QTEST_GUILESS_MAIN(JournalTest)
+#include "journaltest.moc"
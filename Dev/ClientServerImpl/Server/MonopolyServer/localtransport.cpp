@@ -0,0 +1,84 @@
+#include "localtransport.h"
+
+#include <QThread>
+
+LocalTransport::LocalTransport(QLocalSocket *socket)
+    : socket(socket)
+{
+}
+
+LocalTransport::~LocalTransport()
+{
+    detach();
+    delete socket;
+}
+
+void LocalTransport::attach(const Events &events)
+{
+    detach();
+    signalConnections.append(QObject::connect(socket, &QLocalSocket::readyRead,
+                                              socket, events.readable));
+    signalConnections.append(QObject::connect(socket, &QLocalSocket::bytesWritten,
+                                              socket, [cb = events.writable](qint64) { cb(); }));
+    signalConnections.append(QObject::connect(socket, &QLocalSocket::disconnected,
+                                              socket, events.closed));
+}
+
+void LocalTransport::detach()
+{
+    for (const QMetaObject::Connection &c : signalConnections) {
+        QObject::disconnect(c);
+    }
+    signalConnections.clear();
+}
+
+void LocalTransport::moveToThread(QThread *thread)
+{
+    socket->setParent(nullptr);
+    socket->moveToThread(thread);
+}
+
+bool LocalTransport::isConnected() const
+{
+    return socket->state() == QLocalSocket::ConnectedState;
+}
+
+QString LocalTransport::peerInfo() const
+{
+    return QString("unix:%1#%2").arg(socket->serverName()).arg(socket->socketDescriptor());
+}
+
+qint64 LocalTransport::readInto(Protocol::FrameReader &reader)
+{
+    return reader.readFrom(socket);
+}
+
+bool LocalTransport::hasBytesAvailable() const
+{
+    return socket->bytesAvailable() > 0;
+}
+
+void LocalTransport::write(const QByteArray &data)
+{
+    socket->write(data);
+}
+
+void LocalTransport::flush()
+{
+    socket->flush();
+}
+
+qint64 LocalTransport::bytesToWrite() const
+{
+    return socket->bytesToWrite();
+}
+
+void LocalTransport::close()
+{
+    socket->disconnectFromServer();
+}
+
+void LocalTransport::abort()
+{
+    socket->abort();
+}
@@ -0,0 +1,40 @@
+#ifndef LOCALTRANSPORT_H
+#define LOCALTRANSPORT_H
+
+#include <QLocalSocket>
+#include <QMetaObject>
+#include <QVector>
+
+#include "transport.h"
+
+// Transport ueber QLocalSocket: Unix-Domain-Socket (AF_UNIX), unter
+// Windows eine Named Pipe. Fuer Bots und Tools auf demselben Rechner,
+// ohne TCP-Stack.
+class LocalTransport : public Transport
+{
+public:
+    explicit LocalTransport(QLocalSocket *socket);
+    ~LocalTransport() override;
+
+    void attach(const Events &events) override;
+    void detach() override;
+    void moveToThread(QThread *thread) override;
+
+    bool isConnected() const override;
+    QString peerInfo() const override;
+    qint64 readInto(Protocol::FrameReader &reader) override;
+    bool hasBytesAvailable() const override;
+
+    void write(const QByteArray &data) override;
+    void flush() override;
+    qint64 bytesToWrite() const override;
+
+    void close() override;
+    void abort() override;
+
+private:
+    QLocalSocket *socket;
+    QVector<QMetaObject::Connection> signalConnections;
+};
+
+#endif // LOCALTRANSPORT_H
@@ -0,0 +1,184 @@
+#include "loopbackharness.h"
+
+#include <QElapsedTimer>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QWaitCondition>
+#include <QDebug>
+#include <atomic>
+#include <string_view>
+#include <utility>
+
+struct LoopbackHarness::WakeState {
+    QMutex mutex;
+    QWaitCondition condition;
+    std::atomic<bool> pending{false};
+
+    // im Thread eines Shards
+    void notify()
+    {
+        if (pending.exchange(true)) return;
+        QMutexLocker locker(&mutex);
+        condition.wakeAll();
+    }
+};
+
+LoopbackHarness::LoopbackHarness(GameServer &server, Capture capture)
+    : server(server)
+    , capture(capture)
+    , wake(std::make_shared<WakeState>())
+{
+}
+
+LoopbackHarness::~LoopbackHarness()
+{
+    for (auto &client : clients) {
+        client->link->setReceiveCallback(nullptr);
+    }
+}
+
+int LoopbackHarness::addClients(int count)
+{
+    const int first = int(clients.size());
+    for (int i = 0; i < count; ++i) {
+        auto client = std::make_unique<VirtualClient>();
+        client->link = server.connectLoopback();
+        std::shared_ptr<WakeState> state = wake;
+        client->link->setReceiveCallback([state]() { state->notify(); });
+        clients.push_back(std::move(client));
+    }
+    return first;
+}
+
+int LoopbackHarness::clientCount() const
+{
+    return int(clients.size());
+}
+
+void LoopbackHarness::sendFrame(int client, const QByteArray &frame)
+{
+    clients.at(size_t(client))->link->send(frame);
+}
+
+void LoopbackHarness::send(int client, const QJsonObject &msg, Protocol::WireFormat format)
+{
+    sendFrame(client, Protocol::encode(msg, format));
+}
+
+void LoopbackHarness::disconnect(int client)
+{
+    clients.at(size_t(client))->link->close();
+}
+
+bool LoopbackHarness::waitUntil(const std::function<bool()> &done, int timeoutMs)
+{
+    QElapsedTimer timer;
+    timer.start();
+    while (true) {
+        collect();
+        if (done()) return true;
+
+        const qint64 left = timeoutMs - timer.elapsed();
+        if (left <= 0) return false;
+
+        QMutexLocker locker(&wake->mutex);
+        if (!wake->pending.load()) {
+            wake->condition.wait(&wake->mutex, quint64(qMin<qint64>(left, 50)));
+        }
+    }
+}
+
+void LoopbackHarness::collect()
+{
+    wake->pending.store(false);
+    for (auto &client : clients) {
+        drain(*client);
+    }
+}
+
+void LoopbackHarness::drain(VirtualClient &client)
+{
+    QByteArray data = client.link->takeReceived();
+    if (data.isEmpty()) return;
+    bytes += quint64(data.size());
+
+    if (capture == Capture::Messages) {
+        client.reader.append(data);
+        QJsonObject msg;
+        QString error;
+        while (true) {
+            const Protocol::FrameReader::Result result = client.reader.next(&msg, &error);
+            if (result == Protocol::FrameReader::Result::Incomplete
+                || result == Protocol::FrameReader::Result::TooLarge) {
+                break;
+            }
+            if (result == Protocol::FrameReader::Result::Malformed) {
+                qWarning() << "[HARNESS]" << error;
+                continue;
+            }
+            const QString type = msg.value("type").toString();
+            if (type == "ack" || type == "nack") {
+                client.replies++;
+                replies++;
+            }
+            client.frames++;
+            frames++;
+            client.messages.append(msg);
+        }
+        return;
+    }
+
+    // Zaehlen ohne Parsen: eine JSON-Zeile je Frame, ack/nack am Typ erkennen
+    if (!client.partial.isEmpty()) {
+        data.prepend(client.partial);
+        client.partial.clear();
+    }
+    static constexpr std::string_view ackTag = "\"type\":\"ack\"";
+    static constexpr std::string_view nackTag = "\"type\":\"nack\"";
+    const std::string_view all(data.constData(), size_t(data.size()));
+    size_t start = 0;
+    size_t nl;
+    while ((nl = all.find('\n', start)) != std::string_view::npos) {
+        const std::string_view line = all.substr(start, nl - start);
+        if (line.find(ackTag) != std::string_view::npos || line.find(nackTag) != std::string_view::npos) {
+            client.replies++;
+            replies++;
+        }
+        client.frames++;
+        frames++;
+        start = nl + 1;
+    }
+    if (start < all.size()) {
+        client.partial = data.mid(qsizetype(start));
+    }
+}
+
+QVector<QJsonObject> LoopbackHarness::takeMessages(int client)
+{
+    return std::exchange(clients.at(size_t(client))->messages, QVector<QJsonObject>());
+}
+
+quint64 LoopbackHarness::framesReceived(int client) const
+{
+    return clients.at(size_t(client))->frames;
+}
+
+quint64 LoopbackHarness::repliesReceived(int client) const
+{
+    return clients.at(size_t(client))->replies;
+}
+
+quint64 LoopbackHarness::totalFramesReceived() const
+{
+    return frames;
+}
+
+quint64 LoopbackHarness::totalRepliesReceived() const
+{
+    return replies;
+}
+
+quint64 LoopbackHarness::totalBytesReceived() const
+{
+    return bytes;
+}
@@ -0,0 +1,87 @@
+#ifndef LOOPBACKHARNESS_H
+#define LOOPBACKHARNESS_H
+
+#include <QByteArray>
+#include <QJsonObject>
+#include <QVector>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "gameserver.h"
+#include "loopbacktransport.h"
+#include "protocol.h"
+
+// Treibt einen GameServer ohne Sockets: N virtuelle Clients haengen ueber
+// Loopback-Transporte am Server, Nachrichten gehen durch denselben Pfad wie
+// von TCP (FrameReader, processMessage, Raeume, Encoder), die Antworten
+// landen im Speicher. Grundlage fuer Durchsatzmessungen und
+// Regressionslaeufe des Hot-Paths.
+//
+// Aufrufe nur aus einem Thread (dem des Harness); die Shards laufen wie
+// gewohnt in ihren eigenen Threads.
+class LoopbackHarness
+{
+public:
+    // Messages: jede Antwort dekodiert aufheben (takeMessages)
+    // Count:    nur zaehlen - nur JSON-Zeilen, fuer Durchsatzmessungen
+    enum class Capture { Messages, Count };
+
+    explicit LoopbackHarness(GameServer &server, Capture capture = Capture::Messages);
+    ~LoopbackHarness();
+
+    LoopbackHarness(const LoopbackHarness &) = delete;
+    LoopbackHarness &operator=(const LoopbackHarness &) = delete;
+
+    // haengt count Clients an, liefert den Index des ersten
+    int addClients(int count);
+    int clientCount() const;
+
+    // fertig gerahmte Bytes (auch mehrere Frames am Stueck) einspeisen
+    void sendFrame(int client, const QByteArray &frame);
+    void send(int client, const QJsonObject &msg,
+              Protocol::WireFormat format = Protocol::WireFormat::Json);
+    void disconnect(int client);
+
+    // Ausgaben einsammeln, bis done() gilt; false nach timeoutMs
+    bool waitUntil(const std::function<bool()> &done, int timeoutMs = 10000);
+    // einmal einsammeln, ohne zu warten
+    void collect();
+
+    // Capture::Messages: bisher empfangene Nachrichten eines Clients (und leeren)
+    QVector<QJsonObject> takeMessages(int client);
+
+    // Zaehler, auch bei Capture::Count; replies = ack + nack
+    quint64 framesReceived(int client) const;
+    quint64 repliesReceived(int client) const;
+    quint64 totalFramesReceived() const;
+    quint64 totalRepliesReceived() const;
+    quint64 totalBytesReceived() const;
+
+private:
+    struct VirtualClient {
+        std::unique_ptr<LoopbackClient> link;
+        Protocol::FrameReader reader;
+        QVector<QJsonObject> messages;
+        QByteArray partial; // Capture::Count: angefangene Zeile
+        quint64 frames = 0;
+        quint64 replies = 0;
+    };
+
+    // von den Shard-Threads geweckt; geteilt, damit ein spaeter Callback
+    // den Harness nicht ueberlebt haben muss
+    struct WakeState;
+
+    GameServer &server;
+    Capture capture;
+    std::vector<std::unique_ptr<VirtualClient>> clients;
+    std::shared_ptr<WakeState> wake;
+
+    quint64 frames = 0;
+    quint64 replies = 0;
+    quint64 bytes = 0;
+
+    void drain(VirtualClient &client);
+};
+
+#endif // LOOPBACKHARNESS_H
@@ -0,0 +1,237 @@
+#include "loopbacktransport.h"
+
+#include <QMutex>
+#include <QMutexLocker>
+#include <QThread>
+#include <utility>
+
+// gemeinsamer Zustand beider Enden, alles unter mutex
+struct LoopbackPipe {
+    QMutex mutex;
+    int id = 0;
+    QByteArray toServer;
+    QByteArray toClient;
+    bool serverClosed = false;
+    bool clientClosed = false;
+
+    // Server-Seite wecken (nur unter mutex, wird im Destruktor abgemeldet)
+    LoopbackTransport *server = nullptr;
+    QObject *waker = nullptr;
+    bool wakePosted = false;
+
+    std::function<void()> onReceive;
+
+    // mutex muss gehalten werden
+    void wakeServer()
+    {
+        if (wakePosted || !waker) return;
+        wakePosted = true;
+        LoopbackTransport *target = server;
+        QMetaObject::invokeMethod(waker, [target]() {
+            target->onWake();
+        }, Qt::QueuedConnection);
+    }
+};
+
+LoopbackTransport::LoopbackTransport(std::shared_ptr<LoopbackPipe> pipe)
+    : pipe(std::move(pipe))
+    , waker(std::make_unique<QObject>())
+{
+    QMutexLocker locker(&this->pipe->mutex);
+    this->pipe->server = this;
+    this->pipe->waker = waker.get();
+}
+
+LoopbackTransport::~LoopbackTransport()
+{
+    detach();
+    std::function<void()> notify;
+    {
+        QMutexLocker locker(&pipe->mutex);
+        pipe->serverClosed = true;
+        pipe->server = nullptr;
+        pipe->waker = nullptr;
+        notify = pipe->onReceive;
+    }
+    if (notify) notify();
+    // noch offene Weck-Nachrichten verfallen mit dem waker
+    waker.reset();
+}
+
+void LoopbackTransport::attach(const Events &newEvents)
+{
+    detach();
+    events = newEvents;
+
+    // waehrend der Uebergabe Angekommenes oder Geschlossenes nachholen
+    QMutexLocker locker(&pipe->mutex);
+    if (!pipe->toServer.isEmpty() || pipe->clientClosed) {
+        pipe->wakeServer();
+    }
+}
+
+void LoopbackTransport::detach()
+{
+    events = Events();
+}
+
+void LoopbackTransport::moveToThread(QThread *thread)
+{
+    // offene Weck-Nachrichten ziehen mit um
+    waker->moveToThread(thread);
+}
+
+bool LoopbackTransport::isConnected() const
+{
+    QMutexLocker locker(&pipe->mutex);
+    return !pipe->serverClosed && !pipe->clientClosed;
+}
+
+QString LoopbackTransport::peerInfo() const
+{
+    return QString("loopback:%1").arg(pipe->id);
+}
+
+qint64 LoopbackTransport::readInto(Protocol::FrameReader &reader)
+{
+    QByteArray data;
+    {
+        QMutexLocker locker(&pipe->mutex);
+        data = std::exchange(pipe->toServer, QByteArray());
+    }
+    reader.append(data);
+    return data.size();
+}
+
+bool LoopbackTransport::hasBytesAvailable() const
+{
+    QMutexLocker locker(&pipe->mutex);
+    return !pipe->toServer.isEmpty();
+}
+
+void LoopbackTransport::write(const QByteArray &data)
+{
+    std::function<void()> notify;
+    {
+        QMutexLocker locker(&pipe->mutex);
+        if (pipe->serverClosed || pipe->clientClosed) return;
+        pipe->toClient.append(data);
+        notify = pipe->onReceive;
+    }
+    if (notify) notify();
+}
+
+void LoopbackTransport::flush()
+{
+    // write() liefert sofort aus
+}
+
+qint64 LoopbackTransport::bytesToWrite() const
+{
+    return 0;
+}
+
+void LoopbackTransport::close()
+{
+    // alles ist schon zugestellt; closed erst im naechsten Durchlauf melden,
+    // der Aufrufer steckt evtl. noch in der Verarbeitung
+    std::function<void()> notify;
+    {
+        QMutexLocker locker(&pipe->mutex);
+        pipe->serverClosed = true;
+        notify = pipe->onReceive;
+        pipe->wakeServer();
+    }
+    if (notify) notify();
+}
+
+void LoopbackTransport::abort()
+{
+    std::function<void()> notify;
+    {
+        QMutexLocker locker(&pipe->mutex);
+        pipe->serverClosed = true;
+        notify = pipe->onReceive;
+    }
+    if (notify) notify();
+    reportClosed();
+}
+
+void LoopbackTransport::onWake()
+{
+    bool closed = false;
+    {
+        QMutexLocker locker(&pipe->mutex);
+        pipe->wakePosted = false;
+        closed = pipe->serverClosed || pipe->clientClosed;
+    }
+    if (events.readable) {
+        events.readable();
+    }
+    if (closed) {
+        reportClosed();
+    }
+}
+
+void LoopbackTransport::reportClosed()
+{
+    // readable kann detach() ausgeloest haben: dann meldet der neue Besitzer
+    if (closedReported || !events.closed) return;
+    closedReported = true;
+    const std::function<void()> closed = events.closed;
+    closed();
+}
+
+LoopbackClient::LoopbackClient(std::shared_ptr<LoopbackPipe> pipe)
+    : pipe(std::move(pipe))
+{
+}
+
+LoopbackClient::~LoopbackClient()
+{
+    close();
+    QMutexLocker locker(&pipe->mutex);
+    pipe->onReceive = nullptr;
+}
+
+std::unique_ptr<LoopbackClient> LoopbackClient::create(std::unique_ptr<LoopbackTransport> *serverSide, int id)
+{
+    auto pipe = std::make_shared<LoopbackPipe>();
+    pipe->id = id;
+    *serverSide = std::make_unique<LoopbackTransport>(pipe);
+    return std::make_unique<LoopbackClient>(pipe);
+}
+
+void LoopbackClient::send(const QByteArray &frame)
+{
+    QMutexLocker locker(&pipe->mutex);
+    if (pipe->serverClosed || pipe->clientClosed) return;
+    pipe->toServer.append(frame);
+    pipe->wakeServer();
+}
+
+QByteArray LoopbackClient::takeReceived()
+{
+    QMutexLocker locker(&pipe->mutex);
+    return std::exchange(pipe->toClient, QByteArray());
+}
+
+void LoopbackClient::setReceiveCallback(std::function<void()> callback)
+{
+    QMutexLocker locker(&pipe->mutex);
+    pipe->onReceive = std::move(callback);
+}
+
+bool LoopbackClient::isConnected() const
+{
+    QMutexLocker locker(&pipe->mutex);
+    return !pipe->serverClosed && !pipe->clientClosed;
+}
+
+void LoopbackClient::close()
+{
+    QMutexLocker locker(&pipe->mutex);
+    if (pipe->clientClosed) return;
+    pipe->clientClosed = true;
+    pipe->wakeServer();
+}
@@ -0,0 +1,83 @@
+#ifndef LOOPBACKTRANSPORT_H
+#define LOOPBACKTRANSPORT_H
+
+#include <QByteArray>
+#include <QObject>
+#include <functional>
+#include <memory>
+
+#include "transport.h"
+
+struct LoopbackPipe;
+
+// In-Process-Verbindung ohne Socket: zwei Byte-Puffer im Speicher.
+// Die Server-Seite ist ein normaler Transport im Shard, die Client-Seite
+// ein LoopbackClient, der aus jedem Thread benutzt werden darf.
+// Fuer Tests, Benchmarks und Bots im selben Prozess.
+class LoopbackTransport : public Transport
+{
+public:
+    explicit LoopbackTransport(std::shared_ptr<LoopbackPipe> pipe);
+    ~LoopbackTransport() override;
+
+    void attach(const Events &events) override;
+    void detach() override;
+    void moveToThread(QThread *thread) override;
+
+    bool isConnected() const override;
+    QString peerInfo() const override;
+    qint64 readInto(Protocol::FrameReader &reader) override;
+    bool hasBytesAvailable() const override;
+
+    void write(const QByteArray &data) override;
+    void flush() override;
+    qint64 bytesToWrite() const override;
+
+    void close() override;
+    void abort() override;
+
+private:
+    friend struct LoopbackPipe;
+
+    std::shared_ptr<LoopbackPipe> pipe;
+    Events events;
+    bool closedReported = false;
+
+    // lebt im Thread des Shards; der Client weckt die Server-Seite ueber
+    // eine Queued-Nachricht an dieses Objekt
+    std::unique_ptr<QObject> waker;
+
+    void onWake();
+    void reportClosed();
+};
+
+// Client-Ende einer Loopback-Verbindung
+class LoopbackClient
+{
+public:
+    explicit LoopbackClient(std::shared_ptr<LoopbackPipe> pipe);
+    ~LoopbackClient();
+
+    LoopbackClient(const LoopbackClient &) = delete;
+    LoopbackClient &operator=(const LoopbackClient &) = delete;
+
+    // legt ein neues Paar an; die Server-Seite geht an GameServer/RoomShard
+    static std::unique_ptr<LoopbackClient> create(std::unique_ptr<LoopbackTransport> *serverSide, int id);
+
+    // fertig gerahmte Bytes (JSON-Zeile oder CBOR-Frame) an den Server
+    void send(const QByteArray &frame);
+    // alles, was der Server seit dem letzten Aufruf geschrieben hat
+    QByteArray takeReceived();
+
+    // Aufruf bei neuen Daten vom Server - im Thread des Shards, also kurz
+    // halten und selbst synchronisieren
+    void setReceiveCallback(std::function<void()> callback);
+
+    bool isConnected() const;
+    void close();
+
+private:
+    std::shared_ptr<LoopbackPipe> pipe;
+};
+
+#endif // LOOPBACKTRANSPORT_H
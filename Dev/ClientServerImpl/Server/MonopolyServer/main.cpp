@@ -6,7 +6,55 @@ int main(int argc, char *argv[])
 {
     QCoreApplication a(argc, argv);
 
+    // --epoll: natives Linux-Backend statt QTcpServer/QTcpSocket
+    const GameServer::Backend backend = a.arguments().contains("--epoll")
+            ? GameServer::Backend::Epoll : GameServer::Backend::Qt;
+
     GameServer server;
-    server.startServer(4242);
+
+    // --seed <n>: fester Seed fuer Wuerfel und Karten, Raum n spielt bei
+    // gleichen Eingaben immer gleich (sonst je Raum zufaellig, steht im Journal)
+    const int seed = a.arguments().indexOf("--seed");
+    if (seed >= 0) {
+        server.setRoomSeed(a.arguments().value(seed + 1).toULongLong());
+    }
+
+    // --handover <pfad>: Hot-Restart. Laeuft dort schon ein Server, uebernimmt
+    // dieser Prozess dessen Listener, Verbindungen und Raeume; danach wartet
+    // er selbst dort auf den naechsten Nachfolger
+    const int handover = a.arguments().indexOf("--handover");
+    const QString handoverPath = a.arguments().value(handover + 1, "monopoly-handover");
+    const bool takenOver = handover >= 0 && server.takeOver(handoverPath);
+
+    // --checkpoint <file>: regelmaessiger Binaer-Checkpoint aller Raeume;
+    // mit --journal nur noch der Rest danach aus dem Journal
+    const int checkpoint = a.arguments().indexOf("--checkpoint");
+    if (checkpoint >= 0) {
+        server.setCheckpoint(a.arguments().value(checkpoint + 1, "monopoly.ckpt"));
+    }
+
+    // --journal <dir>: Spielstaende ueberstehen einen Absturz, beim Start
+    // werden die Raeume aus dem Journal wiederhergestellt
+    const int journal = a.arguments().indexOf("--journal");
+    if (journal >= 0 && !server.enableJournal(a.arguments().value(journal + 1, "journal"))) {
+        return 1;
+    }
+    if (journal < 0 && checkpoint >= 0 && !takenOver) {
+        server.restoreCheckpoint();
+    }
+
+    if (!server.startServer(4242, backend)) {
+        return 1;
+    }
+
+    if (handover >= 0) {
+        server.listenHandover(handoverPath);
+    }
+
+    // --local <name>: zusaetzlich lokaler Socket fuer Bots auf demselben Rechner
+    const int local = a.arguments().indexOf("--local");
+    if (local >= 0) {
+        server.listenLocal(a.arguments().value(local + 1, "monopoly"));
+    }
     return a.exec();
 }
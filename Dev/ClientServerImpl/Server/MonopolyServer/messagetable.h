@@ -0,0 +1,74 @@
+#ifndef MESSAGETABLE_H
+#define MESSAGETABLE_H
+
+#include <QJsonObject>
+#include <QJsonValue>
+#include <QString>
+#include <QVector>
+#include <array>
+#include <initializer_list>
+
+#include "protocol.h"
+
+class Player;
+
+// Handler-Tabelle fuer eingehende Nachrichten, direkt per Typ-Code
+// indiziert (kein String-Vergleich pro Nachricht). Jeder Eintrag kennt
+// die Felder, die die Nachricht haben muss bzw. haben darf.
+template <class Owner>
+class MessageTable
+{
+public:
+    using Handler = void (*)(Owner &owner, Player &player, const QJsonObject &msg);
+
+    struct Arg {
+        const char *name;
+        QJsonValue::Type type;
+        bool required = true;
+    };
+
+    void add(int code, Handler handler, std::initializer_list<Arg> args = {})
+    {
+        Entry &e = entries[code];
+        e.handler = handler;
+        e.args = QVector<Arg>(args);
+    }
+
+    bool contains(int code) const
+    {
+        return code > Protocol::UnknownType && code < Protocol::TypeCodeLimit
+               && entries[code].handler != nullptr;
+    }
+
+    // Argumente pruefen und Handler aufrufen.
+    // false: Argumente ungueltig (error gesetzt), Handler nicht aufgerufen
+    bool dispatch(int code, Owner &owner, Player &player, const QJsonObject &msg, QString *error) const
+    {
+        const Entry &e = entries[code];
+        for (const Arg &arg : e.args) {
+            const QJsonValue v = msg.value(QLatin1String(arg.name));
+            if (v.isUndefined()) {
+                if (!arg.required) {
+                    continue;
+                }
+                *error = QString("Feld '%1' fehlt").arg(QLatin1String(arg.name));
+                return false;
+            }
+            if (v.type() != arg.type) {
+                *error = QString("Feld '%1' hat den falschen Typ").arg(QLatin1String(arg.name));
+                return false;
+            }
+        }
+        e.handler(owner, player, msg);
+        return true;
+    }
+
+private:
+    struct Entry {
+        Handler handler = nullptr;
+        QVector<Arg> args;
+    };
+    std::array<Entry, Protocol::TypeCodeLimit> entries;
+};
+
+#endif // MESSAGETABLE_H
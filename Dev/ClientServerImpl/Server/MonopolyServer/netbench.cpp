@@ -0,0 +1,287 @@
+// Vergleich Qt-Backend gegen epoll-Backend (nur Linux).
+//
+// Startet je Backend einen GameServer im selben Prozess und faehrt ihn mit
+// N Clients ueber rohe, nicht blockierende Sockets an (Client-Seite per
+// poll(), damit kein Qt-Overhead in die Messung faellt):
+//   - Verbindungsaufbau: bis jeder Client seinen ersten Frame hat
+//   - Speicher: RSS-Zuwachs durch die offenen Verbindungen
+//   - Durchsatz: R Runden, jeder Client schickt setWireFormat und wartet
+//     auf die Antwort (kleinste Anfrage mit genau einer Antwort)
+//
+// Aufruf: MonopolyNetBench [--clients N] [--rounds R] [--port P] [--backend qt|epoll|both]
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QEventLoop>
+#include <QLoggingCategory>
+#include <QStringList>
+#include <QTimer>
+#include <QDebug>
+
+#include "gameserver.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace {
+
+struct BenchResult {
+    bool ok = false;
+    int connected = 0;
+    qint64 connectMs = 0;
+    qint64 rssKb = 0;
+    qint64 roundsMs = 0;
+    quint64 requests = 0;
+    qint64 p50Us = 0;
+    qint64 p99Us = 0;
+};
+
+struct BenchClient {
+    int fd = -1;
+    std::string in;
+    bool greeted = false;
+    int replies = 0;
+};
+
+qint64 residentKb()
+{
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    while (std::getline(status, line)) {
+        if (line.rfind("VmRSS:", 0) == 0) {
+            return std::atoll(line.c_str() + 6);
+        }
+    }
+    return 0;
+}
+
+void raiseFileLimit()
+{
+    rlimit limit{};
+    if (getrlimit(RLIMIT_NOFILE, &limit) == 0 && limit.rlim_cur < limit.rlim_max) {
+        limit.rlim_cur = limit.rlim_max;
+        setrlimit(RLIMIT_NOFILE, &limit);
+    }
+}
+
+int connectClient(quint16 port)
+{
+    const int fd = ::socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) return -1;
+
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (::connect(fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) != 0) {
+        ::close(fd);
+        return -1;
+    }
+    const int one = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+    return fd;
+}
+
+// liest alles Verfuegbare, zaehlt Begruessung und wireFormat-Antworten
+bool drainClient(BenchClient &client)
+{
+    char buf[16 * 1024];
+    while (true) {
+        const ssize_t got = ::recv(client.fd, buf, sizeof(buf), 0);
+        if (got > 0) {
+            client.in.append(buf, size_t(got));
+            continue;
+        }
+        if (got < 0 && errno == EINTR) continue;
+        if (got < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) break;
+        return false; // Server hat getrennt
+    }
+
+    size_t start = 0;
+    size_t nl;
+    while ((nl = client.in.find('\n', start)) != std::string::npos) {
+        client.greeted = true;
+        if (client.in.find("\"type\":\"wireFormat\"", start) < nl) {
+            client.replies++;
+        }
+        start = nl + 1;
+    }
+    client.in.erase(0, start);
+    return true;
+}
+
+// wartet, bis pred fuer alle Clients gilt (oder timeoutMs um ist)
+template <typename Pred>
+bool pollUntil(std::vector<BenchClient> &clients, Pred pred, int timeoutMs)
+{
+    std::vector<pollfd> fds(clients.size());
+    QElapsedTimer timer;
+    timer.start();
+    while (timer.elapsed() < timeoutMs) {
+        int open = 0;
+        for (size_t i = 0; i < clients.size(); ++i) {
+            fds[i].fd = pred(clients[i]) ? -1 : clients[i].fd;
+            fds[i].events = POLLIN;
+            fds[i].revents = 0;
+            if (fds[i].fd >= 0) open++;
+        }
+        if (open == 0) return true;
+
+        if (::poll(fds.data(), nfds_t(fds.size()), 100) < 0 && errno != EINTR) {
+            return false;
+        }
+        for (size_t i = 0; i < clients.size(); ++i) {
+            if (fds[i].revents != 0 && !drainClient(clients[i])) {
+                return false;
+            }
+        }
+    }
+    return false;
+}
+
+BenchResult runClients(quint16 port, int clientCount, int rounds)
+{
+    BenchResult result;
+    std::vector<BenchClient> clients(static_cast<size_t>(clientCount));
+    const qint64 rssBefore = residentKb();
+
+    QElapsedTimer timer;
+    timer.start();
+    for (BenchClient &client : clients) {
+        client.fd = connectClient(port);
+        if (client.fd < 0) break;
+        result.connected++;
+    }
+    if (result.connected == clientCount
+        && pollUntil(clients, [](const BenchClient &c) { return c.greeted; }, 60000)) {
+        result.connectMs = timer.elapsed();
+        result.rssKb = residentKb() - rssBefore;
+
+        static const char request[] = "{\"type\":\"setWireFormat\",\"format\":\"json\"}\n";
+        std::vector<qint64> roundUs;
+        timer.restart();
+        bool ok = true;
+        for (int round = 1; round <= rounds && ok; ++round) {
+            QElapsedTimer roundTimer;
+            roundTimer.start();
+            for (BenchClient &client : clients) {
+                if (::send(client.fd, request, sizeof(request) - 1, MSG_NOSIGNAL) < 0) {
+                    ok = false;
+                    break;
+                }
+            }
+            ok = ok && pollUntil(clients, [round](const BenchClient &c) {
+                return c.replies >= round;
+            }, 60000);
+            roundUs.push_back(roundTimer.nsecsElapsed() / 1000);
+        }
+        result.roundsMs = timer.elapsed();
+        result.requests = quint64(clientCount) * quint64(roundUs.size());
+
+        std::sort(roundUs.begin(), roundUs.end());
+        if (!roundUs.empty()) {
+            result.p50Us = roundUs[roundUs.size() / 2];
+            result.p99Us = roundUs[std::min(roundUs.size() - 1, roundUs.size() * 99 / 100)];
+        }
+        result.ok = ok;
+    }
+
+    for (BenchClient &client : clients) {
+        if (client.fd >= 0) ::close(client.fd);
+    }
+    return result;
+}
+
+BenchResult runBackend(GameServer::Backend backend, quint16 port, int clientCount, int rounds)
+{
+    BenchResult result;
+    GameServer server;
+    if (!server.startServer(port, backend)) {
+        return result;
+    }
+
+    // Clients in eigenem Thread, der Hauptthread nimmt beim Qt-Backend an
+    QEventLoop loop;
+    std::thread driver([&]() {
+        result = runClients(port, clientCount, rounds);
+        QMetaObject::invokeMethod(&loop, &QEventLoop::quit, Qt::QueuedConnection);
+    });
+    loop.exec();
+    driver.join();
+
+    // Server erst nach dem Abbau der Verbindungen beenden
+    QEventLoop settle;
+    QTimer::singleShot(500, &settle, &QEventLoop::quit);
+    settle.exec();
+    return result;
+}
+
+void printResult(const char *name, const BenchResult &r, int clientCount)
+{
+    if (!r.ok) {
+        std::printf("%-6s fehlgeschlagen (verbunden: %d/%d)\n", name, r.connected, clientCount);
+        return;
+    }
+    const double perSecond = r.roundsMs > 0 ? double(r.requests) * 1000.0 / double(r.roundsMs) : 0.0;
+    std::printf("%-6s clients=%d connect=%lldms rss=%lldKB (%.1fKB/conn) "
+                "requests=%llu in %lldms (%.0f/s) round p50=%lldus p99=%lldus\n",
+                name, clientCount, static_cast<long long>(r.connectMs), static_cast<long long>(r.rssKb),
+                double(r.rssKb) / double(std::max(1, clientCount)),
+                static_cast<unsigned long long>(r.requests), static_cast<long long>(r.roundsMs), perSecond,
+                static_cast<long long>(r.p50Us), static_cast<long long>(r.p99Us));
+}
+
+int argValue(const QStringList &args, const QString &name, int fallback)
+{
+    const int at = args.indexOf(name);
+    return at >= 0 && at + 1 < args.size() ? args.at(at + 1).toInt() : fallback;
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    const QStringList args = app.arguments();
+    const int clients = std::max(1, argValue(args, "--clients", 1000));
+    const int rounds = std::max(1, argValue(args, "--rounds", 20));
+    const quint16 port = quint16(argValue(args, "--port", 45000));
+    const int at = args.indexOf("--backend");
+    const QString which = at >= 0 && at + 1 < args.size() ? args.at(at + 1) : QString("both");
+
+    raiseFileLimit();
+    // Protokoll-Logs pro Nachricht wuerden die Messung dominieren
+    QLoggingCategory::setFilterRules("default.debug=false");
+
+    int failures = 0;
+    if (which == "qt" || which == "both") {
+        const BenchResult r = runBackend(GameServer::Backend::Qt, port, clients, rounds);
+        printResult("qt", r, clients);
+        failures += r.ok ? 0 : 1;
+    }
+    if (which == "epoll" || which == "both") {
+        if (!GameServer::isBackendAvailable(GameServer::Backend::Epoll)) {
+            std::printf("epoll  nicht verfuegbar\n");
+        } else {
+            const BenchResult r = runBackend(GameServer::Backend::Epoll, quint16(port + 1), clients, rounds);
+            printResult("epoll", r, clients);
+            failures += r.ok ? 0 : 1;
+        }
+    }
+    return failures == 0 ? 0 : 1;
+}
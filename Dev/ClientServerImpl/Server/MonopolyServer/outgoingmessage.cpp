@@ -0,0 +1,52 @@
+#include "outgoingmessage.h"
+
+OutgoingMessage::OutgoingMessage(const QJsonObject &obj)
+    : obj(obj)
+    , typeCode(Protocol::typeCode(obj.value("type").toString()))
+{
+    // ein Zug-Envelope mit Zustand veraltet genauso wie ein State-Frame
+    const bool envelope = typeCode == Protocol::TurnResult;
+    fullState = typeCode == Protocol::State || (envelope && obj.contains("state"));
+    stateFrame = fullState || typeCode == Protocol::StateDelta
+            || (envelope && obj.contains("delta"));
+}
+
+const QJsonObject &OutgoingMessage::object() const
+{
+    return obj;
+}
+
+bool OutgoingMessage::isEmpty() const
+{
+    return obj.isEmpty();
+}
+
+bool OutgoingMessage::isState() const
+{
+    return stateFrame;
+}
+
+bool OutgoingMessage::isFullState() const
+{
+    return fullState;
+}
+
+bool OutgoingMessage::isSequenced() const
+{
+    return typeCode != Protocol::Ping
+            && typeCode != Protocol::Welcome
+            && typeCode != Protocol::Resumed;
+}
+
+const QByteArray &OutgoingMessage::frame(Protocol::WireFormat format, bool *encoded)
+{
+    QByteArray &data = frames[int(format)];
+    const bool fresh = data.isEmpty();
+    if (fresh) {
+        data = Protocol::encode(obj, format);
+    }
+    if (encoded) {
+        *encoded = fresh;
+    }
+    return data;
+}
@@ -0,0 +1,41 @@
+#ifndef OUTGOINGMESSAGE_H
+#define OUTGOINGMESSAGE_H
+
+#include <QByteArray>
+#include <QJsonObject>
+
+#include "protocol.h"
+
+// Nachricht an einen oder mehrere Empfaenger. Wird je Wire-Format erst
+// beim ersten Bedarf und dann nur einmal kodiert; alle Empfaenger mit
+// gleichem Format bekommen denselben (implizit geteilten) Puffer.
+class OutgoingMessage
+{
+public:
+    OutgoingMessage() = default;
+    explicit OutgoingMessage(const QJsonObject &obj);
+
+    const QJsonObject &object() const;
+    bool isEmpty() const;
+
+    // state/stateDelta und turnResult mit "state"/"delta": darf bei
+    // Ueberlast durch einen neueren Vollzustand ersetzt werden;
+    // isFullState() = state oder turnResult mit "state", ersetzt alle aelteren
+    bool isState() const;
+    bool isFullState() const;
+
+    // bekommt in einer Sitzung eine seq (alles ausser ping/welcome/resumed)
+    bool isSequenced() const;
+
+    // encoded wird true, wenn der Frame gerade erst kodiert wurde
+    const QByteArray &frame(Protocol::WireFormat format, bool *encoded = nullptr);
+
+private:
+    QJsonObject obj;
+    int typeCode = Protocol::UnknownType;
+    bool stateFrame = false;
+    bool fullState = false;
+    QByteArray frames[Protocol::WireFormatCount];
+};
+
+#endif // OUTGOINGMESSAGE_H
@@ -1,32 +1,6 @@
 ﻿#include "player.h"
 
-void Player::move(int steps) {
-    position += steps;
-    if (position >= 40) {
-        position -= 40; // Startbonus koennte hier kommen
-        money += 300;          // Startfeld Bonus
-    }
-}
-
-
-
-void Player::pay(int amount)
-{
-    money -= amount;
-    if (money < 0)
-        isBankrupt = true;
-}
-
-void Player::receive(int amount)
-{
-    money += amount;
-}
-
-void Player::goToJail(int jailPos)
+bool Player::isReachable() const
 {
-    position = jailPos;
-    inJail = true;
-    jailTurns = 3;
+    return connection || suspended;
 }
-
-
@@ -1,11 +1,14 @@
 #ifndef PLAYER_H
 #define PLAYER_H
 
+#include <QElapsedTimer>
+#include <QJsonValue>
 #include <QString>
-#include <QTcpSocket>
-#include <QVector>
 
-class PropertyField; // Forward Declaration
+#include "protocol.h"
+#include "replaybuffer.h"
+
+class ClientConnection;
 
 class Player
 {
@@ -13,24 +16,32 @@ public:
     // Netzwerk
     int id = 0;
     QString name;
-    QTcpSocket* socket = nullptr;
-
-    // Spielstatus
-    int position = 0;
-    int money = 1500;
-
-    bool isBankrupt = false;
-    bool inJail = false;
-    int jailTurns = 0;
-    bool isReady = false;
-
-    QVector<PropertyField*> properties;
-
-    // Spielaktionen
-    void move(int steps);
-    void pay(int amount);
-    void receive(int amount);
-    void goToJail(int jailPos);
+    ClientConnection* connection = nullptr; // nullptr = nicht verbunden
+    bool deltaUpdates = false; // Client verarbeitet stateDelta (per getState {"delta":true})
+    bool stateSynced = false;  // hat den aktuellen Raum-Snapshot schon erhalten
+    bool catalogAware = false; // Client cached boardCatalog, State nur mit dynamischen Feldwerten
+    QString catalogHash;       // Hash des Katalogs, den der Client hat
+    Protocol::WireFormat wireFormat = Protocol::WireFormat::Json; // per hello/setWireFormat
+    int protocolVersion = 0;   // ausgehandelt per hello, 0 = alter Client ohne Handshake
+    bool turnResults = false;  // Zuege als ein turnResult-Envelope (per hello)
+    bool heartbeats = false;   // Client beantwortet ping (per hello)
+
+    // laufende Anfrage mit "rid": Antwort als ack bzw. nack statt error
+    QJsonValue requestId;      // Undefined = keine rid
+    QString requestType;
+    bool requestFailed = false;
+    QElapsedTimer requestTimer;
+
+    // Sitzung (per hello mit "resume"): Nachrichten tragen seq und landen
+    // im Replay-Puffer; bei Verbindungsabbruch bleibt der Platz reserviert
+    QString sessionToken;      // leer = keine Sitzung, Abbruch entfernt den Spieler
+    ReplayBuffer replay;
+    bool suspended = false;    // Verbindung weg, wartet auf resume
+    QElapsedTimer suspendedTimer;
+    bool isReachable() const;  // verbunden oder pausiert (Nachrichten werden gepuffert)
+
+    // Spielstand (Position, Geld, Besitz ...) steht im Raum als
+    // Engine::PlayerState mit derselben id
 };
 
 #endif // PLAYER_H
@@ -0,0 +1,65 @@
+#include "replaybuffer.h"
+
+ReplayBuffer::ReplayBuffer(int capacity)
+    : ring(capacity > 0 ? capacity : 1)
+{
+}
+
+quint64 ReplayBuffer::push(const QJsonObject &obj)
+{
+    const int capacity = ring.size();
+    const int slot = (head + count) % capacity;
+    ring[slot].seq = nextSeq;
+    ring[slot].obj = obj; // implizit geteilt, keine Kopie der Daten
+    if (count < capacity) {
+        count++;
+    } else {
+        head = (head + 1) % capacity;
+    }
+    return nextSeq++;
+}
+
+quint64 ReplayBuffer::lastSeq() const
+{
+    return nextSeq - 1;
+}
+
+bool ReplayBuffer::since(quint64 afterSeq, QVector<Entry> *out) const
+{
+    out->clear();
+    if (afterSeq > lastSeq()) {
+        // seq, die wir nie vergeben haben (Server neu gestartet): Luecke unbekannt
+        return false;
+    }
+    if (afterSeq == lastSeq()) {
+        return true;
+    }
+
+    const quint64 oldest = count > 0 ? ring[head].seq : nextSeq;
+    if (afterSeq + 1 < oldest) {
+        return false;
+    }
+
+    const int capacity = ring.size();
+    const int skip = int(afterSeq + 1 - oldest);
+    out->reserve(count - skip);
+    for (int i = skip; i < count; ++i) {
+        out->append(ring[(head + i) % capacity]);
+    }
+    return true;
+}
+
+void ReplayBuffer::clear()
+{
+    for (Entry &e : ring) {
+        e.obj = QJsonObject();
+    }
+    head = 0;
+    count = 0;
+}
+
+void ReplayBuffer::continueAfter(quint64 lastSeq)
+{
+    clear();
+    nextSeq = lastSeq + 1;
+}
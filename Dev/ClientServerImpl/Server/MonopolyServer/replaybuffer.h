@@ -0,0 +1,40 @@
+#ifndef REPLAYBUFFER_H
+#define REPLAYBUFFER_H
+
+#include <QJsonObject>
+#include <QVector>
+
+// Ringpuffer der letzten Nachrichten einer Sitzung mit fortlaufender seq.
+// Nach einem Reconnect bekommt der Client nur die Nachrichten nach seiner
+// letzten seq erneut, solange sie noch im Puffer liegen.
+class ReplayBuffer
+{
+public:
+    static constexpr int defaultCapacity = 256;
+
+    struct Entry {
+        quint64 seq = 0;
+        QJsonObject obj;
+    };
+
+    explicit ReplayBuffer(int capacity = defaultCapacity);
+
+    // vergibt die naechste seq
+    quint64 push(const QJsonObject &obj);
+    quint64 lastSeq() const;
+
+    // alle Nachrichten nach afterSeq; false, wenn schon welche verdraengt sind
+    bool since(quint64 afterSeq, QVector<Entry> *out) const;
+    void clear();
+
+    // Hot-Restart: leerer Puffer, seq geht nach lastSeq weiter
+    void continueAfter(quint64 lastSeq);
+
+private:
+    QVector<Entry> ring;
+    int head = 0;  // Index des aeltesten Eintrags
+    int count = 0;
+    quint64 nextSeq = 1;
+};
+
+#endif // REPLAYBUFFER_H
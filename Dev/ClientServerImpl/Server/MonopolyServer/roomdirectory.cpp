@@ -0,0 +1,190 @@
+#include "roomdirectory.h"
+#include "gameroom.h"
+
+#include <QJsonObject>
+#include <QMutexLocker>
+#include <algorithm>
+
+RoomDirectory::RoomDirectory(int shardCount)
+    : roomsPerShard(std::max(1, shardCount), 0)
+{
+}
+
+void RoomDirectory::placeNewConnection(int *roomId, int *shardIndex)
+{
+    QMutexLocker locker(&mutex);
+
+    int id = openRooms.empty() ? createRoomLocked(QString()) : *openRooms.begin();
+    RoomEntry &entry = rooms[id];
+    entry.seats++;
+    refreshOpenLocked(id, entry);
+
+    *roomId = id;
+    *shardIndex = entry.shardIndex;
+}
+
+int RoomDirectory::createRoom(const QString &name, int *shardIndex)
+{
+    QMutexLocker locker(&mutex);
+
+    const int id = createRoomLocked(name);
+    RoomEntry &entry = rooms[id];
+    entry.seats++;
+    refreshOpenLocked(id, entry);
+
+    *shardIndex = entry.shardIndex;
+    return id;
+}
+
+int RoomDirectory::reserveSeat(int roomId, QString *error)
+{
+    QMutexLocker locker(&mutex);
+
+    auto it = rooms.find(roomId);
+    if (it == rooms.end()) {
+        *error = QString("Raum %1 existiert nicht.").arg(roomId);
+        return -1;
+    }
+    if (it->second.seats >= GameRoom::maxPlayers) {
+        *error = QString("Raum %1 ist voll.").arg(roomId);
+        return -1;
+    }
+
+    it->second.seats++;
+    refreshOpenLocked(roomId, it->second);
+    return it->second.shardIndex;
+}
+
+void RoomDirectory::releaseSeat(int roomId)
+{
+    QMutexLocker locker(&mutex);
+
+    auto it = rooms.find(roomId);
+    if (it == rooms.end()) return;
+    it->second.seats = std::max(0, it->second.seats - 1);
+    refreshOpenLocked(roomId, it->second);
+}
+
+bool RoomDirectory::removeIfUnreserved(int roomId)
+{
+    QMutexLocker locker(&mutex);
+
+    auto it = rooms.find(roomId);
+    if (it == rooms.end()) return true;
+    if (it->second.seats > 0) return false;
+
+    roomsPerShard[it->second.shardIndex]--;
+    openRooms.erase(roomId);
+    rooms.erase(it);
+    return true;
+}
+
+void RoomDirectory::updateStatus(int roomId, bool started, bool finished)
+{
+    QMutexLocker locker(&mutex);
+
+    auto it = rooms.find(roomId);
+    if (it == rooms.end()) return;
+    it->second.started = started;
+    it->second.finished = finished;
+    refreshOpenLocked(roomId, it->second);
+}
+
+QString RoomDirectory::roomName(int roomId) const
+{
+    QMutexLocker locker(&mutex);
+
+    auto it = rooms.find(roomId);
+    return it == rooms.end() ? QString() : it->second.name;
+}
+
+QJsonArray RoomDirectory::listRooms() const
+{
+    QMutexLocker locker(&mutex);
+
+    QJsonArray arr;
+    for (const auto &item : rooms) {
+        QJsonObject info;
+        info["roomId"] = item.first;
+        info["name"] = item.second.name;
+        info["players"] = item.second.seats;
+        info["maxPlayers"] = GameRoom::maxPlayers;
+        info["gameStarted"] = item.second.started;
+        info["gameFinished"] = item.second.finished;
+        arr.append(info);
+    }
+    return arr;
+}
+
+int RoomDirectory::roomCount(int shardIndex) const
+{
+    QMutexLocker locker(&mutex);
+    return roomsPerShard.value(shardIndex, 0);
+}
+
+void RoomDirectory::registerSession(const QString &token, int roomId)
+{
+    QMutexLocker locker(&mutex);
+    sessions.insert(token, roomId);
+}
+
+int RoomDirectory::sessionRoom(const QString &token, int *shardIndex) const
+{
+    QMutexLocker locker(&mutex);
+
+    const int roomId = sessions.value(token, -1);
+    auto it = rooms.find(roomId);
+    if (it == rooms.end()) return -1;
+    *shardIndex = it->second.shardIndex;
+    return roomId;
+}
+
+void RoomDirectory::endSession(const QString &token)
+{
+    QMutexLocker locker(&mutex);
+    sessions.remove(token);
+}
+
+int RoomDirectory::restoreRoom(int roomId, const QString &name)
+{
+    QMutexLocker locker(&mutex);
+
+    nextRoomId = std::max(nextRoomId, roomId + 1);
+    return addRoomLocked(roomId, name);
+}
+
+void RoomDirectory::reserveRoomIds(int maxRoomId)
+{
+    QMutexLocker locker(&mutex);
+    nextRoomId = std::max(nextRoomId, maxRoomId + 1);
+}
+
+int RoomDirectory::createRoomLocked(const QString &name)
+{
+    const int id = nextRoomId++;
+    addRoomLocked(id, name);
+    return id;
+}
+
+int RoomDirectory::addRoomLocked(int id, const QString &name)
+{
+    // neuer Tisch auf den Shard mit den wenigsten Raeumen
+    const auto least = std::min_element(roomsPerShard.begin(), roomsPerShard.end());
+    const int shardIndex = int(std::distance(roomsPerShard.begin(), least));
+    roomsPerShard[shardIndex]++;
+
+    RoomEntry entry;
+    entry.shardIndex = shardIndex;
+    entry.name = name.isEmpty() ? QString("Tisch %1").arg(id) : name.left(30);
+    rooms.emplace(id, entry);
+    return shardIndex;
+}
+
+void RoomDirectory::refreshOpenLocked(int roomId, const RoomEntry &entry)
+{
+    if (!entry.started && !entry.finished && entry.seats < GameRoom::maxPlayers) {
+        openRooms.insert(roomId);
+    } else {
+        openRooms.erase(roomId);
+    }
+}
@@ -0,0 +1,70 @@
+#ifndef ROOMDIRECTORY_H
+#define ROOMDIRECTORY_H
+
+#include <QHash>
+#include <QJsonArray>
+#include <QMutex>
+#include <QString>
+#include <QVector>
+#include <map>
+#include <set>
+
+// Thread-sicheres Verzeichnis aller Raeume ueber alle Shards hinweg.
+// Haelt nur Metadaten (Shard, Name, belegte Plaetze, Status) -
+// das eigentliche Spiel lebt im GameRoom auf dem Shard-Thread.
+class RoomDirectory
+{
+public:
+    explicit RoomDirectory(int shardCount);
+
+    // Neue Verbindung: freien Platz an einem offenen Tisch reservieren,
+    // sonst neuen Tisch auf dem am wenigsten belasteten Shard anlegen.
+    void placeNewConnection(int *roomId, int *shardIndex);
+
+    // Neuen Raum anlegen und direkt einen Platz reservieren
+    int createRoom(const QString &name, int *shardIndex);
+
+    // Raum aus dem Journal mit seiner alten ID anlegen (ohne Plaetze), liefert den Shard
+    int restoreRoom(int roomId, const QString &name);
+    // neue Raeume bekommen IDs ueber maxRoomId (alte IDs im Journal nicht wiederverwenden)
+    void reserveRoomIds(int maxRoomId);
+
+    // Platz in bestehendem Raum reservieren; -1 + Fehlermeldung wenn nicht moeglich
+    int reserveSeat(int roomId, QString *error);
+    void releaseSeat(int roomId);
+
+    // Raum nur entfernen, wenn keine Plaetze mehr reserviert sind
+    bool removeIfUnreserved(int roomId);
+
+    void updateStatus(int roomId, bool started, bool finished);
+    QString roomName(int roomId) const;
+    QJsonArray listRooms() const;
+    int roomCount(int shardIndex) const;
+
+    // Sitzungen (resume): Token -> Raum des Spielers, ueber alle Shards
+    void registerSession(const QString &token, int roomId);
+    int sessionRoom(const QString &token, int *shardIndex) const; // -1 = unbekannt
+    void endSession(const QString &token);
+
+private:
+    struct RoomEntry {
+        int shardIndex = 0;
+        QString name;
+        int seats = 0;
+        bool started = false;
+        bool finished = false;
+    };
+
+    mutable QMutex mutex;
+    std::map<int, RoomEntry> rooms;
+    std::set<int> openRooms; // nicht gestartet und nicht voll
+    QVector<int> roomsPerShard;
+    QHash<QString, int> sessions;
+    int nextRoomId = 1;
+
+    int createRoomLocked(const QString &name);
+    int addRoomLocked(int id, const QString &name);
+    void refreshOpenLocked(int roomId, const RoomEntry &entry);
+};
+
+#endif // ROOMDIRECTORY_H
@@ -0,0 +1,85 @@
+#include "roomrandom.h"
+
+namespace {
+
+inline quint64 rotl(quint64 x, int k)
+{
+    return (x << k) | (x >> (64 - k));
+}
+
+} // namespace
+
+RoomRandom::RoomRandom(quint64 seed)
+    : initialSeed(seed)
+{
+    // SplitMix64 fuellt den Zustand, auch Seed 0 ergibt keinen Nullzustand
+    quint64 x = seed;
+    for (quint64 &s : state) {
+        x += 0x9E3779B97F4A7C15ull;
+        s = mix(x);
+    }
+}
+
+quint64 RoomRandom::seed() const
+{
+    return initialSeed;
+}
+
+quint64 RoomRandom::draws() const
+{
+    return drawn;
+}
+
+quint64 RoomRandom::next()
+{
+    const quint64 result = rotl(state[1] * 5, 7) * 9;
+    const quint64 t = state[1] << 17;
+
+    state[2] ^= state[0];
+    state[3] ^= state[1];
+    state[1] ^= state[2];
+    state[0] ^= state[3];
+    state[2] ^= t;
+    state[3] = rotl(state[3], 45);
+
+    drawn++;
+    return result;
+}
+
+quint32 RoomRandom::bounded(quint32 bound)
+{
+    if (bound <= 1) return 0;
+
+    // Lemire: Multiplizieren statt Modulo, selten ein zweiter Versuch
+    quint64 m = (next() >> 32) * bound;
+    quint32 low = quint32(m);
+    if (low < bound) {
+        const quint32 threshold = quint32(-bound) % bound;
+        while (low < threshold) {
+            m = (next() >> 32) * bound;
+            low = quint32(m);
+        }
+    }
+    return quint32(m >> 32);
+}
+
+int RoomRandom::bounded(int low, int high)
+{
+    if (high <= low) return low;
+    return low + int(bounded(quint32(high - low)));
+}
+
+void RoomRandom::advanceTo(quint64 count)
+{
+    while (drawn < count) {
+        next();
+    }
+}
+
+quint64 RoomRandom::mix(quint64 value)
+{
+    quint64 z = value;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
@@ -0,0 +1,39 @@
+#ifndef ROOMRANDOM_H
+#define ROOMRANDOM_H
+
+#include <QtGlobal>
+
+// Zufall eines Raums: xoshiro256** (Blackman/Vigna), Zustand per
+// SplitMix64 aus einem 64-Bit-Seed. Jeder Raum hat seinen eigenen
+// Generator, kein Lock und keine Konkurrenz zwischen den Shards.
+//
+// Derselbe Seed liefert dieselben Wuerfel und Karten: Seed und Anzahl
+// gezogener Zahlen stehen im Journal und im Checkpoint, eine Partie
+// laesst sich damit exakt nachspielen.
+class RoomRandom
+{
+public:
+    explicit RoomRandom(quint64 seed = 0);
+
+    quint64 seed() const;
+    quint64 draws() const; // bisher gezogene 64-Bit-Zahlen
+
+    quint64 next();
+
+    // gleichverteilt in [0, bound) bzw. [low, high), ohne Modulo-Verzerrung
+    quint32 bounded(quint32 bound);
+    int bounded(int low, int high);
+
+    // weiterziehen bis draws() == count (Wiederherstellung auf denselben Stand)
+    void advanceTo(quint64 count);
+
+    // SplitMix64-Schritt, auch zum Ableiten von Seeds
+    static quint64 mix(quint64 value);
+
+private:
+    quint64 state[4];
+    quint64 initialSeed;
+    quint64 drawn = 0;
+};
+
+#endif // ROOMRANDOM_H
@@ -0,0 +1,1381 @@
+#include "roomshard.h"
+#include "gameserver.h"
+#include "roomdirectory.h"
+#include "handover.h"
+#include "tcptransport.h"
+#ifdef MONOPOLY_EPOLL
+#include "epolltransport.h"
+#endif
+
+#include <QJsonArray>
+#include <QRandomGenerator>
+#include <QThread>
+#include <QDebug>
+#include <utility>
+
+RoomShard::RoomShard(GameServer &server, RoomDirectory &directory, int index)
+    : server(server)
+    , directory(directory)
+    , index(index)
+    , wheel(wheelSlots)
+    , heartbeatTimer(this)
+    , journalTimer(this)
+{
+    clock.start();
+    connect(&heartbeatTimer, &QTimer::timeout,
+            this, &RoomShard::onHeartbeatTick);
+    connect(&journalTimer, &QTimer::timeout,
+            this, &RoomShard::onJournalTick);
+}
+
+RoomShard::~RoomShard()
+{
+    // Raeume zuerst abbauen, danach die Verbindungen
+    rooms.clear();
+    for (auto &entry : connections) {
+        entry.second->getTransport().detach();
+    }
+    connections.clear();
+    retired.clear();
+}
+
+int RoomShard::getIndex() const
+{
+    return index;
+}
+
+const ShardStats &RoomShard::getStats() const
+{
+    return stats;
+}
+
+void RoomShard::setHeartbeat(int intervalMs, int maxMissed)
+{
+    heartbeatIntervalMs = qMax(wheelSlots, intervalMs);
+    maxMissedPings = qMax(1, maxMissed);
+    if (heartbeatTimer.isActive()) {
+        heartbeatTimer.start(heartbeatIntervalMs / wheelSlots);
+    }
+}
+
+void RoomShard::setResumeGrace(int graceMs)
+{
+    resumeGraceMs = qMax(0, graceMs);
+}
+
+void RoomShard::setRoomSeed(quint64 seed)
+{
+    fixedSeed = true;
+    baseSeed = seed;
+}
+
+quint64 RoomShard::roomSeed(int roomId) const
+{
+    if (fixedSeed) {
+        return RoomRandom::mix(baseSeed + quint64(roomId));
+    }
+    return QRandomGenerator::system()->generate64();
+}
+
+void RoomShard::setJournal(GameJournal *journal)
+{
+    this->journal = journal;
+    if (!journal) {
+        journalTimer.stop();
+        return;
+    }
+    for (auto &entry : rooms) {
+        entry.second->writeJournalSnapshot();
+    }
+    journalTimer.start(journal->snapshotIntervalMs());
+}
+
+GameJournal *RoomShard::getJournal() const
+{
+    return journal;
+}
+
+void RoomShard::requestJournalSnapshot(int roomId)
+{
+    // Raum kann bis dahin geschlossen sein
+    QMetaObject::invokeMethod(this, [this, roomId]() {
+        auto it = rooms.find(roomId);
+        if (it != rooms.end()) {
+            it->second->writeJournalSnapshot();
+        }
+    }, Qt::QueuedConnection);
+}
+
+void RoomShard::onJournalTick()
+{
+    // spaetestens jetzt: haelt die Wiederherstellung kurz und
+    // gibt alte Journal-Segmente frei
+    for (auto &entry : rooms) {
+        if (entry.second->hasUnsavedJournal()) {
+            entry.second->writeJournalSnapshot();
+        }
+    }
+}
+
+bool RoomShard::restoreRoom(const RoomRestore &restore)
+{
+    const int roomId = restore.state.roomId;
+    auto room = std::make_unique<GameRoom>(*this, roomId, directory.roomName(roomId));
+    room->restore(restore.state, restore.events);
+
+    QHash<int, ConnectionState> handedOver;
+    for (const ConnectionState &connection : restore.connections) {
+        handedOver.insert(connection.playerId, connection);
+    }
+
+    for (Player *player : room->allPlayers()) {
+        QString error;
+        // Hot-Restart: Verbindung lebt weiter, der Spieler merkt nichts
+        if (handedOver.contains(player->id)) {
+            const ConnectionState connection = handedOver.take(player->id);
+            if (directory.reserveSeat(roomId, &error) >= 0) {
+                if (adoptHandedOver(*room, *player, connection)) {
+                    if (!player->sessionToken.isEmpty()) {
+                        directory.registerSession(player->sessionToken, roomId);
+                    }
+                    continue;
+                }
+                directory.releaseSeat(roomId);
+            }
+            Handover::closeDescriptor(connection.fd);
+        }
+
+        // ohne Sitzung kann niemand seinen Platz zurueckholen
+        if (player->sessionToken.isEmpty() || resumeGraceMs <= 0
+            || directory.reserveSeat(roomId, &error) < 0) {
+            room->removePlayer(player, "playerLeft");
+            continue;
+        }
+        directory.registerSession(player->sessionToken, roomId);
+        armSessionExpiry(roomId, *player);
+    }
+
+    // Verbindungen zu Spielern, die es nicht mehr gibt
+    for (const ConnectionState &connection : std::as_const(handedOver)) {
+        Handover::closeDescriptor(connection.fd);
+    }
+
+    if (room->isEmpty()) {
+        directory.removeIfUnreserved(roomId);
+        return false;
+    }
+
+    GameRoom *restored = room.get();
+    rooms.emplace(roomId, std::move(room));
+    stats.rooms++;
+    publishRoomStatus(*restored);
+    if (journal) {
+        restored->writeJournalSnapshot();
+    }
+
+    qDebug() << "[SHARD" << index << "] Raum wiederhergestellt:" << roomId << restored->getName()
+             << "| players=" << restored->playerCount();
+    return true;
+}
+
+QVector<RoomState> RoomShard::captureRooms() const
+{
+    QVector<RoomState> states;
+    states.reserve(int(rooms.size()));
+    for (const auto &entry : rooms) {
+        states.append(entry.second->captureState());
+    }
+    return states;
+}
+
+void RoomShard::pauseForHandover()
+{
+    // ab hier aendert sich kein Raum mehr; was eintrifft, bleibt im Socket
+    // und geht mit an den Nachfolger
+    handingOver = true;
+#ifdef MONOPOLY_EPOLL
+    // neue Verbindungen bleiben in der Accept-Queue, die Listener gehen mit
+    if (epollLoop) {
+        epollLoop->pauseListening();
+    }
+#endif
+    for (auto &entry : connections) {
+        ClientConnection &connection = *entry.second;
+        writeConnection(connection);
+        connection.getTransport().flush();
+    }
+}
+
+bool RoomShard::isDrained() const
+{
+    for (const auto &entry : connections) {
+        ClientConnection &connection = *entry.second;
+        if (connection.closing) continue;
+        if (connection.hasQueued() || connection.getTransport().bytesToWrite() > 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+QVector<RoomRestore> RoomShard::releaseForHandover()
+{
+    QVector<RoomRestore> released;
+    released.reserve(int(rooms.size()));
+    int handed = 0;
+
+    for (auto &entry : rooms) {
+        GameRoom &room = *entry.second;
+        RoomRestore restore;
+        restore.state = room.captureState();
+
+        for (Player *player : room.allPlayers()) {
+            ClientConnection *connection = player->connection;
+            if (!owns(connection) || connection->closing) continue;
+
+            // Rest aus dem Socket-Puffer mitnehmen, danach liest hier niemand mehr
+            Transport &transport = connection->getTransport();
+            transport.readInto(connection->getReader());
+            const int fd = transport.releaseDescriptor();
+            if (fd < 0) continue; // lokal, Loopback oder nicht leer geschrieben:
+                                  // bricht mit diesem Prozess ab
+
+            ConnectionState state;
+            state.playerId = player->id;
+            state.fd = fd;
+            state.pending = connection->getReader().pending();
+            state.wireFormat = player->wireFormat;
+            state.protocolVersion = player->protocolVersion;
+            state.heartbeats = player->heartbeats;
+            state.deltaUpdates = player->deltaUpdates;
+            state.catalogAware = player->catalogAware;
+            state.catalogHash = player->catalogHash;
+            state.turnResults = player->turnResults;
+            state.lastSeq = player->replay.lastSeq();
+            restore.connections.append(state);
+
+            retireConnection(detachConnection(connection));
+            player->connection = nullptr;
+            handed++;
+        }
+        released.append(restore);
+    }
+
+    qDebug() << "[SHARD" << index << "] Uebergabe: rooms=" << released.size()
+             << "connections=" << handed;
+    return released;
+}
+
+void RoomShard::resumeAfterHandover(const QVector<RoomRestore> &released)
+{
+    handingOver = false;
+
+    for (const RoomRestore &restore : released) {
+        for (const ConnectionState &connection : restore.connections) {
+            // loseConnection() kann den Raum schliessen
+            auto it = rooms.find(restore.state.roomId);
+            GameRoom *room = it != rooms.end() ? it->second.get() : nullptr;
+            Player *player = room ? room->findPlayerById(connection.playerId) : nullptr;
+            if (player && adoptHandedOver(*room, *player, connection)) continue;
+
+            Handover::closeDescriptor(connection.fd);
+            if (player) {
+                loseConnection(*room, *player);
+            }
+        }
+    }
+
+    // waehrend der Pause Angekommenes; epoll meldet es (edge-triggered) nicht noch einmal
+    for (auto &entry : connections) {
+        ClientConnection *connection = entry.first;
+        const quint64 serial = connection->serial;
+        QMetaObject::invokeMethod(this, [this, connection, serial]() {
+            if (owns(connection) && connection->serial == serial) {
+                readFromConnection(connection);
+            }
+        }, Qt::QueuedConnection);
+    }
+#ifdef MONOPOLY_EPOLL
+    if (epollLoop) {
+        epollLoop->resumeListening();
+    }
+#endif
+}
+
+Transport *RoomShard::wrapDescriptor(int fd)
+{
+#ifdef MONOPOLY_EPOLL
+    if (epollLoop) {
+        return new EpollTransport(fd);
+    }
+#endif
+    auto *socket = new QTcpSocket;
+    if (!socket->setSocketDescriptor(fd)) {
+        qWarning() << "[SHARD" << index << "] Socket" << fd << "nicht uebernehmbar:" << socket->errorString();
+        delete socket;
+        return nullptr;
+    }
+    return new TcpTransport(socket);
+}
+
+bool RoomShard::adoptHandedOver(GameRoom &room, Player &player, const ConnectionState &state)
+{
+    Transport *transport = wrapDescriptor(state.fd);
+    if (!transport) return false;
+
+    auto owned = std::make_unique<ClientConnection>(std::unique_ptr<Transport>(transport), maxClientFrameSize);
+    ClientConnection *connection = owned.get();
+    connection->getReader().append(state.pending);
+
+    player.wireFormat = state.wireFormat;
+    player.protocolVersion = state.protocolVersion;
+    player.heartbeats = state.heartbeats;
+    player.turnResults = state.turnResults;
+    if (player.replay.lastSeq() != state.lastSeq) {
+        player.replay.continueAfter(state.lastSeq);
+    }
+    player.connection = connection;
+    player.suspended = false;
+    attachConnection(std::move(owned), player);
+    connectionRooms.insert(connection, &room);
+
+    // ein neues Binary kann einen anderen Katalog haben
+    room.enableStateCaps(player, state.deltaUpdates, state.catalogAware, state.catalogHash);
+
+    // Ungelesenes erst nach dem Aufbau des Raums verarbeiten
+    if (connection->getReader().hasPending() || transport->hasBytesAvailable()) {
+        const quint64 serial = connection->serial;
+        QMetaObject::invokeMethod(this, [this, connection, serial]() {
+            if (owns(connection) && connection->serial == serial) {
+                readFromConnection(connection);
+            }
+        }, Qt::QueuedConnection);
+    }
+    return true;
+}
+
+void RoomShard::adoptTransport(Transport *transport, int roomId)
+{
+    adoptConnection(new ClientConnection(std::unique_ptr<Transport>(transport), maxClientFrameSize),
+                    nullptr, roomId);
+}
+
+void RoomShard::adoptConnection(ClientConnection *connection, Player *player, int roomId)
+{
+    std::unique_ptr<ClientConnection> ownedConnection(connection);
+    std::unique_ptr<Player> owned(player);
+
+    // Verbindung ist waehrend der Uebergabe abgerissen
+    if (!connection->getTransport().isConnected()) {
+        qDebug() << "[SHARD" << index << "] Verbindung vor Uebernahme getrennt";
+        directory.releaseSeat(roomId);
+        return;
+    }
+
+    if (!owned) {
+        owned = std::make_unique<Player>();
+    }
+    owned->connection = connection;
+    attachConnection(std::move(ownedConnection), *owned);
+
+    GameRoom *room = ensureRoom(roomId);
+    connectionRooms.insert(connection, room);
+    Player *added = room->addPlayer(std::move(owned));
+    if (!added->sessionToken.isEmpty()) {
+        directory.registerSession(added->sessionToken, roomId);
+    }
+    publishRoomStatus(*room);
+
+    // joinRoom/createRoom von einem anderen Shard: Anfrage hier abschliessen
+    finishRequest(*added);
+
+    qDebug() << "[SHARD" << index << "] Client" << connection->getTransport().peerInfo()
+             << "in Raum" << roomId << "| rooms=" << rooms.size();
+
+    // Daten, die waehrend der Uebergabe angekommen sind
+    if (connection->getTransport().hasBytesAvailable() || connection->getReader().hasPending()) {
+        readFromConnection(connection);
+    }
+}
+
+ClientConnection &RoomShard::attachConnection(std::unique_ptr<ClientConnection> connection, const Player &player)
+{
+    ClientConnection *c = connection.get();
+    c->serial = nextSerial++;
+    c->closing = false;
+    c->heartbeat = player.heartbeats;
+    c->wheelSlot = nextWheelSlot;
+    nextWheelSlot = (nextWheelSlot + 1) % wheelSlots;
+    wheel[c->wheelSlot].append(c);
+    connections.emplace(c, std::move(connection));
+
+    if (!heartbeatTimer.isActive()) {
+        heartbeatTimer.start(heartbeatIntervalMs / wheelSlots);
+    }
+
+    Transport::Events events;
+    events.readable = [this, c]() { readFromConnection(c); };
+    events.writable = [this, c]() { onConnectionWritable(c); };
+    events.closed = [this, c]() { onConnectionClosed(c); };
+    c->getTransport().attach(events);
+    stats.connections++;
+    return *c;
+}
+
+void RoomShard::readFromConnection(ClientConnection *connection)
+{
+    if (!owns(connection) || connection->closing || handingOver) return;
+    stats.bytesIn += quint64(connection->getTransport().readInto(connection->getReader()));
+
+    // JSON-Zeilen und CBOR-Frames duerfen gemischt ankommen
+    QJsonObject msg;
+    QString error;
+    int code = Protocol::UnknownType;
+    while (true) {
+        // Verbindung kann waehrend der Verarbeitung an einen anderen Shard gehen
+        if (!owns(connection) || connection->closing) return;
+
+        const Protocol::FrameReader::Result result = connection->getReader().next(&msg, &error, &code);
+        if (result == Protocol::FrameReader::Result::Incomplete) break;
+
+        if (result == Protocol::FrameReader::Result::Malformed) {
+            qWarning() << "[SERVER]" << error;
+            continue;
+        }
+
+        if (result == Protocol::FrameReader::Result::TooLarge) {
+            rejectOversizedFrame(connection, error);
+            return;
+        }
+
+        GameRoom *room = connectionRooms.value(connection, nullptr);
+        Player *playerPtr = room ? room->findPlayerByConnection(connection) : nullptr;
+        if (!playerPtr) return;
+
+        // jede Nachricht zeigt, dass der Client lebt
+        connection->missedPings = 0;
+
+        stats.messagesIn++;
+        qDebug() << "[SERVER] <= from" << playerPtr->name << "room" << room->getId()
+                 << msg.value("type").toString();
+        processMessage(*room, *playerPtr, code, msg);
+    }
+}
+
+void RoomShard::rejectOversizedFrame(ClientConnection *connection, const QString &error)
+{
+    stats.oversizedFrames++;
+    qWarning() << "[SHARD" << index << "]" << error << "- Verbindung wird getrennt";
+
+    // Puffer freigeben; Aufraeumen macht onConnectionClosed
+    connection->getReader().clear();
+
+    GameRoom *room = connectionRooms.value(connection, nullptr);
+    Player *player = room ? room->findPlayerByConnection(connection) : nullptr;
+    if (player) {
+        QJsonObject err;
+        err["type"] = "error";
+        err["message"] = error;
+        sendToPlayer(*player, err);
+    }
+    writeConnection(*connection);
+
+    // nichts mehr lesen oder senden
+    connection->closing = true;
+    connection->getTransport().close();
+}
+
+const MessageTable<RoomShard> &RoomShard::messageTable()
+{
+    // Raumverwaltung und Verbindungs-Nachrichten; der Rest geht an den Raum
+    static const MessageTable<RoomShard> table = [] {
+        using J = QJsonValue;
+        MessageTable<RoomShard> t;
+        t.add(Protocol::ListRooms, [](RoomShard &s, Player &p, const QJsonObject &) {
+            s.handleListRooms(p);
+        });
+        t.add(Protocol::CreateRoom, [](RoomShard &s, Player &p, const QJsonObject &m) {
+            s.handleCreateRoom(s.roomOf(p), p, m.value("name").toString().trimmed());
+        }, {{"name", J::String, false}});
+        t.add(Protocol::JoinRoom, [](RoomShard &s, Player &p, const QJsonObject &m) {
+            s.handleJoinRoom(s.roomOf(p), p, m.value("roomId").toInt(-1));
+        }, {{"roomId", J::Double}});
+        t.add(Protocol::ServerStats, [](RoomShard &s, Player &p, const QJsonObject &) {
+            s.handleServerStats(p);
+        });
+        t.add(Protocol::Hello, [](RoomShard &s, Player &p, const QJsonObject &m) {
+            s.handleHello(s.roomOf(p), p, m);
+        }, {{"protocolVersion", J::Double}, {"caps", J::Array, false}, {"catalogHash", J::String, false}});
+        t.add(Protocol::Pong, [](RoomShard &s, Player &p, const QJsonObject &m) {
+            s.handlePong(p, m);
+        }, {{"seq", J::Double}, {"t", J::Double}});
+        t.add(Protocol::Resume, [](RoomShard &s, Player &p, const QJsonObject &m) {
+            // Cast nur im quint64-Bereich, NaN und Unsinn gelten als 0
+            const double lastSeq = m.value("lastSeq").toDouble();
+            s.handleResume(s.roomOf(p), p, m.value("session").toString(),
+                           lastSeq >= 0.0 && lastSeq < 18446744073709551616.0 ? quint64(lastSeq) : 0);
+        }, {{"session", J::String}, {"lastSeq", J::Double}});
+        t.add(Protocol::SetWireFormat, [](RoomShard &s, Player &p, const QJsonObject &m) {
+            s.handleSetWireFormat(p, m.value("format").toString());
+        }, {{"format", J::String}});
+        return t;
+    }();
+    return table;
+}
+
+void RoomShard::processMessage(GameRoom &room, Player &player, int code, const QJsonObject &msg)
+{
+    QString error;
+    bool valid = true;
+
+    // optionale Client-rid: Fehler gehen dann als nack an genau diese Anfrage
+    const QJsonValue rid = msg.value("rid");
+    if (!rid.isUndefined()) {
+        player.requestId = rid;
+        player.requestType = msg.value("type").toString();
+        player.requestFailed = false;
+        player.requestTimer.start();
+    }
+    ClientConnection *connection = player.connection;
+
+    if (messageTable().contains(code)) {
+        stats.messagesByType[code]++;
+        valid = messageTable().dispatch(code, *this, player, msg, &error);
+    } else if (GameRoom::messageTable().contains(code)) {
+        stats.messagesByType[code]++;
+        valid = GameRoom::messageTable().dispatch(code, room, player, msg, &error);
+        publishRoomStatus(room);
+    } else {
+        stats.unknownMessages++;
+        qWarning() << "[NET] Unknown type:" << msg.value("type").toString();
+        if (!rid.isUndefined()) {
+            QJsonObject err;
+            err["type"] = "error";
+            err["message"] = QString("Unbekannter Typ: %1").arg(msg.value("type").toString());
+            sendToPlayer(player, err);
+            finishRequest(player);
+        }
+        return;
+    }
+
+    if (!valid) {
+        stats.invalidMessages++;
+        qWarning() << "[NET] invalid" << msg.value("type").toString() << ":" << error;
+
+        QJsonObject err;
+        err["type"] = "error";
+        err["message"] = QString("Ungueltige Nachricht %1: %2")
+                             .arg(msg.value("type").toString(), error);
+        sendToPlayer(player, err);
+    }
+
+    // Spieler kann per joinRoom an einen anderen Shard gegangen sein,
+    // dann schliesst der die Anfrage in adoptConnection ab
+    if (owns(connection)) {
+        finishRequest(player);
+    }
+}
+
+void RoomShard::finishRequest(Player &player)
+{
+    if (player.requestId.isUndefined()) return;
+
+    if (!player.requestFailed) {
+        QJsonObject ack;
+        ack["type"] = "ack";
+        ack["rid"] = player.requestId;
+        ack["requestType"] = player.requestType;
+        ack["serverUs"] = qint64(player.requestTimer.nsecsElapsed() / 1000);
+        sendToPlayer(player, ack);
+    }
+    player.requestId = QJsonValue(QJsonValue::Undefined);
+    player.requestType.clear();
+    player.requestFailed = false;
+}
+
+GameRoom &RoomShard::roomOf(Player &player)
+{
+    // waehrend der Verarbeitung ist die Verbindung immer einem Raum zugeordnet
+    return *connectionRooms.value(player.connection);
+}
+
+void RoomShard::handleListRooms(Player &player)
+{
+    QJsonObject list;
+    list["type"] = "roomList";
+    list["rooms"] = directory.listRooms();
+    sendToPlayer(player, list);
+}
+
+void RoomShard::handleServerStats(Player &player)
+{
+    QJsonObject msg;
+    msg["type"] = "serverStats";
+    msg["shards"] = server.buildShardStats();
+    sendToPlayer(player, msg);
+}
+
+void RoomShard::handleHello(GameRoom &room, Player &player, const QJsonObject &msg)
+{
+    const int version = msg.value("protocolVersion").toInt(0);
+    if (version < Protocol::MinVersion) {
+        QJsonObject err;
+        err["type"] = "error";
+        err["message"] = QString("Protokollversion %1 wird nicht unterstuetzt (min. %2)")
+                             .arg(version).arg(Protocol::MinVersion);
+        sendToPlayer(player, err);
+        return;
+    }
+
+    QStringList offered;
+    for (const QJsonValue &v : msg.value("caps").toArray()) {
+        offered.append(v.toString());
+    }
+    const QStringList shared = Protocol::sharedCapabilities(offered);
+    player.protocolVersion = qMin(version, Protocol::Version);
+
+    // welcome geht schon im gemeinsamen Format raus
+    player.wireFormat = shared.contains(Protocol::CapCbor)
+            ? Protocol::WireFormat::Cbor : Protocol::WireFormat::Json;
+
+    QJsonObject welcome;
+    welcome["type"] = "welcome";
+    welcome["protocolVersion"] = player.protocolVersion;
+    welcome["caps"] = QJsonArray::fromStringList(shared);
+    welcome["playerId"] = player.id;
+    welcome["roomId"] = room.getId();
+    if (shared.contains(Protocol::CapHeartbeat)) {
+        welcome["heartbeatMs"] = heartbeatIntervalMs;
+        welcome["maxMissed"] = maxMissedPings;
+        player.heartbeats = true;
+        if (player.connection) {
+            player.connection->heartbeat = true;
+        }
+    }
+
+    // Sitzung: Token zum Fortsetzen nach einem Verbindungsabbruch
+    QString session;
+    if (shared.contains(Protocol::CapResume) && resumeGraceMs > 0) {
+        session = player.sessionToken;
+        if (session.isEmpty()) {
+            quint32 raw[4];
+            QRandomGenerator::system()->fillRange(raw);
+            session = QString::fromLatin1(QByteArray(reinterpret_cast<const char *>(raw), sizeof(raw)).toHex());
+        }
+        welcome["session"] = session;
+        welcome["resumeGraceMs"] = resumeGraceMs;
+    }
+    sendToPlayer(player, welcome);
+
+    // erst ab jetzt tragen Nachrichten eine seq
+    if (!session.isEmpty() && player.sessionToken.isEmpty()) {
+        room.setSessionToken(player, session);
+        directory.registerSession(session, room.getId());
+    }
+
+    player.turnResults = shared.contains(Protocol::CapTurnResult);
+    room.enableStateCaps(player,
+                         shared.contains(Protocol::CapDelta),
+                         shared.contains(Protocol::CapCatalog),
+                         msg.value("catalogHash").toString());
+
+    qDebug() << "[SHARD" << index << "]" << player.name << "hello v" << version
+             << "caps=" << shared.join(",");
+}
+
+void RoomShard::handlePong(Player &player, const QJsonObject &msg)
+{
+    ClientConnection *connection = player.connection;
+    // Werte kommen vom Client: als double vergleichen, erst dann casten
+    if (!connection || msg.value("seq").toDouble() != double(connection->pingSeq)) {
+        return; // veraltete Antwort
+    }
+    const qint64 now = clock.elapsed();
+    const double sentAt = msg.value("t").toDouble();
+    if (!(sentAt >= 0.0 && sentAt <= double(now))) {
+        return; // nicht unser Zeitstempel
+    }
+
+    const qint64 sample = now - qint64(sentAt);
+    connection->addRttSample(sample);
+    connection->awaitingPong = false;
+
+    // Shard-Mittel ebenfalls geglaettet
+    const int avg = stats.rttAvgMs.load();
+    stats.rttAvgMs = avg == 0 ? int(sample) : int(0.875 * avg + 0.125 * double(sample));
+}
+
+void RoomShard::onHeartbeatTick()
+{
+    if (handingOver) return;
+
+    const QVector<ClientConnection*> slot = wheel[wheelPos];
+    for (ClientConnection *connection : slot) {
+        if (!owns(connection) || connection->closing || !connection->heartbeat) continue;
+
+        // Ping noch offen: keinen neuen schicken, sonst passt bei einer RTT
+        // ueber dem Intervall (oder hinter der Ueberlast-Queue) nie ein Pong
+        if (connection->awaitingPong) {
+            if (++connection->missedPings >= maxMissedPings) {
+                stats.deadPeersEvicted++;
+                qWarning() << "[SHARD" << index << "] Client antwortet nicht ("
+                           << connection->missedPings << "pings), trenne Verbindung.";
+                closeConnectionLater(*connection);
+            }
+            continue;
+        }
+
+        QJsonObject ping;
+        ping["type"] = "ping";
+        ping["seq"] = qint64(++connection->pingSeq);
+        ping["t"] = clock.elapsed();
+        if (connection->smoothedRttMs() >= 0) {
+            ping["rttMs"] = qRound(connection->smoothedRttMs());
+            roundRttMaxMs = qMax(roundRttMaxMs, qRound(connection->smoothedRttMs()));
+        }
+        OutgoingMessage msg(ping);
+        GameRoom *room = connectionRooms.value(connection, nullptr);
+        Player *player = room ? room->findPlayerByConnection(connection) : nullptr;
+        if (player) {
+            sendMessage(*player, msg);
+            connection->awaitingPong = true;
+            stats.pingsSent++;
+        }
+    }
+
+    wheelPos = (wheelPos + 1) % wheelSlots;
+    if (wheelPos == 0) {
+        stats.rttMaxMs = roundRttMaxMs;
+        roundRttMaxMs = 0;
+    }
+}
+
+void RoomShard::handleResume(GameRoom &room, Player &player, const QString &token, quint64 lastSeq)
+{
+    int shardIndex = 0;
+    const int roomId = token == player.sessionToken ? -1 : directory.sessionRoom(token, &shardIndex);
+    if (roomId < 0) {
+        QJsonObject reply;
+        reply["type"] = "resumed";
+        reply["ok"] = false;
+        reply["session"] = player.sessionToken;
+        reply["message"] = "Sitzung abgelaufen";
+        sendToPlayer(player, reply);
+        return;
+    }
+
+    // vorlaeufigen Spieler der neuen Verbindung aufgeben, die Verbindung geht
+    // (ggf. an einen anderen Shard) zum pausierten Platz der Sitzung
+    ClientConnection *connection = player.connection;
+    std::unique_ptr<Player> fresh = room.removePlayer(&player, "playerLeft");
+    if (!fresh) return;
+    directory.releaseSeat(room.getId());
+    publishRoomStatus(room);
+
+    writeConnection(*connection);
+    std::unique_ptr<ClientConnection> moving = detachConnection(connection);
+    removeRoomIfEmpty(room);
+
+    RoomShard *target = server.shardAt(shardIndex);
+    if (target != this) {
+        moving->getTransport().moveToThread(target->thread());
+    }
+
+    // auch im selben Shard erst nach dieser Nachricht, wir stecken noch in readFromConnection
+    ClientConnection *rawConnection = moving.release();
+    Player *raw = fresh.release();
+    QMetaObject::invokeMethod(target, [target, rawConnection, raw, roomId, token, lastSeq]() {
+        target->resumeConnection(rawConnection, raw, roomId, token, lastSeq);
+    }, Qt::QueuedConnection);
+}
+
+void RoomShard::resumeConnection(ClientConnection *connection, Player *fresh, int roomId,
+                                 const QString &token, quint64 lastSeq)
+{
+    std::unique_ptr<ClientConnection> ownedConnection(connection);
+    std::unique_ptr<Player> owned(fresh);
+
+    if (!connection->getTransport().isConnected()) {
+        if (!owned->sessionToken.isEmpty()) {
+            directory.endSession(owned->sessionToken);
+        }
+        return;
+    }
+
+    auto it = rooms.find(roomId);
+    Player *player = it != rooms.end() ? it->second->findPlayerBySession(token) : nullptr;
+    if (!player) {
+        // Sitzung gerade abgelaufen: wie eine neue Verbindung behandeln
+        QJsonObject reply;
+        reply["type"] = "resumed";
+        reply["ok"] = false;
+        reply["session"] = owned->sessionToken;
+        reply["message"] = "Sitzung abgelaufen";
+        connection->getTransport().write(Protocol::encode(reply, owned->wireFormat));
+
+        int newRoomId = -1;
+        int shardIndex = 0;
+        directory.placeNewConnection(&newRoomId, &shardIndex);
+        RoomShard *target = server.shardAt(shardIndex);
+        if (target == this) {
+            adoptConnection(ownedConnection.release(), owned.release(), newRoomId);
+        } else {
+            connection->getTransport().moveToThread(target->thread());
+            ClientConnection *rawConnection = ownedConnection.release();
+            Player *raw = owned.release();
+            QMetaObject::invokeMethod(target, [target, rawConnection, raw, newRoomId]() {
+                target->adoptConnection(rawConnection, raw, newRoomId);
+            }, Qt::QueuedConnection);
+        }
+        return;
+    }
+    GameRoom &room = *it->second;
+
+    // alte Verbindung noch nicht als tot erkannt (halb offen): ersetzen
+    if (ClientConnection *old = player->connection) {
+        std::unique_ptr<ClientConnection> replaced = detachConnection(old);
+        replaced->getTransport().abort();
+        retireConnection(std::move(replaced));
+    }
+
+    // Faehigkeiten der neuen Verbindung uebernehmen; bei anderen State-
+    // Faehigkeiten passen die gepufferten Nachrichten nicht mehr
+    const bool compatible = player->deltaUpdates == owned->deltaUpdates
+            && player->catalogAware == owned->catalogAware
+            && player->turnResults == owned->turnResults;
+    player->wireFormat = owned->wireFormat;
+    player->protocolVersion = owned->protocolVersion;
+    player->heartbeats = owned->heartbeats;
+    player->deltaUpdates = owned->deltaUpdates;
+    player->catalogAware = owned->catalogAware;
+    player->catalogHash = owned->catalogHash;
+    player->turnResults = owned->turnResults;
+    // offene resume-Anfrage mit rid: das ack gehoert dem fortgesetzten Spieler
+    player->requestId = owned->requestId;
+    player->requestType = owned->requestType;
+    player->requestFailed = owned->requestFailed;
+    player->requestTimer = owned->requestTimer;
+    if (!owned->sessionToken.isEmpty()) {
+        directory.endSession(owned->sessionToken);
+    }
+
+    player->connection = connection;
+    player->suspended = false;
+    attachConnection(std::move(ownedConnection), *player);
+    connectionRooms.insert(connection, &room);
+
+    QVector<ReplayBuffer::Entry> missed;
+    const bool complete = compatible && player->replay.since(lastSeq, &missed);
+
+    QJsonObject reply;
+    reply["type"] = "resumed";
+    reply["ok"] = true;
+    reply["session"] = token;
+    reply["playerId"] = player->id;
+    reply["roomId"] = roomId;
+    reply["lastSeq"] = qint64(player->replay.lastSeq());
+    reply["replayed"] = complete ? missed.size() : 0;
+    reply["complete"] = complete;
+    sendToPlayer(*player, reply);
+
+    // verpasste Nachrichten mit ihrer urspruenglichen seq
+    if (complete) {
+        for (const ReplayBuffer::Entry &entry : missed) {
+            const QByteArray frame = Protocol::withSequence(
+                    Protocol::encode(entry.obj, player->wireFormat), player->wireFormat, entry.seq);
+            stats.framesEncoded++;
+            sendFrame(*connection, frame, false);
+        }
+        stats.messagesReplayed += quint64(missed.size());
+    }
+    room.resumePlayer(*player, connection, complete);
+    stats.sessionsResumed++;
+    finishRequest(*player);
+
+    qDebug() << "[SHARD" << index << "]" << player->name << "setzt Sitzung fort, Raum" << roomId
+             << "| lastSeq=" << lastSeq << "replayed=" << (complete ? missed.size() : 0);
+
+    if (connection->getTransport().hasBytesAvailable() || connection->getReader().hasPending()) {
+        readFromConnection(connection);
+    }
+}
+
+void RoomShard::expireSession(int roomId, const QString &token, qint64 suspendedAt)
+{
+    auto it = rooms.find(roomId);
+    if (it == rooms.end()) return;
+    GameRoom &room = *it->second;
+
+    // inzwischen fortgesetzt oder erneut pausiert (dann laeuft ein neuer Timer)
+    Player *player = room.findPlayerBySession(token);
+    if (!player || !player->suspended
+        || player->suspendedTimer.msecsSinceReference() != suspendedAt) {
+        return;
+    }
+
+    qDebug() << "[SHARD" << index << "] Sitzung abgelaufen:" << player->name;
+    stats.sessionsExpired++;
+    directory.endSession(token);
+    room.removePlayer(player, "playerLeft");
+    directory.releaseSeat(roomId);
+    publishRoomStatus(room);
+    removeRoomIfEmpty(room);
+}
+
+void RoomShard::armSessionExpiry(int roomId, const Player &player)
+{
+    const QString token = player.sessionToken;
+    const qint64 suspendedAt = player.suspendedTimer.msecsSinceReference();
+    QTimer::singleShot(resumeGraceMs, this, [this, roomId, token, suspendedAt]() {
+        expireSession(roomId, token, suspendedAt);
+    });
+}
+
+void RoomShard::handleSetWireFormat(Player &player, const QString &format)
+{
+    Protocol::WireFormat wanted;
+    if (!Protocol::parseFormat(format, &wanted)) {
+        QJsonObject err;
+        err["type"] = "error";
+        err["message"] = QString("Unbekanntes Format: %1").arg(format);
+        sendToPlayer(player, err);
+        return;
+    }
+
+    // Bestaetigung geht schon im neuen Format raus
+    player.wireFormat = wanted;
+
+    QJsonObject reply;
+    reply["type"] = "wireFormat";
+    reply["format"] = Protocol::formatName(wanted);
+    sendToPlayer(player, reply);
+
+    qDebug() << "[SHARD" << index << "]" << player.name << "nutzt" << format;
+}
+
+void RoomShard::handleCreateRoom(GameRoom &room, Player &player, const QString &name)
+{
+    int shardIndex = 0;
+    const int roomId = directory.createRoom(name, &shardIndex);
+    transferPlayer(room, player, roomId, shardIndex);
+}
+
+void RoomShard::handleJoinRoom(GameRoom &room, Player &player, int roomId)
+{
+    if (roomId == room.getId()) {
+        QJsonObject info;
+        info["type"] = "info";
+        info["message"] = "Du bist bereits in diesem Raum.";
+        sendToPlayer(player, info);
+        return;
+    }
+
+    QString error;
+    const int shardIndex = directory.reserveSeat(roomId, &error);
+    if (shardIndex < 0) {
+        QJsonObject err;
+        err["type"] = "error";
+        err["message"] = error;
+        sendToPlayer(player, err);
+        return;
+    }
+
+    transferPlayer(room, player, roomId, shardIndex);
+}
+
+void RoomShard::transferPlayer(GameRoom &from, Player &player, int roomId, int shardIndex)
+{
+    ClientConnection *connection = player.connection;
+    std::unique_ptr<Player> moved = from.removePlayer(&player, "playerLeft");
+    if (!moved) {
+        directory.releaseSeat(roomId);
+        return;
+    }
+    directory.releaseSeat(from.getId());
+    publishRoomStatus(from);
+
+    if (shardIndex == index) {
+        GameRoom *target = ensureRoom(roomId);
+        connectionRooms.insert(connection, target);
+        Player *added = target->addPlayer(std::move(moved));
+        if (!added->sessionToken.isEmpty()) {
+            directory.registerSession(added->sessionToken, roomId);
+        }
+        publishRoomStatus(*target);
+    } else {
+        // Verbindung samt Restpuffer an den Shard des Zielraums uebergeben
+        RoomShard *target = server.shardAt(shardIndex);
+        // Gesammeltes noch von hier aus schreiben, der Sendepuffer zieht mit um
+        writeConnection(*connection);
+        std::unique_ptr<ClientConnection> moving = detachConnection(connection);
+        moving->getTransport().moveToThread(target->thread());
+
+        ClientConnection *rawConnection = moving.release();
+        Player *raw = moved.release();
+        QMetaObject::invokeMethod(target, [target, rawConnection, raw, roomId]() {
+            target->adoptConnection(rawConnection, raw, roomId);
+        }, Qt::QueuedConnection);
+    }
+
+    removeRoomIfEmpty(from);
+}
+
+GameRoom* RoomShard::ensureRoom(int roomId)
+{
+    auto it = rooms.find(roomId);
+    if (it != rooms.end()) {
+        return it->second.get();
+    }
+
+    auto room = std::make_unique<GameRoom>(*this, roomId, directory.roomName(roomId));
+    GameRoom *created = room.get();
+    rooms.emplace(roomId, std::move(room));
+    stats.rooms++;
+
+    qDebug() << "[SHARD" << index << "] Raum erstellt:" << roomId << created->getName()
+             << "| seed=" << QString::number(created->randomSeed(), 16)
+             << "| rooms=" << rooms.size();
+    return created;
+}
+
+void RoomShard::publishRoomStatus(GameRoom &room)
+{
+    const int status = (room.isStarted() ? 1 : 0) | (room.isFinished() ? 2 : 0);
+    if (publishedStatus.value(room.getId(), 0) == status) return;
+
+    publishedStatus.insert(room.getId(), status);
+    directory.updateStatus(room.getId(), room.isStarted(), room.isFinished());
+}
+
+void RoomShard::removeRoomIfEmpty(GameRoom &room)
+{
+    if (!room.isEmpty()) return;
+
+    const int roomId = room.getId();
+    if (!directory.removeIfUnreserved(roomId)) return;
+
+    publishedStatus.remove(roomId);
+    rooms.erase(roomId);
+    stats.rooms--;
+    if (journal) {
+        journal->dropRoom(roomId);
+    }
+    qDebug() << "[SHARD" << index << "] Raum geschlossen:" << roomId << "| rooms=" << rooms.size();
+}
+
+std::unique_ptr<ClientConnection> RoomShard::detachConnection(ClientConnection *connection)
+{
+    auto it = connections.find(connection);
+    std::unique_ptr<ClientConnection> owned = std::move(it->second);
+    connections.erase(it);
+
+    owned->getTransport().detach();
+    owned->flushScheduled = false;
+    wheel[owned->wheelSlot].removeOne(connection);
+    flushList.removeAll(connection);
+    connectionRooms.remove(connection);
+    stats.connections--;
+    return owned;
+}
+
+void RoomShard::retireConnection(std::unique_ptr<ClientConnection> connection)
+{
+    // evtl. stecken wir noch im Callback des Transports: erst im
+    // naechsten Durchlauf freigeben
+    retired.push_back(std::move(connection));
+    if (!reapPosted) {
+        reapPosted = true;
+        QMetaObject::invokeMethod(this, &RoomShard::reapConnections, Qt::QueuedConnection);
+    }
+}
+
+void RoomShard::reapConnections()
+{
+    reapPosted = false;
+    retired.clear();
+}
+
+void RoomShard::sendToPlayer(Player &player, const QJsonObject &obj)
+{
+    if (!player.isReachable()) return;
+
+    if (!player.requestId.isUndefined() && obj.value("type").toString() == "error") {
+        // Fehler zur laufenden Anfrage: gezielt als nack (nur der erste)
+        if (player.requestFailed) return;
+        player.requestFailed = true;
+
+        QJsonObject nack;
+        nack["type"] = "nack";
+        nack["rid"] = player.requestId;
+        nack["requestType"] = player.requestType;
+        nack["message"] = obj.value("message");
+        nack["serverUs"] = qint64(player.requestTimer.nsecsElapsed() / 1000);
+        OutgoingMessage msg(nack);
+        sendMessage(player, msg);
+        return;
+    }
+
+    OutgoingMessage msg(obj);
+    sendMessage(player, msg);
+
+    qDebug() << "[NET] => to" << player.name << obj.value("type").toString();
+}
+
+void RoomShard::sendMessage(Player &player, OutgoingMessage &msg)
+{
+    // Sitzung: seq vergeben und fuer ein resume puffern, auch waehrend
+    // der Spieler pausiert ist
+    quint64 seq = 0;
+    if (!player.sessionToken.isEmpty() && msg.isSequenced()) {
+        seq = player.replay.push(msg.object());
+    }
+
+    ClientConnection *connection = player.connection;
+    if (!connection || connection->closing) return;
+
+    bool encoded = false;
+    const QByteArray &shared = msg.frame(player.wireFormat, &encoded);
+    if (encoded) {
+        stats.framesEncoded++;
+    }
+    // einmal kodiert bleibt einmal kodiert, seq wird nur davorgesetzt
+    const QByteArray frame = seq > 0 ? Protocol::withSequence(shared, player.wireFormat, seq) : shared;
+
+    if (!updateCongestion(*connection)) {
+        sendFrame(*connection, frame, msg.isState());
+        return;
+    }
+
+    // Ueberlast: nur in der eigenen Queue sammeln, ein neuer Vollzustand
+    // (auch als turnResult) ersetzt alle noch nicht geschriebenen
+    // State-Frames samt Zug-Envelopes mit Zustand
+    if (msg.isFullState()) {
+        const int dropped = connection->dropQueuedState();
+        stats.stateFramesDropped += quint64(dropped);
+    }
+    connection->enqueue(frame, msg.isState());
+    if (msg.isState()) {
+        // naechster State fuer diesen Spieler als Vollzustand, damit er
+        // den gesammelten ersetzen kann (Deltas bauen aufeinander auf)
+        player.stateSynced = false;
+    }
+
+    if (connection->queuedBytes() > ClientConnection::maxQueuedBytes
+        || connection->congestedForMs() > ClientConnection::slowConsumerTimeoutMs) {
+        dropSlowConsumer(*connection);
+    }
+}
+
+bool RoomShard::owns(const ClientConnection *connection) const
+{
+    return connection && connections.count(const_cast<ClientConnection*>(connection)) > 0;
+}
+
+void RoomShard::sendFrame(ClientConnection &connection, const QByteArray &frame, bool stateFrame)
+{
+    if (connection.flushScheduled) {
+        // gleicher Durchlauf: sammeln, geht gesammelt in flushConnections() raus
+        connection.enqueue(frame, stateFrame);
+        return;
+    }
+
+    // erster Frame sofort (kein Warten auf die Event-Loop), danach sammeln
+    Transport &transport = connection.getTransport();
+    transport.write(frame);
+    transport.flush();
+    stats.socketWrites++;
+    stats.framesSent++;
+    stats.bytesOut += quint64(frame.size());
+
+    connection.flushScheduled = true;
+    flushList.append(&connection);
+    if (!flushPosted) {
+        flushPosted = true;
+        QMetaObject::invokeMethod(this, &RoomShard::flushConnections, Qt::QueuedConnection);
+    }
+}
+
+void RoomShard::flushConnections()
+{
+    flushPosted = false;
+    const QVector<ClientConnection*> pending = std::exchange(flushList, {});
+    for (ClientConnection *connection : pending) {
+        if (!owns(connection)) continue;
+
+        connection->flushScheduled = false;
+        // ueberlastete Verbindungen behalten ihre Queue bis onBytesWritten
+        if (!updateCongestion(*connection)) {
+            writeConnection(*connection);
+        }
+    }
+}
+
+void RoomShard::writeConnection(ClientConnection &connection)
+{
+    // erst hier gezaehlt: verworfene State-Frames und Frames an getrennte
+    // Langsam-Leser kommen nie beim Transport an
+    int frames = 0;
+    const qint64 bytes = connection.writeQueued(&frames);
+    if (bytes > 0) {
+        stats.socketWrites++;
+        stats.framesSent += quint64(frames);
+        stats.bytesOut += quint64(bytes);
+    }
+    connection.flushScheduled = false;
+}
+
+bool RoomShard::updateCongestion(ClientConnection &connection)
+{
+    const qint64 backlog = connection.getTransport().bytesToWrite();
+    if (!connection.isCongested() && backlog >= ClientConnection::highWatermark) {
+        connection.setCongested(true);
+        stats.congestionEvents++;
+        qDebug() << "[SHARD" << index << "] Verbindung ueberlastet, backlog=" << backlog;
+    } else if (connection.isCongested() && backlog <= ClientConnection::lowWatermark) {
+        connection.setCongested(false);
+    }
+    return connection.isCongested();
+}
+
+void RoomShard::onConnectionWritable(ClientConnection *connection)
+{
+    if (!owns(connection) || !connection->isCongested() || connection->closing) return;
+
+    if (!updateCongestion(*connection)) {
+        qDebug() << "[SHARD" << index << "] Verbindung wieder frei, queued="
+                 << connection->queuedBytes();
+        writeConnection(*connection);
+    }
+}
+
+void RoomShard::dropSlowConsumer(ClientConnection &connection)
+{
+    stats.slowConsumerDisconnects++;
+    qWarning() << "[SHARD" << index << "] Client haengt hinterher, trenne Verbindung."
+               << "queued=" << connection.queuedBytes()
+               << "backlog=" << connection.getTransport().bytesToWrite()
+               << "ms=" << connection.congestedForMs();
+
+    closeConnectionLater(connection);
+}
+
+void RoomShard::closeConnectionLater(ClientConnection &connection)
+{
+    // nicht sofort abort(): wir stecken evtl. mitten im Broadcast eines
+    // Raums, das Entfernen des Spielers passiert in onConnectionClosed
+    connection.closing = true;
+    ClientConnection *target = &connection;
+    const quint64 serial = connection.serial;
+    QMetaObject::invokeMethod(this, [this, target, serial]() {
+        if (owns(target) && target->serial == serial) {
+            target->getTransport().abort();
+        }
+    }, Qt::QueuedConnection);
+}
+
+void RoomShard::onConnectionClosed(ClientConnection *connection)
+{
+    if (!owns(connection)) return;
+
+    GameRoom *room = connectionRooms.value(connection, nullptr);
+    Player *player = room ? room->findPlayerByConnection(connection) : nullptr;
+    std::unique_ptr<ClientConnection> closed = detachConnection(connection);
+
+    if (player) {
+        qDebug() << "[NET] client disconnected:" << player->name
+                 << closed->getTransport().peerInfo();
+        loseConnection(*room, *player);
+    } else if (room) {
+        publishRoomStatus(*room);
+        removeRoomIfEmpty(*room);
+    }
+
+    retireConnection(std::move(closed));
+}
+
+void RoomShard::loseConnection(GameRoom &room, Player &player)
+{
+    if (!player.sessionToken.isEmpty() && resumeGraceMs > 0) {
+        // Platz bleibt bis zum Ablauf der Frist reserviert
+        qDebug() << "[NET] Sitzung pausiert:" << player.name;
+        room.suspendPlayer(player);
+        stats.sessionsSuspended++;
+        armSessionExpiry(room.getId(), player);
+    } else {
+        room.removePlayer(&player, "playerLeft");
+        directory.releaseSeat(room.getId());
+    }
+    publishRoomStatus(room);
+    removeRoomIfEmpty(room);
+}
+
+bool RoomShard::startNative()
+{
+#ifdef MONOPOLY_EPOLL
+    if (!epollLoop) {
+        epollLoop = new EpollLoop(this);
+    }
+    return epollLoop->isValid();
+#else
+    return false;
+#endif
+}
+
+bool RoomShard::listenNative(quint16 port)
+{
+#ifdef MONOPOLY_EPOLL
+    if (!startNative()) return false;
+    return epollLoop->listen(port, [this](int fd) { onNativeAccept(fd); });
+#else
+    Q_UNUSED(port);
+    return false;
+#endif
+}
+
+bool RoomShard::adoptNativeListener(int fd)
+{
+#ifdef MONOPOLY_EPOLL
+    if (!startNative()) return false;
+    return epollLoop->adoptListener(fd, [this](int client) { onNativeAccept(client); });
+#else
+    Q_UNUSED(fd);
+    return false;
+#endif
+}
+
+QVector<int> RoomShard::nativeListeners() const
+{
+#ifdef MONOPOLY_EPOLL
+    if (epollLoop) {
+        return epollLoop->listeners();
+    }
+#endif
+    return {};
+}
+
+void RoomShard::onNativeAccept(int fd)
+{
+#ifdef MONOPOLY_EPOLL
+    // wie GameServer::onNewConnection, nur ohne Umweg ueber den Hauptthread
+    int roomId = -1;
+    int shardIndex = 0;
+    directory.placeNewConnection(&roomId, &shardIndex);
+
+    auto *transport = new EpollTransport(fd);
+    // adoptTransport kann ihn sofort loeschen (Gegenseite schon weg)
+    const QString peer = transport->peerInfo();
+    RoomShard *target = server.shardAt(shardIndex);
+    if (target == this) {
+        adoptTransport(transport, roomId);
+    } else {
+        QMetaObject::invokeMethod(target, [target, transport, roomId]() {
+            target->adoptTransport(transport, roomId);
+        }, Qt::QueuedConnection);
+    }
+
+    qDebug() << "[NET] Neuer Client" << peer << "-> Raum" << roomId
+             << "| shard" << shardIndex;
+#else
+    Q_UNUSED(fd);
+#endif
+}
@@ -0,0 +1,230 @@
+#ifndef ROOMSHARD_H
+#define ROOMSHARD_H
+
+#include <QObject>
+#include <QElapsedTimer>
+#include <QTimer>
+#include <QHash>
+#include <QJsonObject>
+#include <QVector>
+#include <atomic>
+#include <map>
+#include <memory>
+#include <vector>
+
+#include "clientconnection.h"
+#include "gameroom.h"
+#include "journal.h"
+#include "messagetable.h"
+#include "outgoingmessage.h"
+#include "player.h"
+
+class GameServer;
+class RoomDirectory;
+class EpollLoop;
+
+// Zaehler je Shard, werden vom Main-Thread nur gelesen
+struct ShardStats
+{
+    std::atomic<quint64> messagesIn{0};
+    std::atomic<quint64> bytesIn{0};
+    std::atomic<quint64> bytesOut{0};
+    std::atomic<quint64> framesEncoded{0};
+    std::atomic<quint64> framesSent{0};
+    std::atomic<quint64> socketWrites{0}; // write()+flush() je Verbindung und Durchlauf
+    std::atomic<quint64> congestionEvents{0};
+    std::atomic<quint64> stateFramesDropped{0};
+    std::atomic<quint64> slowConsumerDisconnects{0};
+    std::atomic<quint64> pingsSent{0};
+    std::atomic<quint64> deadPeersEvicted{0};
+    std::atomic<int> rttAvgMs{0}; // Mittel ueber alle RTT-Messungen (geglaettet)
+    std::atomic<int> rttMaxMs{0}; // max. SRTT der letzten Wheel-Runde
+    std::atomic<quint64> sessionsSuspended{0};
+    std::atomic<quint64> sessionsResumed{0};
+    std::atomic<quint64> sessionsExpired{0};
+    std::atomic<quint64> messagesReplayed{0};
+    std::atomic<quint64> messagesByType[Protocol::TypeCodeLimit] = {};
+    std::atomic<quint64> invalidMessages{0};
+    std::atomic<quint64> unknownMessages{0};
+    std::atomic<quint64> oversizedFrames{0};
+    std::atomic<int> connections{0};
+    std::atomic<int> rooms{0};
+};
+
+// Ein Shard = ein Worker-Thread mit eigener Event-Loop.
+// Alle Raeume eines Shards und die Verbindungen ihrer Spieler leben in diesem
+// Thread, ein voller Tisch bremst damit keine Tische auf anderen Shards.
+class RoomShard : public QObject
+{
+    Q_OBJECT
+
+public:
+    RoomShard(GameServer &server, RoomDirectory &directory, int index);
+    ~RoomShard() override;
+
+    int getIndex() const;
+    const ShardStats &getStats() const;
+
+    // Heartbeat: ping je Verbindung alle intervalMs (hoechstens einer
+    // offen), nach maxMissed Intervallen ohne Pong und ohne andere
+    // Nachricht gilt der Client als tot
+    void setHeartbeat(int intervalMs, int maxMissed);
+
+    // so lange bleibt der Platz eines getrennten Spielers mit Sitzung frei
+    void setResumeGrace(int graceMs);
+
+    // fester Basis-Seed: Raum n bekommt immer denselben Zufall (Tests, Replays)
+    void setRoomSeed(quint64 seed);
+    // Seed fuer einen neuen Raum, ohne setRoomSeed() aus dem System-Zufall
+    quint64 roomSeed(int roomId) const;
+
+    // Neue Verbindung (Transport schon in diesen Thread verschoben)
+    void adoptTransport(Transport *transport, int roomId);
+
+    // Uebernimmt eine Verbindung samt Puffern.
+    // player == nullptr: neue Verbindung, sonst Wechsel von einem anderen Shard.
+    void adoptConnection(ClientConnection *connection, Player *player, int roomId);
+
+    // resume: Verbindung uebernimmt den pausierten Platz der Sitzung token in roomId.
+    // fresh ist der vorlaeufige Spieler der neuen Verbindung (ausgehandelte Faehigkeiten)
+    void resumeConnection(ClientConnection *connection, Player *fresh, int roomId,
+                          const QString &token, quint64 lastSeq);
+
+    // Journal fuer alle Raeume dieses Shards; bestehende Raeume bekommen
+    // sofort einen Snapshot, danach alle snapshotIntervalMs
+    void setJournal(GameJournal *journal);
+    GameJournal *getJournal() const;
+    void requestJournalSnapshot(int roomId);
+
+    // Raum aus Checkpoint/Journal wieder aufbauen (vor dem ersten Client),
+    // beim Hot-Restart samt uebergebener Verbindungen; false, wenn kein
+    // Spieler mehr verbunden ist oder seinen Platz per resume zurueckholen kann
+    bool restoreRoom(const RoomRestore &restore);
+
+    // Zustand aller Raeume dieses Shards fuer den Checkpoint
+    QVector<RoomState> captureRooms() const;
+
+    // Hot-Restart (handover.h): nichts mehr lesen, Ausgaenge leeren
+    void pauseForHandover();
+    bool isDrained() const;
+    // Raeume samt abgegebener Sockets; die Spieler bleiben ohne Verbindung zurueck
+    QVector<RoomRestore> releaseForHandover();
+    // Uebergabe gescheitert: Sockets wieder aufnehmen und weiterlaufen
+    void resumeAfterHandover(const QVector<RoomRestore> &released);
+
+    // natives Backend (nur Linux/epoll): eigener Listener mit SO_REUSEPORT
+    // in diesem Shard-Thread; false, wenn nicht verfuegbar
+    bool listenNative(quint16 port);
+    // nur die epoll-Loop, ohne Listener (neue Verbindungen kommen von anderen Shards)
+    bool startNative();
+    // Listener des Vorgaengers uebernehmen (Hot-Restart)
+    bool adoptNativeListener(int fd);
+    // fuer die Uebergabe an einen Nachfolger
+    QVector<int> nativeListeners() const;
+
+    // wird von den Raeumen zum Senden benutzt
+    void sendToPlayer(Player &player, const QJsonObject &obj);
+
+    // Broadcast: je Wire-Format einmal kodieren, denselben (implizit geteilten)
+    // Puffer an alle Empfaenger schreiben - der Transport haengt ihn ohne Kopie an.
+    void sendMessage(Player &player, OutgoingMessage &msg);
+
+private:
+    GameServer &server;
+    RoomDirectory &directory;
+    int index;
+    ShardStats stats;
+
+    // Verbindungen mit Empfangspuffer (JSON-Zeilen und/oder CBOR-Frames) und
+    // Ausgangs-Queue; Client-Nachrichten sind klein, groessere Frames
+    // trennen die Verbindung
+    static constexpr int maxClientFrameSize = 64 * 1024;
+    std::map<ClientConnection*, std::unique_ptr<ClientConnection>> connections;
+    quint64 nextSerial = 1;
+
+    // geschlossene Verbindungen, freigegeben erst im naechsten Durchlauf
+    // (wir koennen noch im Callback ihres Transports stecken)
+    std::vector<std::unique_ptr<ClientConnection>> retired;
+    bool reapPosted = false;
+
+    // Verbindungen mit geplantem Flush am Ende des Event-Loop-Durchlaufs
+    QVector<ClientConnection*> flushList;
+    bool flushPosted = false;
+
+    std::map<int, std::unique_ptr<GameRoom>> rooms;
+    QHash<ClientConnection*, GameRoom*> connectionRooms;
+
+    EpollLoop *epollLoop = nullptr;
+
+    // zuletzt ans Verzeichnis gemeldeter Status (started/finished) je Raum
+    QHash<int, int> publishedStatus;
+
+    // Timer-Wheel fuer Heartbeats: pro Tick wird nur ein Slot abgearbeitet,
+    // jede Verbindung kommt so einmal pro Intervall dran
+    static constexpr int wheelSlots = 8;
+    QVector<QVector<ClientConnection*>> wheel;
+    int wheelPos = 0;
+    int nextWheelSlot = 0;
+    int heartbeatIntervalMs = 5000;
+    int maxMissedPings = 3;
+    int roundRttMaxMs = 0;
+    QTimer heartbeatTimer;
+    QElapsedTimer clock;
+
+    int resumeGraceMs = 60000;
+
+    bool fixedSeed = false;
+    quint64 baseSeed = 0;
+
+    GameJournal *journal = nullptr;
+    QTimer journalTimer;
+
+    bool handingOver = false;
+
+private slots:
+    void flushConnections();
+    void reapConnections();
+    void onHeartbeatTick();
+    void onJournalTick();
+
+private:
+    void readFromConnection(ClientConnection *connection);
+    void onConnectionWritable(ClientConnection *connection);
+    void onConnectionClosed(ClientConnection *connection);
+    void loseConnection(GameRoom &room, Player &player);
+    Transport *wrapDescriptor(int fd);
+    bool adoptHandedOver(GameRoom &room, Player &player, const ConnectionState &state);
+    void onNativeAccept(int fd);
+    void rejectOversizedFrame(ClientConnection *connection, const QString &error);
+    static const MessageTable<RoomShard> &messageTable();
+    void processMessage(GameRoom &room, Player &player, int code, const QJsonObject &msg);
+    GameRoom &roomOf(Player &player);
+    void finishRequest(Player &player);
+
+    // Raumverwaltung
+    void handleCreateRoom(GameRoom &room, Player &player, const QString &name);
+    void handleJoinRoom(GameRoom &room, Player &player, int roomId);
+    void handleListRooms(Player &player);
+    void handleServerStats(Player &player);
+    void handleSetWireFormat(Player &player, const QString &format);
+    void handleHello(GameRoom &room, Player &player, const QJsonObject &msg);
+    void handlePong(Player &player, const QJsonObject &msg);
+    void handleResume(GameRoom &room, Player &player, const QString &token, quint64 lastSeq);
+    void expireSession(int roomId, const QString &token, qint64 suspendedAt);
+    void armSessionExpiry(int roomId, const Player &player);
+    void transferPlayer(GameRoom &from, Player &player, int roomId, int shardIndex);
+    GameRoom* ensureRoom(int roomId);
+    void publishRoomStatus(GameRoom &room);
+    void removeRoomIfEmpty(GameRoom &room);
+    ClientConnection &attachConnection(std::unique_ptr<ClientConnection> connection, const Player &player);
+    std::unique_ptr<ClientConnection> detachConnection(ClientConnection *connection);
+    void retireConnection(std::unique_ptr<ClientConnection> connection);
+    bool owns(const ClientConnection *connection) const;
+    void sendFrame(ClientConnection &connection, const QByteArray &frame, bool stateFrame);
+    void writeConnection(ClientConnection &connection);
+    bool updateCongestion(ClientConnection &connection);
+    void dropSlowConsumer(ClientConnection &connection);
+    void closeConnectionLater(ClientConnection &connection);
+};
+
+#endif // ROOMSHARD_H
@@ -0,0 +1,127 @@
+#include "roomstate.h"
+
+#include <QJsonArray>
+
+QJsonObject RoomState::toJson() const
+{
+    QJsonObject image;
+    image["roomId"] = roomId;
+    image["name"] = name;
+    image["seq"] = qint64(journalSeq);
+    image["nextPlayerId"] = nextPlayerId;
+    image["gameStarted"] = gameStarted;
+    image["gameFinished"] = gameFinished;
+    image["winnerId"] = winnerId;
+    image["currentPlayerId"] = currentPlayerId;
+    image["awaitingBuyDecision"] = awaitingBuyDecision;
+    image["pendingBuyPlayerId"] = pendingBuyPlayerId;
+    image["pendingBuyFieldIndex"] = pendingBuyFieldIndex;
+    image["awaitingEndTurn"] = awaitingEndTurn;
+    image["pendingEndTurnPlayerId"] = pendingEndTurnPlayerId;
+    image["randomSeed"] = QString::number(randomSeed, 16);
+    image["randomDraws"] = qint64(randomDraws);
+
+    QJsonArray parr;
+    for (const PlayerState &p : players) {
+        QJsonObject po;
+        po["id"] = p.id;
+        po["name"] = p.name;
+        po["session"] = p.session;
+        po["position"] = p.position;
+        po["money"] = p.money;
+        po["inJail"] = p.inJail;
+        po["jailTurns"] = p.jailTurns;
+        po["bankrupt"] = p.bankrupt;
+        po["ready"] = p.ready;
+        parr.append(po);
+    }
+    image["players"] = parr;
+
+    QJsonArray farr;
+    for (const FieldState &f : fields) {
+        QJsonObject fo;
+        fo["index"] = f.index;
+        fo["ownerId"] = f.ownerId;
+        fo["hasHotel"] = f.hasHotel;
+        farr.append(fo);
+    }
+    image["fields"] = farr;
+    return image;
+}
+
+RoomState RoomState::fromJson(const QJsonObject &image)
+{
+    RoomState state;
+    state.roomId = image.value("roomId").toInt();
+    state.name = image.value("name").toString();
+    state.journalSeq = quint64(image.value("seq").toDouble());
+    state.nextPlayerId = image.value("nextPlayerId").toInt(1);
+    state.gameStarted = image.value("gameStarted").toBool();
+    state.gameFinished = image.value("gameFinished").toBool();
+    state.winnerId = image.value("winnerId").toInt(-1);
+    state.currentPlayerId = image.value("currentPlayerId").toInt(-1);
+    state.awaitingBuyDecision = image.value("awaitingBuyDecision").toBool();
+    state.pendingBuyPlayerId = image.value("pendingBuyPlayerId").toInt(-1);
+    state.pendingBuyFieldIndex = image.value("pendingBuyFieldIndex").toInt(-1);
+    state.awaitingEndTurn = image.value("awaitingEndTurn").toBool();
+    state.pendingEndTurnPlayerId = image.value("pendingEndTurnPlayerId").toInt(-1);
+    state.randomSeed = image.value("randomSeed").toString().toULongLong(nullptr, 16);
+    state.randomDraws = quint64(image.value("randomDraws").toDouble());
+
+    for (const QJsonValue &v : image.value("players").toArray()) {
+        const QJsonObject po = v.toObject();
+        PlayerState p;
+        p.id = po.value("id").toInt();
+        p.name = po.value("name").toString();
+        p.session = po.value("session").toString();
+        p.position = po.value("position").toInt();
+        p.money = po.value("money").toInt();
+        p.inJail = po.value("inJail").toBool();
+        p.jailTurns = po.value("jailTurns").toInt();
+        p.bankrupt = po.value("bankrupt").toBool();
+        p.ready = po.value("ready").toBool();
+        state.players.append(p);
+    }
+
+    for (const QJsonValue &v : image.value("fields").toArray()) {
+        const QJsonObject fo = v.toObject();
+        FieldState f;
+        f.index = fo.value("index").toInt(-1);
+        f.ownerId = fo.value("ownerId").toInt(-1);
+        f.hasHotel = fo.value("hasHotel").toBool();
+        state.fields.append(f);
+    }
+    return state;
+}
+
+QJsonObject ConnectionState::toJson() const
+{
+    QJsonObject obj;
+    obj["playerId"] = playerId;
+    obj["pending"] = QString::fromLatin1(pending.toBase64());
+    obj["wireFormat"] = Protocol::formatName(wireFormat);
+    obj["protocolVersion"] = protocolVersion;
+    obj["heartbeats"] = heartbeats;
+    obj["delta"] = deltaUpdates;
+    obj["catalog"] = catalogAware;
+    obj["catalogHash"] = catalogHash;
+    obj["turnResults"] = turnResults;
+    obj["lastSeq"] = qint64(lastSeq);
+    return obj;
+}
+
+ConnectionState ConnectionState::fromJson(const QJsonObject &obj)
+{
+    ConnectionState state;
+    state.playerId = obj.value("playerId").toInt();
+    state.pending = QByteArray::fromBase64(obj.value("pending").toString().toLatin1());
+    Protocol::parseFormat(obj.value("wireFormat").toString(), &state.wireFormat);
+    state.protocolVersion = obj.value("protocolVersion").toInt();
+    state.heartbeats = obj.value("heartbeats").toBool();
+    state.deltaUpdates = obj.value("delta").toBool();
+    state.catalogAware = obj.value("catalog").toBool();
+    state.catalogHash = obj.value("catalogHash").toString();
+    state.turnResults = obj.value("turnResults").toBool();
+    state.lastSeq = quint64(obj.value("lastSeq").toDouble());
+    return state;
+}
@@ -0,0 +1,87 @@
+#ifndef ROOMSTATE_H
+#define ROOMSTATE_H
+
+#include <QByteArray>
+#include <QJsonObject>
+#include <QString>
+#include <QVector>
+
+#include "protocol.h"
+
+// Spielzustand eines Raums ohne Verbindungen: Grundlage fuer die
+// Journal-Snapshots (JSON, journal.h) und den Binaer-Checkpoint (checkpoint.h)
+struct PlayerState
+{
+    int id = 0;
+    QString name;
+    QString session;
+    int position = 0;
+    int money = 1500;
+    bool inJail = false;
+    int jailTurns = 0;
+    bool bankrupt = false;
+    bool ready = false;
+};
+
+struct FieldState
+{
+    int index = 0;
+    int ownerId = -1;
+    bool hasHotel = false;
+};
+
+struct RoomState
+{
+    int roomId = 0;
+    QString name;
+    quint64 journalSeq = 0;
+    int nextPlayerId = 1;
+    bool gameStarted = false;
+    bool gameFinished = false;
+    int winnerId = -1;
+    int currentPlayerId = -1;
+    bool awaitingBuyDecision = false;
+    int pendingBuyPlayerId = -1;
+    int pendingBuyFieldIndex = -1;
+    bool awaitingEndTurn = false;
+    int pendingEndTurnPlayerId = -1;
+    quint64 randomSeed = 0;  // Raum-Zufall: Seed und bisher gezogene Werte
+    quint64 randomDraws = 0;
+
+    QVector<PlayerState> players; // in Zugreihenfolge
+    QVector<FieldState> fields;   // nur Felder mit Besitzer
+
+    QJsonObject toJson() const;
+    static RoomState fromJson(const QJsonObject &image);
+};
+
+// Verbindung eines Spielers beim Hot-Restart (handover.h): der Socket
+// selbst geht als Deskriptor mit, hier steht, was dazu im Speicher lag
+struct ConnectionState
+{
+    int playerId = 0;
+    int fd = -1;         // uebergebener Socket, nicht Teil des JSON
+    QByteArray pending;  // empfangen, aber noch nicht verarbeitet
+    Protocol::WireFormat wireFormat = Protocol::WireFormat::Json;
+    int protocolVersion = 0;
+    bool heartbeats = false;
+    bool deltaUpdates = false;
+    bool catalogAware = false;
+    QString catalogHash;
+    bool turnResults = false;
+    quint64 lastSeq = 0; // Sitzung: hier geht die seq weiter
+
+    QJsonObject toJson() const;
+    static ConnectionState fromJson(const QJsonObject &obj);
+};
+
+// Wiederaufbau eines Raums: Ausgangszustand plus neuere Journal-Ereignisse,
+// beim Hot-Restart zusaetzlich die uebergebenen Verbindungen
+struct RoomRestore
+{
+    RoomState state;
+    QVector<QJsonObject> events;
+    QVector<ConnectionState> connections;
+};
+
+#endif // ROOMSTATE_H
@@ -1,6 +0,0 @@
-#include "startfield.h"
-#include "player.h"
-
-void StartField::onLand(Player& player) {
-    player.receive(startBonus);
-}
@@ -0,0 +1,109 @@
+#include "tcptransport.h"
+
+#include <QThread>
+
+#ifdef Q_OS_UNIX
+#include <unistd.h>
+#endif
+
+TcpTransport::TcpTransport(QTcpSocket *socket)
+    : socket(socket)
+{
+    // Nagle aus: wir sammeln selbst pro Event-Loop-Durchlauf.
+    // Keepalive als Rueckfall fuer Clients ohne Heartbeat
+    socket->setSocketOption(QAbstractSocket::LowDelayOption, 1);
+    socket->setSocketOption(QAbstractSocket::KeepAliveOption, 1);
+}
+
+TcpTransport::~TcpTransport()
+{
+    detach();
+    delete socket;
+}
+
+void TcpTransport::attach(const Events &events)
+{
+    detach();
+    signalConnections.append(QObject::connect(socket, &QTcpSocket::readyRead,
+                                              socket, events.readable));
+    signalConnections.append(QObject::connect(socket, &QTcpSocket::bytesWritten,
+                                              socket, [cb = events.writable](qint64) { cb(); }));
+    signalConnections.append(QObject::connect(socket, &QTcpSocket::disconnected,
+                                              socket, events.closed));
+}
+
+void TcpTransport::detach()
+{
+    for (const QMetaObject::Connection &c : signalConnections) {
+        QObject::disconnect(c);
+    }
+    signalConnections.clear();
+}
+
+void TcpTransport::moveToThread(QThread *thread)
+{
+    socket->setParent(nullptr);
+    socket->moveToThread(thread);
+}
+
+bool TcpTransport::isConnected() const
+{
+    return socket->state() == QAbstractSocket::ConnectedState;
+}
+
+QString TcpTransport::peerInfo() const
+{
+    return QString("tcp:%1:%2").arg(socket->peerAddress().toString()).arg(socket->peerPort());
+}
+
+qint64 TcpTransport::readInto(Protocol::FrameReader &reader)
+{
+    return reader.readFrom(socket);
+}
+
+bool TcpTransport::hasBytesAvailable() const
+{
+    return socket->bytesAvailable() > 0;
+}
+
+void TcpTransport::write(const QByteArray &data)
+{
+    socket->write(data);
+}
+
+void TcpTransport::flush()
+{
+    socket->flush();
+}
+
+qint64 TcpTransport::bytesToWrite() const
+{
+    return socket->bytesToWrite();
+}
+
+void TcpTransport::close()
+{
+    socket->disconnectFromHost();
+}
+
+void TcpTransport::abort()
+{
+    socket->abort();
+}
+
+int TcpTransport::releaseDescriptor()
+{
+#ifdef Q_OS_UNIX
+    if (!isConnected() || socket->bytesToWrite() > 0) return -1;
+
+    // abort() schliesst nur unseren Deskriptor, die Kopie haelt die Verbindung
+    const int fd = ::dup(int(socket->socketDescriptor()));
+    if (fd >= 0) {
+        detach();
+        socket->abort();
+    }
+    return fd;
+#else
+    return -1;
+#endif
+}
@@ -0,0 +1,39 @@
+#ifndef TCPTRANSPORT_H
+#define TCPTRANSPORT_H
+
+#include <QMetaObject>
+#include <QTcpSocket>
+#include <QVector>
+
+#include "transport.h"
+
+// Transport ueber QTcpSocket (Standard-Backend, alle Plattformen)
+class TcpTransport : public Transport
+{
+public:
+    explicit TcpTransport(QTcpSocket *socket);
+    ~TcpTransport() override;
+
+    void attach(const Events &events) override;
+    void detach() override;
+    void moveToThread(QThread *thread) override;
+
+    bool isConnected() const override;
+    QString peerInfo() const override;
+    qint64 readInto(Protocol::FrameReader &reader) override;
+    bool hasBytesAvailable() const override;
+
+    void write(const QByteArray &data) override;
+    void flush() override;
+    qint64 bytesToWrite() const override;
+
+    void close() override;
+    void abort() override;
+    int releaseDescriptor() override;
+
+private:
+    QTcpSocket *socket;
+    QVector<QMetaObject::Connection> signalConnections;
+};
+
+#endif // TCPTRANSPORT_H
@@ -0,0 +1,57 @@
+#ifndef TRANSPORT_H
+#define TRANSPORT_H
+
+#include <QByteArray>
+#include <QString>
+#include <functional>
+
+#include "protocol.h"
+
+class QThread;
+
+// Byte-Transport unter einer ClientConnection: TCP (Qt-Socket oder natives
+// epoll), Unix-Domain-Socket oder In-Process-Loopback. Die Spiellogik sieht
+// nur Player/ClientConnection, nie den Transport dahinter.
+// Aufrufe und Ereignisse immer im Thread des besitzenden Shards.
+class Transport
+{
+public:
+    struct Events {
+        std::function<void()> readable; // neue Daten, readInto() aufrufen
+        std::function<void()> writable; // Daten gingen raus (Backpressure)
+        std::function<void()> closed;   // Verbindung weg
+    };
+
+    virtual ~Transport() = default;
+
+    // attach() im Thread des Shards; vor der Uebergabe an einen anderen
+    // Shard detach() und moveToThread() im alten Thread
+    virtual void attach(const Events &events) = 0;
+    virtual void detach() = 0;
+    virtual void moveToThread(QThread *thread) = 0;
+
+    virtual bool isConnected() const = 0;
+
+    // Gegenstelle fuer Logs, z.B. "tcp:1.2.3.4:5678", "unix:monopoly", "loopback:3"
+    virtual QString peerInfo() const = 0;
+
+    // liest alles Verfuegbare direkt in den Empfangspuffer, liefert die Byteanzahl
+    virtual qint64 readInto(Protocol::FrameReader &reader) = 0;
+    // Daten liegen schon bereit, ohne dass noch ein readable kommt
+    virtual bool hasBytesAvailable() const = 0;
+
+    virtual void write(const QByteArray &data) = 0;
+    virtual void flush() = 0;
+    virtual qint64 bytesToWrite() const = 0;
+
+    // close(): nach dem Senden schliessen; abort(): sofort, meldet closed
+    virtual void close() = 0;
+    virtual void abort() = 0;
+
+    // Hot-Restart: Socket abgeben, ohne die Verbindung zu beenden. Liefert
+    // einen eigenen Deskriptor und ist danach geschlossen; -1, wenn der
+    // Transport keinen Socket hat oder noch Ungesendetes haelt.
+    virtual int releaseDescriptor() { return -1; }
+};
+
+#endif // TRANSPORT_H
@@ -1,5 +1,6 @@
 ﻿#include "networkclient.h"
-#include <QJsonDocument>
+#include <QJsonArray>
+#include <utility>
 
 NetworkClient::NetworkClient(QObject *parent)
     : QObject(parent)
@@ -7,11 +8,14 @@ NetworkClient::NetworkClient(QObject *parent)
     socket = new QTcpSocket(this);
     reconnectTimer = new QTimer(this);
     reconnectTimer->setSingleShot(true);
+    watchdogTimer = new QTimer(this);
+    watchdogTimer->setSingleShot(true);
 
     connect(socket, &QTcpSocket::connected,    this, &NetworkClient::onConnected);
     connect(socket, &QTcpSocket::disconnected, this, &NetworkClient::onDisconnected);
     connect(socket, &QTcpSocket::readyRead,    this, &NetworkClient::onReadyRead);
     connect(reconnectTimer, &QTimer::timeout,  this, &NetworkClient::tryReconnect);
+    connect(watchdogTimer, &QTimer::timeout,   this, &NetworkClient::onWatchdogTimeout);
 
     connect(socket, &QTcpSocket::errorOccurred, this,
             [=](QAbstractSocket::SocketError) {
@@ -26,6 +30,11 @@ void NetworkClient::connectToServer(const QString &host, quint16 port)
     reconnectDelay = 2000;
     reconnectTimer->stop();
 
+    // bewusst neu verbinden = neue Sitzung, resume nur beim Auto-Reconnect
+    sessionToken.clear();
+    lastSeq = 0;
+    resetState();
+
     if (socket->state() != QAbstractSocket::UnconnectedState) {
         socket->abort();
     }
@@ -36,11 +45,34 @@ void NetworkClient::onConnected()
 {
     reconnectDelay = 2000; // Backoff zuruecksetzen
     reconnectTimer->stop();
+
+    // Handshake; alte Server ignorieren hello, wir bleiben dann bei JSON
+    wireFormat = Protocol::WireFormat::Json;
+    protocolVersion = 0;
+    serverCaps.clear();
+    reader.clear();
+    watchdogMs = 0;
+    rttMs = -1;
+    resumePending = !sessionToken.isEmpty();
+    heldMessages.clear();
+    QJsonObject hello;
+    hello["type"] = "hello";
+    hello["protocolVersion"] = Protocol::Version;
+    hello["caps"] = QJsonArray::fromStringList(Protocol::supportedCapabilities());
+    hello["catalogHash"] = catalogHash;
+    sendJson(hello);
+
     emit connected();
 }
 
 void NetworkClient::onDisconnected()
 {
+    // mit Sitzung bleibt der State fuer das resume erhalten
+    if (sessionToken.isEmpty()) {
+        resetState();
+    }
+    pendingRequests.clear();
+    watchdogTimer->stop();
     emit disconnected();
     if (reconnectEnabled && !lastHost.isEmpty()) {
         scheduleReconnect();
@@ -72,40 +104,350 @@ void NetworkClient::tryReconnect()
     socket->connectToHost(lastHost, lastPort);
 }
 
-void NetworkClient::sendJson(const QJsonObject &obj)
+int NetworkClient::sendJson(const QJsonObject &obj)
 {
     if (socket->state() != QAbstractSocket::ConnectedState) {
-        return;
+        return 0;
     }
-    QJsonDocument doc(obj);
-    socket->write(doc.toJson(QJsonDocument::Compact) + "\n");
+    if (!serverCaps.contains(Protocol::CapRequestIds) || obj.contains("rid")) {
+        socket->write(Protocol::encode(obj, wireFormat));
+        return 0;
+    }
+
+    // rid mitschicken: Antworten kommen gezielt, Anfragen koennen ohne
+    // Warten hintereinander gesendet werden
+    const int rid = nextRid++;
+    PendingRequest &pending = pendingRequests[rid];
+    pending.type = obj.value("type").toString();
+    pending.timer.start();
+
+    QJsonObject msg = obj;
+    msg["rid"] = rid;
+    socket->write(Protocol::encode(msg, wireFormat));
+    return rid;
 }
 
 void NetworkClient::onReadyRead()
 {
-    buffer.append(socket->readAll());
+    reader.readFrom(socket);
+    if (watchdogMs > 0) {
+        watchdogTimer->start(watchdogMs);
+    }
 
+    // JSON-Zeilen und CBOR-Frames werden am ersten Byte erkannt
+    QJsonObject msg;
+    QString error;
     while (true) {
-        int nl = buffer.indexOf('\n');
-        if (nl < 0) break;
+        const Protocol::FrameReader::Result result = reader.next(&msg, &error);
+        if (result == Protocol::FrameReader::Result::Incomplete) {
+            break;
+        }
+        if (result == Protocol::FrameReader::Result::TooLarge) {
+            qDebug() << "Frame Error:" << error;
+            socket->abort();
+            return;
+        }
+        if (result == Protocol::FrameReader::Result::Malformed) {
+            qDebug() << "Parse Error:" << error;
+            continue;
+        }
+        handleMessage(msg);
+    }
+}
+
+void NetworkClient::handleMessage(const QJsonObject &obj)
+{
+    const QString type = obj.value("type").toString();
+
+    if (type == "welcome") {
+        protocolVersion = obj.value("protocolVersion").toInt();
+        serverCaps.clear();
+        for (const QJsonValue &v : obj.value("caps").toArray()) {
+            serverCaps.append(v.toString());
+        }
+        if (serverCaps.contains(Protocol::CapCbor)) {
+            wireFormat = Protocol::WireFormat::Cbor;
+        }
+        const QString offeredSession = obj.value("session").toString();
+        if (resumePending && serverCaps.contains(Protocol::CapResume)) {
+            QJsonObject resume;
+            resume["type"] = "resume";
+            resume["session"] = sessionToken;
+            resume["lastSeq"] = qint64(lastSeq);
+            socket->write(Protocol::encode(resume, wireFormat));
+        } else {
+            if (resumePending) {
+                // Server kann kein resume (mehr): als neuer Spieler weiter
+                resumePending = false;
+                resetState();
+                const QVector<QJsonObject> held = std::exchange(heldMessages, {});
+                for (const QJsonObject &m : held) {
+                    handleMessage(m);
+                }
+            }
+            sessionToken = offeredSession;
+            lastSeq = 0;
+        }
+        if (serverCaps.contains(Protocol::CapHeartbeat)) {
+            const int interval = obj.value("heartbeatMs").toInt();
+            const int maxMissed = obj.value("maxMissed").toInt(3);
+            watchdogMs = interval > 0 ? interval * (maxMissed + 1) : 0;
+            if (watchdogMs > 0) {
+                watchdogTimer->start(watchdogMs);
+            }
+        }
+        qDebug() << "[CLIENT] welcome v" << protocolVersion << "caps=" << serverCaps;
+        return;
+    }
+
+    if (type == "wireFormat") {
+        Protocol::parseFormat(obj.value("format").toString(), &wireFormat);
+        return;
+    }
+
+    if (type == "ping") {
+        handlePing(obj);
+        return;
+    }
+
+    if (type == "resumed") {
+        handleResumed(obj);
+        return;
+    }
+
+    if (resumePending) {
+        heldMessages.append(obj);
+        return;
+    }
 
-        QByteArray line = buffer.left(nl);
-        buffer.remove(0, nl + 1);
+    if (obj.contains("seq")) {
+        lastSeq = qMax(lastSeq, quint64(obj.value("seq").toDouble()));
+    }
 
-        line = line.trimmed();
-        if (line.isEmpty()) continue;
+    if (type == "ack" || type == "nack") {
+        handleRequestReply(obj);
+        return;
+    }
+
+    if (type == "turnResult") {
+        handleTurnResult(obj);
+        return;
+    }
 
-        QJsonParseError err;
-        QJsonDocument doc = QJsonDocument::fromJson(line, &err);
+    if (type == "boardCatalog") {
+        catalogHash = obj.value("hash").toString();
+        catalogCache.insert(catalogHash, obj.value("fields").toArray());
+        return;
+    }
 
-        if (err.error != QJsonParseError::NoError || !doc.isObject()) {
-            qDebug() << "JSON Parse Error:" << err.errorString()
-            << "raw=" << line;
+    if (type == "state") {
+        stateCache = obj;
+        stateVersion = obj.value("stateVersion").toInt(-1);
+        resyncPending = false;
+        emitState();
+        return;
+    }
+
+    if (type == "stateDelta") {
+        if (resyncPending) {
+            return; // Snapshot ist angefordert, Deltas bis dahin verwerfen
+        }
+        if (stateVersion < 0 || obj.value("baseVersion").toInt(-1) != stateVersion) {
+            qDebug() << "[CLIENT] state gap: have" << stateVersion
+                     << "got base" << obj.value("baseVersion").toInt(-1);
+            requestResync();
+            return;
+        }
+        applyStateDelta(obj);
+        emitState();
+        return;
+    }
+
+    emit jsonReceived(obj);
+}
+
+void NetworkClient::handleTurnResult(const QJsonObject &obj)
+{
+    // Envelope wieder in die Einzelnachrichten zerlegen, die die UI kennt;
+    // der State kommt dabei nur einmal
+    if (obj.contains("dice")) {
+        QJsonObject roll = obj.value("dice").toObject();
+        roll["type"] = "diceRolled";
+        emit jsonReceived(roll);
+    }
+
+    const QJsonArray events = obj.value("events").toArray();
+    for (const QJsonValue &v : events) {
+        QJsonObject log = v.toObject();
+        log["type"] = "log";
+        emit jsonReceived(log);
+    }
+
+    if (obj.contains("delta")) {
+        handleMessage(obj.value("delta").toObject());
+    } else if (obj.contains("state")) {
+        handleMessage(obj.value("state").toObject());
+    }
+}
+
+void NetworkClient::handleRequestReply(const QJsonObject &obj)
+{
+    const bool ok = obj.value("type").toString() == "ack";
+    const int rid = obj.value("rid").toInt();
+    const QString requestType = obj.value("requestType").toString();
+    const QString message = obj.value("message").toString();
+
+    qint64 latencyUs = -1;
+    auto it = pendingRequests.find(rid);
+    if (it != pendingRequests.end()) {
+        latencyUs = it->timer.nsecsElapsed() / 1000;
+        const qint64 latency = latencyUs / 1000;
+        pendingRequests.erase(it);
+
+        LatencyStats &stats = latencyByType[requestType];
+        stats.count++;
+        stats.totalMs += latency;
+        stats.maxMs = qMax(stats.maxMs, latency);
+        if (!ok) {
+            stats.failed++;
+        }
+    }
+
+    emit requestFinished(rid, requestType, ok, latencyUs, message);
+
+    if (!ok) {
+        // UI zeigt nack wie bisher als Fehler an
+        QJsonObject err;
+        err["type"] = "error";
+        err["message"] = message;
+        emit jsonReceived(err);
+    }
+}
+
+QJsonObject NetworkClient::requestLatencyStats() const
+{
+    QJsonObject result;
+    for (auto it = latencyByType.constBegin(); it != latencyByType.constEnd(); ++it) {
+        const LatencyStats &stats = it.value();
+        QJsonObject o;
+        o["count"] = stats.count;
+        o["avgMs"] = stats.count > 0 ? double(stats.totalMs) / double(stats.count) : 0.0;
+        o["maxMs"] = stats.maxMs;
+        o["failed"] = stats.failed;
+        result[it.key()] = o;
+    }
+    return result;
+}
+
+void NetworkClient::emitState()
+{
+    const QString hash = stateCache.value("catalogHash").toString();
+    const QJsonArray fields = stateCache.value("fields").toArray();
+    const bool hasStaticData = !fields.isEmpty() && fields.at(0).toObject().contains("name");
+    if (!hasStaticData && !hash.isEmpty() && !catalogCache.contains(hash)) {
+        // Katalog fehlt: neu anfordern, Server schickt boardCatalog + Snapshot
+        catalogHash.clear();
+        requestResync();
+        return;
+    }
+    emit jsonReceived(mergeCatalog(stateCache));
+}
+
+QJsonObject NetworkClient::mergeCatalog(const QJsonObject &state) const
+{
+    QJsonArray fields = state.value("fields").toArray();
+    const QJsonArray catalog = catalogCache.value(state.value("catalogHash").toString());
+    if (catalog.isEmpty() || (!fields.isEmpty() && fields.at(0).toObject().contains("name"))) {
+        return state; // Server hat bereits vollstaendige Felder geschickt
+    }
+
+    QJsonObject merged = state;
+    for (int i = 0; i < fields.size() && i < catalog.size(); ++i) {
+        QJsonObject fo = catalog.at(i).toObject();
+        const QJsonObject dyn = fields.at(i).toObject();
+        for (auto it = dyn.begin(); it != dyn.end(); ++it) {
+            fo[it.key()] = it.value();
+        }
+        fields.replace(i, fo);
+    }
+    merged["fields"] = fields;
+    return merged;
+}
+
+void NetworkClient::applyStateDelta(const QJsonObject &delta)
+{
+    for (auto it = delta.begin(); it != delta.end(); ++it) {
+        const QString key = it.key();
+        if (key == "type" || key == "version" || key == "baseVersion"
+            || key == "players" || key == "removedPlayers" || key == "fields") {
             continue;
         }
+        stateCache[key] = it.value();
+    }
+    stateCache["type"] = "state";
+    stateVersion = delta.value("version").toInt();
+    stateCache["stateVersion"] = stateVersion;
 
-        emit jsonReceived(doc.object());
+    // Spieler per id patchen, neue anhaengen, entfernte loeschen
+    QJsonArray players = stateCache.value("players").toArray();
+    const QJsonArray removed = delta.value("removedPlayers").toArray();
+    for (const QJsonValue &r : removed) {
+        for (int i = 0; i < players.size(); ++i) {
+            if (players.at(i).toObject().value("id").toInt() == r.toInt()) {
+                players.removeAt(i);
+                break;
+            }
+        }
     }
+    const QJsonArray changedPlayers = delta.value("players").toArray();
+    for (const QJsonValue &v : changedPlayers) {
+        const QJsonObject patch = v.toObject();
+        const int id = patch.value("id").toInt();
+        bool found = false;
+        for (int i = 0; i < players.size(); ++i) {
+            QJsonObject p = players.at(i).toObject();
+            if (p.value("id").toInt() != id) {
+                continue;
+            }
+            for (auto it = patch.begin(); it != patch.end(); ++it) {
+                p[it.key()] = it.value();
+            }
+            players.replace(i, p);
+            found = true;
+            break;
+        }
+        if (!found) {
+            players.append(patch);
+        }
+    }
+    stateCache["players"] = players;
+
+    // Felder per index patchen
+    QJsonArray fields = stateCache.value("fields").toArray();
+    const QJsonArray changedFields = delta.value("fields").toArray();
+    for (const QJsonValue &v : changedFields) {
+        const QJsonObject patch = v.toObject();
+        const int index = patch.value("index").toInt(-1);
+        if (index < 0) {
+            continue;
+        }
+        if (index >= fields.size()) {
+            fields.append(patch);
+            continue;
+        }
+        QJsonObject f = fields.at(index).toObject();
+        for (auto it = patch.begin(); it != patch.end(); ++it) {
+            f[it.key()] = it.value();
+        }
+        fields.replace(index, f);
+    }
+    stateCache["fields"] = fields;
+}
+
+void NetworkClient::requestResync()
+{
+    resyncPending = true;
+    sendGetState();
 }
 
 void NetworkClient::sendRollDice()
@@ -115,6 +457,16 @@ void NetworkClient::sendRollDice()
     sendJson(msg);
 }
 
+void NetworkClient::sendAutoTurn(const QString &buyPolicy, int minMoneyAfter, bool endTurn)
+{
+    QJsonObject msg;
+    msg["type"] = "autoTurn";
+    msg["buyPolicy"] = buyPolicy;
+    msg["minMoneyAfter"] = minMoneyAfter;
+    msg["endTurn"] = endTurn;
+    sendJson(msg);
+}
+
 void NetworkClient::sendStartGame()
 {
     QJsonObject msg;
@@ -178,6 +530,9 @@ void NetworkClient::sendGetState()
 {
     QJsonObject msg;
     msg["type"] = "getState";
+    msg["delta"] = true; // danach nur noch stateDelta statt voller Snapshots
+    msg["catalog"] = true; // statische Felddaten nur per boardCatalog
+    msg["catalogHash"] = catalogHash;
     sendJson(msg);
 }
 
@@ -188,4 +543,97 @@ void NetworkClient::sendRestartGame()
     sendJson(msg);
 }
 
+void NetworkClient::sendListRooms()
+{
+    QJsonObject msg;
+    msg["type"] = "listRooms";
+    sendJson(msg);
+}
+
+void NetworkClient::sendCreateRoom(const QString &name)
+{
+    QJsonObject msg;
+    msg["type"] = "createRoom";
+    msg["name"] = name;
+    sendJson(msg);
+}
+
+void NetworkClient::sendJoinRoom(int roomId)
+{
+    QJsonObject msg;
+    msg["type"] = "joinRoom";
+    msg["roomId"] = roomId;
+    sendJson(msg);
+}
+
+void NetworkClient::handlePing(const QJsonObject &obj)
+{
+    // pong sofort und ohne rid zurueck, der Server misst damit die RTT
+    QJsonObject pong;
+    pong["type"] = "pong";
+    pong["seq"] = obj.value("seq");
+    pong["t"] = obj.value("t");
+    socket->write(Protocol::encode(pong, wireFormat));
+
+    if (obj.contains("rttMs")) {
+        const int rtt = obj.value("rttMs").toInt();
+        if (rtt != rttMs) {
+            rttMs = rtt;
+            emit rttChanged(rttMs);
+        }
+    }
+}
+
+void NetworkClient::handleResumed(const QJsonObject &obj)
+{
+    resumePending = false;
+    const QVector<QJsonObject> held = std::exchange(heldMessages, {});
+    const bool ok = obj.value("ok").toBool();
+    sessionToken = obj.value("session").toString();
+
+    if (ok) {
+        // Nachrichten der vorlaeufigen Verbindung verwerfen, nur einen
+        // Katalog behalten (der Server rechnet ihn uns jetzt zu)
+        for (const QJsonObject &m : held) {
+            if (m.value("type").toString() == "boardCatalog") {
+                handleMessage(m);
+            }
+        }
+        if (!obj.value("complete").toBool()) {
+            // Luecke zu gross: Server schickt gleich den vollen Zustand
+            resetState();
+            lastSeq = quint64(obj.value("lastSeq").toDouble());
+        }
+        qDebug() << "[CLIENT] Sitzung fortgesetzt, replayed=" << obj.value("replayed").toInt();
+    } else {
+        // Platz ist weg: als neuer Spieler weiter
+        qDebug() << "[CLIENT] resume abgelehnt:" << obj.value("message").toString();
+        resetState();
+        lastSeq = 0;
+        for (const QJsonObject &m : held) {
+            handleMessage(m);
+        }
+    }
+    emit sessionResumed(ok);
+}
 
+void NetworkClient::resetState()
+{
+    stateCache = QJsonObject();
+    stateVersion = -1;
+    resyncPending = false;
+}
+
+void NetworkClient::onWatchdogTimeout()
+{
+    // halb offene Verbindung (z. B. WLAN weg): abort loest disconnected
+    // und damit ggf. den Reconnect aus
+    qDebug() << "[CLIENT] Server antwortet nicht mehr, Verbindung wird getrennt";
+    emit errorOccurred("Zeitueberschreitung: keine Daten vom Server");
+    socket->abort();
+}
+
+int NetworkClient::roundTripMs() const
+{
+    return rttMs;
+}
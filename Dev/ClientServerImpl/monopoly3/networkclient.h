@@ -2,9 +2,15 @@
 #define NETWORKCLIENT_H
 
 #include <QObject>
+#include <QElapsedTimer>
 #include <QTcpSocket>
+#include <QHash>
+#include <QJsonArray>
 #include <QJsonObject>
 #include <QTimer>
+#include <QVector>
+
+#include "protocol.h"
 
 class NetworkClient : public QObject
 {
@@ -14,8 +20,12 @@ public:
     explicit NetworkClient(QObject *parent = nullptr);
 
     void connectToServer(const QString &host, quint16 port);
-    void sendJson(const QJsonObject &obj);
+    // liefert die vergebene rid (0, wenn der Server keine rid kennt)
+    int sendJson(const QJsonObject &obj);
     void sendRollDice();
+    // ganzer Zug in einem Roundtrip; buyPolicy: "never", "always" oder
+    // "reserve" (kaufen, solange danach noch minMoneyAfter uebrig ist)
+    void sendAutoTurn(const QString &buyPolicy, int minMoneyAfter = 0, bool endTurn = true);
     void sendStartGame();
     void sendBuyDecision(bool decision, int playerId, int pendingBuyFieldIndex);
     void sendEndTurn();
@@ -25,17 +35,76 @@ public:
     void sendSetReady(bool ready);
     void sendBuyHouse(int fieldIndex);
     void sendRestartGame();
+    void sendListRooms();
+    void sendCreateRoom(const QString &name);
+    void sendJoinRoom(int roomId);
     void setReconnectEnabled(bool enabled);
 
+    // Latenz je Anfragetyp (Senden bis ack/nack): {type: {count, avgMs, maxMs, failed}}
+    QJsonObject requestLatencyStats() const;
+
+    // geglaettete Round-Trip-Time laut Server-ping (-1 = noch keine Messung)
+    int roundTripMs() const;
+
 signals:
     void connected();
     void disconnected();
     void jsonReceived(const QJsonObject &obj);
     void errorOccurred(const QString &error);
+    // latencyUs: Senden bis ack/nack in Mikrosekunden (-1 = unbekannte rid)
+    void requestFinished(int rid, const QString &type, bool ok, qint64 latencyUs, const QString &message);
+    void rttChanged(int rttMs);
+    // nach einem Reconnect: ok = alter Platz samt verpasster Nachrichten zurueck
+    void sessionResumed(bool ok);
 
 private:
     QTcpSocket *socket;
-    QByteArray buffer;
+    Protocol::FrameReader reader;
+
+    // Handshake: Sendeformat und Server-Faehigkeiten aus welcome
+    // (bis dahin JSON, alte Server schicken nie ein welcome)
+    Protocol::WireFormat wireFormat = Protocol::WireFormat::Json;
+    int protocolVersion = 0;
+    QStringList serverCaps;
+
+    // offene Anfragen mit rid (nur wenn der Server "rid" kann)
+    struct PendingRequest {
+        QString type;
+        QElapsedTimer timer;
+    };
+    QHash<int, PendingRequest> pendingRequests;
+    int nextRid = 1;
+
+    struct LatencyStats {
+        qint64 count = 0;
+        qint64 totalMs = 0;
+        qint64 maxMs = 0;
+        qint64 failed = 0;
+    };
+    QHash<QString, LatencyStats> latencyByType;
+
+    // Versionierter State-Stream: voller Zustand + Deltas vom Server
+    QJsonObject stateCache;
+    int stateVersion = -1;
+    bool resyncPending = false;
+
+    // boardCatalog (statische Felddaten) nach Hash, bleibt ueber Reconnects erhalten
+    QHash<QString, QJsonArray> catalogCache;
+    QString catalogHash;
+
+    // Heartbeat: Server pingt regelmaessig; bleibt laenger als
+    // heartbeatMs * (maxMissed + 1) alles still, gilt die Verbindung als tot
+    QTimer *watchdogTimer;
+    int watchdogMs = 0;
+    int rttMs = -1;
+
+    // Sitzung (Server mit "resume"): Token und letzte empfangene seq. Nach
+    // einem Reconnect wird erst der alte Platz angefragt; was der Server
+    // bis zur Antwort fuer die vorlaeufige Verbindung schickt, wird gehalten
+    QString sessionToken;
+    quint64 lastSeq = 0;
+    bool resumePending = false;
+    QVector<QJsonObject> heldMessages;
 
     // Auto-Reconnect
     QString lastHost;
@@ -46,12 +115,23 @@ private:
     bool reconnectEnabled = false;
 
     void scheduleReconnect();
+    void handleMessage(const QJsonObject &obj);
+    void handleTurnResult(const QJsonObject &obj);
+    void handleRequestReply(const QJsonObject &obj);
+    void handlePing(const QJsonObject &obj);
+    void handleResumed(const QJsonObject &obj);
+    void resetState();
+    void applyStateDelta(const QJsonObject &delta);
+    QJsonObject mergeCatalog(const QJsonObject &state) const;
+    void emitState();
+    void requestResync();
 
 private slots:
     void onReadyRead();
     void onConnected();
     void onDisconnected();
     void tryReconnect();
+    void onWatchdogTimeout();
 };
 
 #endif // NETWORKCLIENT_H
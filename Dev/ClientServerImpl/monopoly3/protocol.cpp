@@ -0,0 +1,450 @@
+#include "protocol.h"
+
+#include <QCborStreamWriter>
+#include <QCborValue>
+#include <QCborMap>
+#include <QHash>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QtEndian>
+
+namespace Protocol {
+
+namespace {
+
+struct TypeEntry {
+    MessageType code;
+    const char *name;
+};
+
+const TypeEntry typeTable[] = {
+    {StartGame, "startGame"},
+    {RollDice, "rollDice"},
+    {EndTurn, "endTurn"},
+    {Surrender, "surrender"},
+    {SetReady, "setReady"},
+    {SetName, "setName"},
+    {RestartGame, "restartGame"},
+    {BuyHouse, "buyHouse"},
+    {BuyDecision, "buyDecision"},
+    {GetState, "getState"},
+    {ListRooms, "listRooms"},
+    {CreateRoom, "createRoom"},
+    {JoinRoom, "joinRoom"},
+    {ServerStats, "serverStats"},
+    {SetWireFormat, "setWireFormat"},
+    {Hello, "hello"},
+    {AutoTurn, "autoTurn"},
+    {Pong, "pong"},
+    {Resume, "resume"},
+    {AssignPlayerId, "assignPlayerId"},
+    {RoomJoined, "roomJoined"},
+    {RoomList, "roomList"},
+    {Info, "info"},
+    {Error, "error"},
+    {Log, "log"},
+    {DiceRolled, "diceRolled"},
+    {BuyRequest, "buyRequest"},
+    {State, "state"},
+    {StateDelta, "stateDelta"},
+    {BoardCatalog, "boardCatalog"},
+    {WireFormatChanged, "wireFormat"},
+    {Welcome, "welcome"},
+    {TurnResult, "turnResult"},
+    {Ack, "ack"},
+    {Nack, "nack"},
+    {Ping, "ping"},
+    {Resumed, "resumed"},
+};
+
+const QHash<QString, int> &codesByName()
+{
+    static const QHash<QString, int> codes = [] {
+        QHash<QString, int> h;
+        for (const TypeEntry &e : typeTable) {
+            h.insert(QString::fromLatin1(e.name), e.code);
+        }
+        return h;
+    }();
+    return codes;
+}
+
+const QHash<int, QString> &namesByCode()
+{
+    static const QHash<int, QString> names = [] {
+        QHash<int, QString> h;
+        for (const TypeEntry &e : typeTable) {
+            h.insert(e.code, QString::fromLatin1(e.name));
+        }
+        return h;
+    }();
+    return names;
+}
+
+void writeValue(QCborStreamWriter &writer, const QJsonValue &value);
+
+void writeObject(QCborStreamWriter &writer, const QJsonObject &obj, bool typeAsCode)
+{
+    writer.startMap(quint64(obj.size()));
+    for (auto it = obj.begin(); it != obj.end(); ++it) {
+        writer.append(it.key());
+        if (typeAsCode && it.key() == QLatin1String("type")) {
+            const int code = typeCode(it.value().toString());
+            if (code != UnknownType) {
+                writer.append(qint64(code));
+                continue;
+            }
+        }
+        writeValue(writer, it.value());
+    }
+    writer.endMap();
+}
+
+void writeValue(QCborStreamWriter &writer, const QJsonValue &value)
+{
+    switch (value.type()) {
+    case QJsonValue::Bool:
+        writer.append(value.toBool());
+        break;
+    case QJsonValue::Double: {
+        // ganze Zahlen kompakt als CBOR-Integer
+        const double d = value.toDouble();
+        const qint64 i = qint64(d);
+        if (double(i) == d) {
+            writer.append(i);
+        } else {
+            writer.append(d);
+        }
+        break;
+    }
+    case QJsonValue::String:
+        writer.append(value.toString());
+        break;
+    case QJsonValue::Array: {
+        const QJsonArray arr = value.toArray();
+        writer.startArray(quint64(arr.size()));
+        for (const QJsonValue &v : arr) {
+            writeValue(writer, v);
+        }
+        writer.endArray();
+        break;
+    }
+    case QJsonValue::Object:
+        writeObject(writer, value.toObject(), false);
+        break;
+    default:
+        writer.appendNull();
+        break;
+    }
+}
+
+// CBOR-Kopf (Major-Type + Laenge/Wert) in kuerzester Form
+void appendCborHead(QByteArray &out, quint8 major, quint64 value)
+{
+    const char type = char(major << 5);
+    if (value < 24) {
+        out.append(char(type | char(value)));
+    } else if (value <= 0xFF) {
+        out.append(char(type | 24));
+        out.append(char(value));
+    } else if (value <= 0xFFFF) {
+        out.append(char(type | 25));
+        char buf[2];
+        qToBigEndian<quint16>(quint16(value), buf);
+        out.append(buf, 2);
+    } else if (value <= 0xFFFFFFFFu) {
+        out.append(char(type | 26));
+        char buf[4];
+        qToBigEndian<quint32>(quint32(value), buf);
+        out.append(buf, 4);
+    } else {
+        out.append(char(type | 27));
+        char buf[8];
+        qToBigEndian<quint64>(value, buf);
+        out.append(buf, 8);
+    }
+}
+
+// Laenge eines CBOR-Kopfs; -1 wenn unvollstaendig oder unbestimmte Laenge
+int readCborHead(const QByteArray &data, int pos, quint64 *value)
+{
+    if (pos >= data.size()) return -1;
+    const quint8 info = quint8(data[pos]) & 0x1F;
+    if (info < 24) {
+        *value = info;
+        return 1;
+    }
+    const int extra = info == 24 ? 1 : info == 25 ? 2 : info == 26 ? 4 : info == 27 ? 8 : -1;
+    if (extra < 0 || pos + 1 + extra > data.size()) return -1;
+    const uchar *p = reinterpret_cast<const uchar *>(data.constData() + pos + 1);
+    quint64 v = 0;
+    for (int i = 0; i < extra; ++i) {
+        v = (v << 8) | p[i];
+    }
+    *value = v;
+    return 1 + extra;
+}
+
+} // namespace
+
+int typeCode(const QString &name)
+{
+    return codesByName().value(name, UnknownType);
+}
+
+QString typeName(int code)
+{
+    return namesByCode().value(code);
+}
+
+QStringList supportedCapabilities()
+{
+    return {CapCbor, CapDelta, CapCatalog, CapTurnResult, CapRequestIds, CapHeartbeat, CapResume};
+}
+
+QStringList sharedCapabilities(const QStringList &offered)
+{
+    QStringList shared;
+    for (const QString &cap : supportedCapabilities()) {
+        if (offered.contains(cap)) {
+            shared.append(cap);
+        }
+    }
+    return shared;
+}
+
+QString formatName(WireFormat format)
+{
+    return format == WireFormat::Cbor ? QStringLiteral("cbor") : QStringLiteral("json");
+}
+
+bool parseFormat(const QString &name, WireFormat *format)
+{
+    if (name == QLatin1String("cbor")) {
+        *format = WireFormat::Cbor;
+        return true;
+    }
+    if (name == QLatin1String("json")) {
+        *format = WireFormat::Json;
+        return true;
+    }
+    return false;
+}
+
+QByteArray encode(const QJsonObject &obj, WireFormat format)
+{
+    if (format == WireFormat::Json) {
+        QByteArray data = QJsonDocument(obj).toJson(QJsonDocument::Compact);
+        data.append('\n');
+        return data;
+    }
+
+    // Header reservieren, CBOR direkt dahinter schreiben, Laenge nachtragen
+    QByteArray data(BinaryHeaderSize, Qt::Uninitialized);
+    data[0] = BinaryMagic;
+    {
+        QCborStreamWriter writer(&data);
+        writeObject(writer, obj, true);
+    }
+    qToBigEndian<quint32>(quint32(data.size() - BinaryHeaderSize), data.data() + 1);
+    return data;
+}
+
+QByteArray withSequence(const QByteArray &frame, WireFormat format, quint64 seq)
+{
+    if (format == WireFormat::Json) {
+        // kompaktes JSON beginnt immer mit '{'; seq als erstes Feld einsetzen
+        if (frame.size() < 2 || frame[0] != '{') return frame;
+        QByteArray out;
+        out.reserve(frame.size() + 24);
+        out.append("{\"seq\":");
+        out.append(QByteArray::number(seq));
+        if (frame[1] != '}') {
+            out.append(',');
+        }
+        out.append(frame.constData() + 1, frame.size() - 1);
+        return out;
+    }
+
+    // Map-Kopf mit Anzahl+1 neu schreiben, "seq" davor, Rest unveraendert
+    quint64 count = 0;
+    if (frame.size() <= BinaryHeaderSize
+        || (quint8(frame[BinaryHeaderSize]) >> 5) != 5) {
+        return frame;
+    }
+    const int headLen = readCborHead(frame, BinaryHeaderSize, &count);
+    if (headLen < 0) return frame;
+
+    QByteArray out(BinaryHeaderSize, Qt::Uninitialized);
+    out.reserve(frame.size() + 16);
+    out[0] = BinaryMagic;
+    appendCborHead(out, 5, count + 1);
+    appendCborHead(out, 3, 3);
+    out.append("seq", 3);
+    appendCborHead(out, 0, seq);
+    out.append(frame.constData() + BinaryHeaderSize + headLen,
+               frame.size() - BinaryHeaderSize - headLen);
+    qToBigEndian<quint32>(quint32(out.size() - BinaryHeaderSize), out.data() + 1);
+    return out;
+}
+
+FrameReader::FrameReader(int maxFrameSize)
+    : maxFrameSize(maxFrameSize)
+{
+}
+
+void FrameReader::compact()
+{
+    // einmal pro Lesevorgang statt einmal pro Nachricht
+    if (cursor == buffer.size()) {
+        buffer.clear();
+    } else if (cursor > 0) {
+        buffer.remove(0, cursor);
+    }
+    cursor = 0;
+}
+
+qint64 FrameReader::readFrom(QIODevice *device)
+{
+    compact();
+    const qint64 available = device->bytesAvailable();
+    if (available <= 0) {
+        return 0;
+    }
+
+    char *space = reserve(available);
+    const qint64 got = device->read(space, available);
+    commit(qMax<qint64>(got, 0));
+    return qMax<qint64>(got, 0);
+}
+
+char *FrameReader::reserve(qsizetype size)
+{
+    compact();
+    reservedAt = buffer.size();
+    buffer.resize(reservedAt + size);
+    return buffer.data() + reservedAt;
+}
+
+void FrameReader::commit(qsizetype size)
+{
+    buffer.resize(reservedAt + size);
+}
+
+void FrameReader::append(const QByteArray &data)
+{
+    compact();
+    buffer.append(data);
+}
+
+QByteArray FrameReader::pending() const
+{
+    return buffer.mid(cursor);
+}
+
+bool FrameReader::hasPending() const
+{
+    return cursor < buffer.size();
+}
+
+void FrameReader::clear()
+{
+    buffer.clear();
+    cursor = 0;
+}
+
+FrameReader::Result FrameReader::next(QJsonObject *msg, QString *error, int *msgType)
+{
+    *msg = QJsonObject();
+    error->clear();
+    if (msgType) {
+        *msgType = UnknownType;
+    }
+
+    const char *data = buffer.constData();
+    const qsizetype size = buffer.size();
+
+    // Leerzeichen/Zeilenumbrueche zwischen Nachrichten ueberspringen
+    while (cursor < size
+           && (data[cursor] == '\n' || data[cursor] == '\r'
+               || data[cursor] == ' ' || data[cursor] == '\t')) {
+        ++cursor;
+    }
+    if (cursor == size) {
+        return Result::Incomplete;
+    }
+
+    if (data[cursor] == BinaryMagic) {
+        if (size - cursor < BinaryHeaderSize) {
+            return Result::Incomplete;
+        }
+        const quint32 length = qFromBigEndian<quint32>(data + cursor + 1);
+        if (length > quint32(maxFrameSize)) {
+            *error = QString("Frame zu gross: %1 Bytes").arg(length);
+            return Result::TooLarge;
+        }
+        if (quint32(size - cursor - BinaryHeaderSize) < length) {
+            return Result::Incomplete;
+        }
+
+        const char *payload = data + cursor + BinaryHeaderSize;
+        cursor += BinaryHeaderSize + qsizetype(length);
+
+        QCborParserError err;
+        const QCborValue value = QCborValue::fromCbor(payload, qsizetype(length), &err);
+        if (err.error != QCborError::NoError || !value.isMap()) {
+            *error = QString("CBOR error: %1").arg(err.errorString());
+            return Result::Malformed;
+        }
+
+        QCborMap map = value.toMap();
+        const QCborValue type = map.value(QLatin1String("type"));
+        if (type.isInteger()) {
+            const int code = int(type.toInteger());
+            const QString name = typeName(code);
+            map.insert(QLatin1String("type"), name);
+            if (msgType && !name.isEmpty()) {
+                *msgType = code;
+            }
+        } else if (msgType) {
+            *msgType = typeCode(type.toString());
+        }
+        *msg = map.toJsonObject();
+        return Result::Message;
+    }
+
+    const qsizetype nl = buffer.indexOf('\n', cursor);
+    if (nl < 0) {
+        if (size - cursor > maxFrameSize) {
+            *error = QString("Zeile ohne Ende ueber %1 Bytes").arg(maxFrameSize);
+            return Result::TooLarge;
+        }
+        return Result::Incomplete;
+    }
+    if (nl - cursor > maxFrameSize) {
+        *error = QString("Zeile zu gross: %1 Bytes").arg(nl - cursor);
+        return Result::TooLarge;
+    }
+
+    // Zeile als View auf den Puffer (fromRawData kopiert nicht)
+    qsizetype end = nl;
+    while (end > cursor && (data[end - 1] == '\r' || data[end - 1] == ' ' || data[end - 1] == '\t')) {
+        --end;
+    }
+    const QByteArray line = QByteArray::fromRawData(data + cursor, end - cursor);
+    cursor = nl + 1;
+
+    QJsonParseError err;
+    const QJsonDocument doc = QJsonDocument::fromJson(line, &err);
+    if (err.error != QJsonParseError::NoError || !doc.isObject()) {
+        *error = QString("JSON error: %1 raw=%2").arg(err.errorString(), QString::fromUtf8(line));
+        return Result::Malformed;
+    }
+    *msg = doc.object();
+    if (msgType) {
+        *msgType = typeCode(msg->value(QLatin1String("type")).toString());
+    }
+    return Result::Message;
+}
+
+} // namespace Protocol